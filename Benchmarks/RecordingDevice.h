@@ -0,0 +1,320 @@
+//
+// Created by 2401Lucas on 2025-12-02.
+//
+
+#ifndef GPU_PARTICLE_SIM_RECORDINGDEVICE_H
+#define GPU_PARTICLE_SIM_RECORDINGDEVICE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "Rendering/RHI/Device.h"
+#include "Rendering/RHI/CommandList.h"
+#include "Rendering/RHI/CommandQueue.h"
+
+/// <summary>
+/// What the recording command lists and queues saw, shared by every object of one RecordingDevice
+/// </summary>
+struct RecordingCounters {
+    std::atomic<uint64_t> barriers{0};
+    std::atomic<uint64_t> barrierCalls{0};
+    std::atomic<uint64_t> commands{0};
+    std::atomic<uint64_t> submissions{0};
+    std::atomic<uint64_t> textureCreates{0};
+    std::atomic<uint64_t> bufferCreates{0};
+    std::atomic<uint64_t> illegalBarriers{0}; // Transitions the list's queue type cannot record
+
+    // Queue operations in submission order: the queue's letter for Execute, followed by w for a fence
+    // wait and s for a fence signal, separated by spaces. Written by the submitting thread only.
+    std::string queueLog;
+
+    void Reset() {
+        barriers = 0;
+        barrierCalls = 0;
+        commands = 0;
+        submissions = 0;
+        textureCreates = 0;
+        bufferCreates = 0;
+        illegalBarriers = 0;
+        queueLog.clear();
+    }
+
+    void LogQueue(QueueType type, const char *operation) {
+        if (!queueLog.empty()) {
+            queueLog += ' ';
+        }
+        queueLog += type == QueueType::Compute ? 'C' : type == QueueType::Transfer ? 'T' : 'G';
+        queueLog += operation;
+    }
+};
+
+class RecordingTexture : public Texture {
+public:
+    uint32_t GetBindlessIndex() const override { return 0; }
+};
+
+class RecordingBuffer : public Buffer {
+public:
+    uint64_t bufferSize = 0;
+
+    void *Map() override { return nullptr; }
+    void *GetMappedPtr() const override { return nullptr; }
+    void Unmap() override {}
+    uint64_t GetSize() const override { return bufferSize; }
+    uint64_t GetGPUAddress() const override { return 0; }
+    uint32_t GetBindlessIndex() const override { return 0; }
+};
+
+class RecordingFence : public Fence {
+public:
+    explicit RecordingFence(RecordingCounters &counters) : m_counters(counters) {}
+
+    void Signal(CommandQueue *queue, uint64_t value) override {
+        m_counters.LogQueue(queue->GetType(), "s");
+        m_value = value;
+    }
+    void WaitCPU(uint64_t) override {}
+    uint64_t GetCompletedValue() const override { return m_value; }
+    void Reset(uint64_t value) override { m_value = value; }
+
+private:
+    RecordingCounters &m_counters;
+    uint64_t m_value = 0;
+};
+
+class RecordingCommandList : public CommandList {
+public:
+    RecordingCommandList(QueueType type, RecordingCounters &counters) : m_type(type), m_counters(counters) {}
+
+    void Begin(BindlessDescriptorManager *) override {}
+    void End() override {}
+
+    void SetPipeline(Pipeline *) override { Record(); }
+    void SetViewport(const Viewport &) override { Record(); }
+    void SetScissor(const Rect &) override { Record(); }
+    void SetPrimitiveTopology(PrimitiveTopology) override { Record(); }
+
+    void SetVertexBuffer(Buffer *, uint32_t) override { Record(); }
+    void SetIndexBuffer(Buffer *) override { Record(); }
+    void SetConstantBuffer(Buffer *, uint32_t, uint32_t) override { Record(); }
+    void SetTexture(Texture *, uint32_t) override { Record(); }
+
+    void Draw(uint32_t, uint32_t) override { Record(); }
+    void DrawIndexed(uint32_t, uint32_t) override { Record(); }
+    void DrawInstanced(uint32_t, uint32_t) override { Record(); }
+    void DrawIndexedInstanced(uint32_t, uint32_t) override { Record(); }
+    void Dispatch(uint32_t, uint32_t, uint32_t) override { Record(); }
+
+    void ClearRenderTarget(Texture *, const float[4]) override { Record(); }
+    void ClearDepthStencil(Texture *, float, uint8_t) override { Record(); }
+    void CopyBuffer(Buffer *, Buffer *, uint64_t) override { Record(); }
+    void CopyTexture(Texture *, Texture *) override { Record(); }
+    void CopyBufferToTexture(Buffer *, Texture *) override { Record(); }
+
+    void ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) override {
+        for (uint32_t i = 0; i < count; ++i) {
+            if (barriers[i].type == ResourceBarrier::Type::Transition) {
+                CheckTransition(barriers[i].texture != nullptr, barriers[i].stateBefore, barriers[i].stateAfter);
+            }
+        }
+        m_counters.barriers += count;
+        m_counters.barrierCalls++;
+    }
+
+    void TransitionTexture(Texture *, TextureUsage before, TextureUsage after) override {
+        CheckTransition(true, (uint32_t) before, (uint32_t) after);
+        m_counters.barriers++;
+    }
+
+    void TransitionBuffer(Buffer *, BufferUsage before, BufferUsage after) override {
+        CheckTransition(false, (uint32_t) before, (uint32_t) after);
+        m_counters.barriers++;
+    }
+    void DiscardTexture(Texture *) override { Record(); }
+
+    void WriteTimestamp(QueryHeap *, uint32_t) override { Record(); }
+    void ResolveQueries(QueryHeap *, uint32_t, uint32_t, Buffer *, uint64_t) override { Record(); }
+
+    void SetRenderTarget(Texture *, Texture *) override { Record(); }
+    void SetRenderTargets(Texture **, uint32_t, Texture *) override { Record(); }
+
+    void BeginRenderPass(const RenderPassBeginInfo &) override { Record(); }
+    void EndRenderPass() override { Record(); }
+
+private:
+    QueueType m_type;
+    RecordingCounters &m_counters;
+
+    void Record() { m_counters.commands++; }
+
+    // A real compute or copy list rejects these, count them so tests can fail on them
+    void CheckTransition(bool texture, uint32_t before, uint32_t after) {
+        if (!IsQueueState(m_type, texture, before) || !IsQueueState(m_type, texture, after)) {
+            m_counters.illegalBarriers++;
+        }
+    }
+};
+
+class RecordingCommandQueue : public CommandQueue {
+public:
+    RecordingCommandQueue(QueueType type, RecordingCounters &counters) : m_type(type), m_counters(counters) {}
+
+    void Execute(CommandList *) override {
+        m_counters.submissions++;
+        m_counters.LogQueue(m_type, "");
+    }
+
+    void Execute(CommandList *const *, uint32_t) override {
+        m_counters.submissions++;
+        m_counters.LogQueue(m_type, "");
+    }
+
+    void WaitIdle() override {}
+
+    // Work completes immediately, so every signaled value is also the completed one
+    void Signal(uint64_t fenceValue) override { m_completedValue = fenceValue; }
+    void WaitForFence(uint64_t) override {}
+    void Wait(Fence *, uint64_t) override { m_counters.LogQueue(m_type, "w"); }
+    void BeginFrame(uint32_t) override {}
+
+    QueueType GetType() const override { return m_type; }
+    uint64_t GetCompletedFenceValue() const override { return m_completedValue; }
+    uint64_t GetTimestampFrequency() const override { return 1000000000; }
+    void AssignCommandList(CommandList *, uint32_t, uint32_t) override {}
+
+private:
+    QueueType m_type;
+    RecordingCounters &m_counters;
+    uint64_t m_completedValue = 0;
+};
+
+/// <summary>
+/// Stand-in RHI used to benchmark the RenderGraph without a GPU.
+/// Resources are plain objects, command lists only count what is recorded and queues complete
+/// work the moment it is signaled, so timings measure the graph and not a driver.
+/// </summary>
+class RecordingDevice : public Device {
+public:
+    RecordingCounters counters;
+    uint64_t videoMemoryBudget = 8ull << 30; // Tests move it to exercise RenderGraph::SetMemoryBudget
+
+    CommandQueue *CreateCommandQueue(const CommandQueueCreateInfo &createInfo) override {
+        return new RecordingCommandQueue(createInfo.type, counters);
+    }
+
+    CommandList *CreateCommandList(QueueType type) override { return new RecordingCommandList(type, counters); }
+
+    Swapchain *CreateSwapchain(void *, CommandQueue *, uint32_t, uint32_t) override { return nullptr; }
+
+    Buffer *CreateBuffer(const BufferCreateInfo &desc) override {
+        counters.bufferCreates++;
+        RecordingBuffer *buffer = new RecordingBuffer();
+        buffer->bufferSize = desc.size;
+        return buffer;
+    }
+
+    Texture *CreateTexture(const TextureCreateInfo &desc) override {
+        counters.textureCreates++;
+        RecordingTexture *texture = new RecordingTexture();
+        texture->width = desc.width;
+        texture->height = desc.height;
+        texture->mipLevels = desc.mipLevels;
+        texture->format = desc.format;
+        texture->usage = desc.usage;
+        texture->size = GetTextureAllocationInfo(desc).size;
+        return texture;
+    }
+
+    Pipeline *CreatePipeline(const PipelineCreateInfo &) override { return nullptr; }
+
+    Heap *CreateHeap(const HeapCreateInfo &desc) override {
+        Heap *heap = new Heap();
+        heap->size = desc.size;
+        heap->resourceClass = desc.resourceClass;
+        return heap;
+    }
+
+    Fence *CreateFence(uint64_t initialValue) override {
+        RecordingFence *fence = new RecordingFence(counters);
+        fence->Reset(initialValue);
+        return fence;
+    }
+
+    QueryHeap *CreateQueryHeap(const QueryHeapCreateInfo &desc) override {
+        QueryHeap *queryHeap = new QueryHeap();
+        queryHeap->type = desc.type;
+        queryHeap->count = desc.count;
+        return queryHeap;
+    }
+
+    Texture *CreatePlacedTexture(const TextureCreateInfo &desc, Heap *, uint64_t) override {
+        return CreateTexture(desc);
+    }
+
+    Buffer *CreatePlacedBuffer(const BufferCreateInfo &desc, Heap *, uint64_t) override {
+        return CreateBuffer(desc);
+    }
+
+    void UploadBufferData(Buffer *, const void *, size_t) override {}
+    void UploadTextureData(Texture *, const void *, size_t) override {}
+    void FlushUploads() override {}
+
+    void DestroyBuffer(Buffer *buffer) override { delete buffer; }
+    void DestroyTexture(Texture *texture) override { delete texture; }
+    void DestroyPipeline(Pipeline *) override {}
+    void DestroyHeap(Heap *heap) override { delete heap; }
+    void DestroyQueryHeap(QueryHeap *queryHeap) override { delete queryHeap; }
+
+    bool SupportsRayTracing() const override { return false; }
+    bool SupportsMeshShaders() const override { return false; }
+    bool SupportsSplitBarriers() const override { return true; }
+    bool SupportsRenderPasses() const override { return true; }
+    uint64_t GetVideoMemoryBudget() const override { return videoMemoryBudget; }
+
+    // Sizes follow the D3D12 rules closely enough for aliasing numbers to be meaningful
+    ResourceAllocationInfo GetTextureAllocationInfo(const TextureCreateInfo &desc) const override {
+        uint64_t size = 0;
+        uint32_t width = desc.width;
+        uint32_t height = desc.height;
+        for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+            size += static_cast<uint64_t>(width) * height * BytesPerPixel(desc.format);
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+        return {AlignUp(size * desc.arraySize, Alignment), Alignment};
+    }
+
+    ResourceAllocationInfo GetBufferAllocationInfo(const BufferCreateInfo &desc) const override {
+        return {AlignUp(desc.size, Alignment), Alignment};
+    }
+
+    BindlessDescriptorManager *GetBindlessManager() const override { return nullptr; }
+
+    void WaitIdle() override {}
+
+private:
+    static constexpr uint64_t Alignment = 64 * 1024;
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    static uint32_t BytesPerPixel(TextureFormat format) {
+        switch (format) {
+            case TextureFormat::RGBA32_FLOAT:
+                return 16;
+            case TextureFormat::RGB32_FLOAT:
+                return 12;
+            case TextureFormat::RG32_FLOAT:
+            case TextureFormat::RGBA16_FLOAT:
+                return 8;
+            case TextureFormat::R16_FLOAT:
+                return 2;
+            default:
+                return 4;
+        }
+    }
+};
+
+#endif //GPU_PARTICLE_SIM_RECORDINGDEVICE_H
@@ -0,0 +1,604 @@
+//
+// Created by 2401Lucas on 2025-12-02.
+//
+// Headless RenderGraph benchmark. Builds synthetic graphs against the recording device and reports
+// compile time, execute time, barrier count and transient memory per configuration.
+//
+// Usage: RenderGraphBenchmark [--quick] [--csv] [--aliasing] [--threads N] [--capture FILE]
+//
+// --capture writes one frame of the 100 pass diamond graph to FILE for RenderGraphReplay and exits.
+// --quick also compiles every configuration with aliasing and fails if two transients alive at the same
+// time share heap memory. It also checks the memory budget policies, the UAV barriers of a dispatch chain
+// and the batches and transitions of a frame with an async compute pass.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "RecordingDevice.h"
+#include "Core/ThreadPool.h"
+#include "Rendering/RenderGraph/RenderGraph.h"
+#include "Rendering/RenderGraph/RenderGraphCapture.h"
+
+namespace {
+    enum class Topology {
+        Chain, // Every pass reads the previous pass' outputs
+        FanOut, // One producer, every other pass reads it, a final pass gathers all results
+        Diamond, // Layers of fixed width, each pass reads two passes of the layer before
+    };
+
+    const char *TopologyName(Topology topology) {
+        switch (topology) {
+            case Topology::Chain:
+                return "chain";
+            case Topology::FanOut:
+                return "fanout";
+            case Topology::Diamond:
+                return "diamond";
+        }
+        return "unknown";
+    }
+
+    struct BenchmarkConfig {
+        Topology topology;
+        uint32_t passCount;
+        uint32_t resourcesPerPass;
+    };
+
+    struct BenchmarkResult {
+        float declareTime = 0.0f; // Building passes on the CPU, per frame
+        float coldCompileTime = 0.0f; // Full compile after the plan was invalidated
+        float cachedCompileTime = 0.0f; // Hash, rebind, allocation and barrier resolution with a cached plan
+        float executeTime = 0.0f; // Recording and submission
+        uint32_t barrierCount = 0;
+        uint64_t transientBytes = 0;
+        uint64_t peakTransientBytes = 0;
+    };
+
+    constexpr uint32_t DiamondWidth = 8;
+    constexpr uint32_t TextureSize = 256;
+
+    /// <summary>
+    /// Names and handles are declared once, like the Renderer caches its handles
+    /// </summary>
+    class SyntheticGraph {
+    public:
+        SyntheticGraph(RenderGraph &graph, const BenchmarkConfig &config, Texture *backBuffer)
+            : m_graph(graph), m_config(config), m_backBuffer(backBuffer) {
+            m_outputs.resize(config.passCount);
+            for (uint32_t pass = 0; pass < config.passCount; ++pass) {
+                m_passNames.push_back("Pass" + std::to_string(pass));
+                for (uint32_t i = 0; i < config.resourcesPerPass; ++i) {
+                    std::string name = "Pass" + std::to_string(pass) + "_Out" + std::to_string(i);
+                    m_outputs[pass].push_back(graph.DeclareTexture(name));
+                }
+            }
+        }
+
+        void Declare() {
+            m_backBufferHandle = m_graph.RegisterExternalTexture("BackBuffer", m_backBuffer, TextureUsage::Present);
+            m_graph.SetPresentTarget(m_backBufferHandle);
+
+            const uint32_t lastPass = m_config.passCount - 1;
+            for (uint32_t pass = 0; pass < lastPass; ++pass) {
+                RenderPassBuilder builder(m_graph, m_passNames[pass]);
+                for (uint32_t producer: Producers(pass)) {
+                    ReadOutputs(builder, producer);
+                }
+                for (RenderGraphTextureHandle output: m_outputs[pass]) {
+                    builder.WriteTexture(output, TextureSize, TextureSize, RenderPassResource::Format::RGBA8,
+                                         TextureUsage::RenderTarget, PipelineStage::PixelShader);
+                }
+                m_graph.AddPass(builder.Execute(Record).Build());
+            }
+
+            // The final pass reads every pass nothing else reads, so nothing is culled
+            RenderPassBuilder present(m_graph, "Present");
+            for (uint32_t producer: Leaves()) {
+                ReadOutputs(present, producer);
+            }
+            present.WriteTexture(m_backBufferHandle, TextureSize, TextureSize, RenderPassResource::Format::RGBA8,
+                                 TextureUsage::RenderTarget, PipelineStage::PixelShader);
+            m_graph.AddPass(present.Execute(Record).Build());
+        }
+
+    private:
+        RenderGraph &m_graph;
+        BenchmarkConfig m_config;
+        Texture *m_backBuffer;
+        RenderGraphTextureHandle m_backBufferHandle;
+        std::vector<std::string> m_passNames;
+        std::vector<std::vector<RenderGraphTextureHandle> > m_outputs;
+
+        static void Record(RenderPassContext &ctx) {
+            ctx.commandList->Draw(3);
+        }
+
+        void ReadOutputs(RenderPassBuilder &builder, uint32_t producer) {
+            for (RenderGraphTextureHandle output: m_outputs[producer]) {
+                builder.ReadTexture(output, TextureUsage::ShaderResource, PipelineStage::PixelShader);
+            }
+        }
+
+        std::vector<uint32_t> Producers(uint32_t pass) const {
+            if (pass == 0) {
+                return {};
+            }
+
+            switch (m_config.topology) {
+                case Topology::Chain:
+                    return {pass - 1};
+                case Topology::FanOut:
+                    return {0};
+                case Topology::Diamond: {
+                    if (pass <= DiamondWidth) {
+                        return {0};
+                    }
+                    uint32_t layerStart = ((pass - 1) / DiamondWidth) * DiamondWidth + 1;
+                    uint32_t column = (pass - 1) % DiamondWidth;
+                    uint32_t previousStart = layerStart - DiamondWidth;
+                    return {previousStart + column, previousStart + (column + 1) % DiamondWidth};
+                }
+            }
+            return {};
+        }
+
+        std::vector<uint32_t> Leaves() const {
+            const uint32_t lastPass = m_config.passCount - 1;
+            std::vector<bool> read(lastPass, false);
+            for (uint32_t pass = 0; pass < lastPass; ++pass) {
+                for (uint32_t producer: Producers(pass)) {
+                    read[producer] = true;
+                }
+            }
+
+            std::vector<uint32_t> leaves;
+            for (uint32_t pass = 0; pass < lastPass; ++pass) {
+                if (!read[pass]) {
+                    leaves.push_back(pass);
+                }
+            }
+            return leaves;
+        }
+    };
+
+    struct Options {
+        bool quick = false;
+        bool csv = false;
+        bool aliasing = false;
+        uint32_t threads = 0;
+        const char *capturePath = nullptr;
+    };
+
+    BenchmarkResult RunBenchmark(const BenchmarkConfig &config, const Options &options) {
+        RecordingDevice device;
+        std::unique_ptr<CommandQueue> queue(device.CreateCommandQueue({QueueType::Graphics, "Graphics"}));
+        std::unique_ptr<ThreadPool> threadPool;
+        RecordingTexture backBuffer;
+
+        BenchmarkResult result;
+        {
+            RenderGraph graph(&device, queue.get());
+            graph.SetResourceAliasing(options.aliasing);
+            if (options.threads > 1) {
+                threadPool = std::make_unique<ThreadPool>(options.threads - 1);
+                graph.SetThreadPool(threadPool.get());
+            }
+
+            SyntheticGraph synthetic(graph, config, &backBuffer);
+
+            // Fewer frames for large graphs so the whole suite stays in the seconds range
+            const uint32_t budget = options.quick ? 2000 : 20000;
+            const uint32_t frames = std::clamp(budget / config.passCount, 3u, 50u);
+
+            uint64_t fenceValue = 0;
+            auto runFrame = [&](bool invalidate) {
+                auto start = std::chrono::high_resolution_clock::now();
+                synthetic.Declare();
+                result.declareTime += std::chrono::duration<float, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start).count();
+
+                if (invalidate) {
+                    graph.InvalidatePlan();
+                }
+
+                graph.Execute(++fenceValue);
+                queue->Signal(fenceValue);
+                graph.Clear();
+                graph.NextFrame();
+            };
+
+            // Warm up the pool and plan cache, then time full compiles and cached frames separately
+            runFrame(false);
+            result.declareTime = 0.0f;
+
+            for (uint32_t i = 0; i < frames; ++i) {
+                runFrame(true);
+                result.coldCompileTime += graph.GetStatistics().lastRecompileTime;
+            }
+
+            for (uint32_t i = 0; i < frames; ++i) {
+                runFrame(false);
+                const RenderGraph::Statistics &stats = graph.GetStatistics();
+                result.cachedCompileTime += stats.compileTime;
+                result.executeTime += stats.executeTime;
+            }
+
+            const RenderGraph::Statistics &stats = graph.GetStatistics();
+            result.declareTime /= static_cast<float>(frames * 2);
+            result.coldCompileTime /= static_cast<float>(frames);
+            result.cachedCompileTime /= static_cast<float>(frames);
+            result.executeTime /= static_cast<float>(frames);
+            result.barrierCount = stats.barrierCount;
+            result.transientBytes = stats.transientMemoryUsed;
+            result.peakTransientBytes = stats.peakTransientBytes;
+        }
+
+        return result;
+    }
+
+    /// <summary>
+    /// Compile one frame with aliasing and check the memory report: transients placed in the same heap
+    /// must not share bytes while both are alive, and must fit the heap.
+    /// </summary>
+    bool CheckAliasing(const BenchmarkConfig &config) {
+        RecordingDevice device;
+        std::unique_ptr<CommandQueue> queue(device.CreateCommandQueue({QueueType::Graphics, "Graphics"}));
+        RecordingTexture backBuffer;
+
+        RenderGraph graph(&device, queue.get());
+        graph.SetResourceAliasing(true);
+        graph.SetMemoryReport(true);
+        SyntheticGraph synthetic(graph, config, &backBuffer);
+
+        synthetic.Declare();
+        graph.Execute(1);
+        queue->Signal(1);
+
+        const RenderGraph::MemoryReport &report = graph.GetMemoryReport();
+        std::vector<const RenderGraph::MemoryReport::Transient *> placed;
+        for (const auto &transient: report.transients) {
+            if (!transient.aliased) {
+                continue;
+            }
+            if (transient.heap >= report.heaps.size() ||
+                transient.heapOffset + transient.allocationSize > report.heaps[transient.heap].size) {
+                std::fprintf(stderr, "%s lies outside its heap\n", transient.name.c_str());
+                return false;
+            }
+            placed.push_back(&transient);
+        }
+
+        // By heap and offset, so only neighbours up to the end of a placement can overlap it
+        std::sort(placed.begin(), placed.end(), [](const auto *a, const auto *b) {
+            return a->heap != b->heap ? a->heap < b->heap : a->heapOffset < b->heapOffset;
+        });
+        for (size_t i = 0; i < placed.size(); ++i) {
+            const auto &a = *placed[i];
+            for (size_t j = i + 1; j < placed.size(); ++j) {
+                const auto &b = *placed[j];
+                if (b.heap != a.heap || b.heapOffset >= a.heapOffset + a.allocationSize) {
+                    break;
+                }
+                if (a.firstUse <= b.lastUse && b.firstUse <= a.lastUse) {
+                    std::fprintf(stderr, "%s and %s share memory while both are alive\n", a.name.c_str(),
+                                 b.name.c_str());
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Move the device's memory budget under a graph whose policies each lower the peak: the policies must
+    /// apply in registration order, and the cached plan must only be recompiled when its verdict changes
+    /// </summary>
+    bool CheckMemoryBudget() {
+        RecordingDevice device;
+        std::unique_ptr<CommandQueue> queue(device.CreateCommandQueue({QueueType::Graphics, "Graphics"}));
+
+        RenderGraph graph(&device, queue.get());
+        graph.SetMemoryBudget(1.0f);
+        graph.SetDegradationPolicies({RenderGraph::DegradationPolicy::Reschedule,
+                                      RenderGraph::DegradationPolicy::ReduceResolution,
+                                      RenderGraph::DegradationPolicy::DropOptionalPasses});
+        graph.SetDegradedResolutionScale(0.5f);
+
+        // 1MB each, so the undegraded peak is 2MB. Half resolution takes it to 1.25MB, dropping Bloom to 0.25MB.
+        constexpr uint64_t MB = 1024 * 1024;
+        const uint32_t reduce = 1u << (uint32_t) RenderGraph::DegradationPolicy::ReduceResolution;
+        const uint32_t drop = 1u << (uint32_t) RenderGraph::DegradationPolicy::DropOptionalPasses;
+        struct Step {
+            uint64_t budget;
+            bool recompiled;
+            uint32_t degradations;
+            uint64_t peak;
+        };
+        const Step steps[] = {
+            {8192 * MB, true, 0, 2 * MB}, // First compile
+            {8192 * MB, false, 0, 2 * MB},
+            {3 * MB / 2, true, reduce, 5 * MB / 4}, // Now over, stops at the first policy that fits
+            {7 * MB / 5, false, reduce, 5 * MB / 4}, // Still over and the degraded plan still fits
+            {1 * MB, true, reduce | drop, MB / 4}, // The degraded plan no longer fits, policies are left
+            {8192 * MB, true, 0, 2 * MB}, // Fits undegraded again
+        };
+
+        auto record = [](RenderPassContext &ctx) { ctx.commandList->Draw(3); };
+        uint64_t frame = 0;
+        for (const Step &step: steps) {
+            device.videoMemoryBudget = step.budget;
+
+            RenderPassBuilder scene(graph, "Scene");
+            scene.WriteTexture("Color", TextureSize, TextureSize, RenderPassResource::Format::RGBA32F,
+                               TextureUsage::RenderTarget, PipelineStage::PixelShader)
+                    .Downscalable();
+            graph.AddPass(scene.Execute(record).Build());
+
+            RenderPassBuilder bloom(graph, "Bloom");
+            bloom.ReadTexture("Color", TextureUsage::ShaderResource, PipelineStage::PixelShader)
+                    .WriteTexture("Glow", TextureSize, TextureSize, RenderPassResource::Format::RGBA32F,
+                                  TextureUsage::RenderTarget, PipelineStage::PixelShader);
+            graph.AddPass(bloom.Optional().Execute(record).Build());
+
+            RenderPassBuilder composite(graph, "Composite");
+            composite.ReadTexture("Color", TextureUsage::ShaderResource, PipelineStage::PixelShader)
+                    .ReadTexture("Glow", TextureUsage::ShaderResource, PipelineStage::PixelShader);
+            graph.AddPass(composite.SideEffect().Execute(record).Build());
+
+            graph.Execute(++frame);
+            queue->Signal(frame);
+            graph.Clear();
+            graph.NextFrame();
+
+            const RenderGraph::Statistics &stats = graph.GetStatistics();
+            if (stats.planCacheHit == step.recompiled || stats.appliedDegradations != step.degradations ||
+                stats.peakTransientBytes != step.peak || stats.overBudget) {
+                std::fprintf(stderr, "Budget frame %llu: recompiled %d, degradations %u, peak %llu, over budget %d\n",
+                             (unsigned long long) frame, !stats.planCacheHit, stats.appliedDegradations,
+                             (unsigned long long) stats.peakTransientBytes, stats.overBudget);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Dispatches that read and write one buffer in a chain need a UAV barrier between them, except between
+    /// two uses marked NonOverlapping
+    /// </summary>
+    bool CheckUavBarriers() {
+        RecordingDevice device;
+        std::unique_ptr<CommandQueue> queue(device.CreateCommandQueue({QueueType::Graphics, "Graphics"}));
+
+        RenderGraph graph(&device, queue.get());
+        auto record = [](RenderPassContext &ctx) { ctx.commandList->Dispatch(1, 1, 1); };
+
+        // Write, read-write, two non-overlapping read-writes, read-write: only the third barrier is skipped
+        const bool nonOverlapping[] = {false, false, true, true, false};
+        for (uint32_t pass = 0; pass < 5; ++pass) {
+            RenderPassBuilder builder(graph, "Simulate" + std::to_string(pass));
+            if (pass == 0) {
+                builder.WriteBuffer("Particles", 64 * 1024, BufferUsage::UnorderedAccess,
+                                    PipelineStage::ComputeShader);
+            } else {
+                builder.ReadWriteBuffer("Particles", 64 * 1024, BufferUsage::UnorderedAccess,
+                                        PipelineStage::ComputeShader);
+            }
+            if (nonOverlapping[pass]) {
+                builder.NonOverlapping();
+            }
+            graph.AddPass(builder.SideEffect().Execute(record).Build());
+        }
+
+        graph.Execute(1);
+        queue->Signal(1);
+
+        const RenderGraph::Statistics &stats = graph.GetStatistics();
+        if (stats.uavBarrierCount != 3 || stats.skippedUavBarrierCount != 1) {
+            std::fprintf(stderr, "UAV chain issued %u barriers and skipped %u, expected 3 and 1\n",
+                         stats.uavBarrierCount, stats.skippedUavBarrierCount);
+            return false;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// A compute pass between two graphics passes: the graph must split the frame into three batches that
+    /// wait on each other, and move the transitions compute lists cannot record onto graphics
+    /// </summary>
+    bool CheckAsyncCompute() {
+        RecordingDevice device;
+        std::unique_ptr<CommandQueue> queue(device.CreateCommandQueue({QueueType::Graphics, "Graphics"}));
+        std::unique_ptr<CommandQueue> computeQueue(device.CreateCommandQueue({QueueType::Compute, "Compute"}));
+
+        RenderGraph graph(&device, queue.get());
+        graph.SetQueue(QueueType::Compute, computeQueue.get());
+
+        auto record = [](RenderPassContext &ctx) { ctx.commandList->Dispatch(1, 1, 1); };
+        for (uint64_t frame = 1; frame <= 3; ++frame) {
+            device.counters.Reset();
+
+            RenderPassBuilder scene(graph, "Scene");
+            scene.WriteTexture("Color", TextureSize, TextureSize, RenderPassResource::Format::RGBA8,
+                               TextureUsage::RenderTarget, PipelineStage::PixelShader);
+            graph.AddPass(scene.Execute(record).Build());
+
+            RenderPassBuilder blur(graph, "Blur");
+            blur.Queue(QueueType::Compute)
+                    .ReadTexture("Color", TextureUsage::ShaderResource, PipelineStage::ComputeShader)
+                    .WriteTexture("Blurred", TextureSize, TextureSize, RenderPassResource::Format::RGBA8,
+                                  TextureUsage::UnorderedAccess, PipelineStage::ComputeShader);
+            graph.AddPass(blur.Execute(record).Build());
+
+            RenderPassBuilder composite(graph, "Composite");
+            composite.ReadTexture("Blurred", TextureUsage::ShaderResource, PipelineStage::PixelShader)
+                    .ReadTexture("Color", TextureUsage::ShaderResource, PipelineStage::PixelShader);
+            graph.AddPass(composite.SideEffect().Execute(record).Build());
+
+            graph.Execute(frame);
+            queue->Signal(frame);
+            graph.Clear();
+            graph.NextFrame();
+
+            // Graphics signals Scene, compute waits for it and signals Blur, graphics waits for Blur
+            const char *expected = "G Gs Cw C Cs Gw G";
+            const RenderGraph::Statistics &stats = graph.GetStatistics();
+            if (device.counters.queueLog != expected || stats.asyncPassCount != 1 || stats.crossQueueWaitCount != 2) {
+                std::fprintf(stderr, "Async compute frame %llu submitted '%s', expected '%s'\n",
+                             (unsigned long long) frame, device.counters.queueLog.c_str(), expected);
+                return false;
+            }
+            if (device.counters.illegalBarriers != 0) {
+                std::fprintf(stderr, "Async compute frame %llu recorded %llu transitions illegal on their queue\n",
+                             (unsigned long long) frame, (unsigned long long) device.counters.illegalBarriers.load());
+                return false;
+            }
+        }
+
+        // Render targets cannot be used from a compute list at all
+        RenderPassBuilder target(graph, "ComputeTarget");
+        target.Queue(QueueType::Compute)
+                .WriteTexture("Target", TextureSize, TextureSize, RenderPassResource::Format::RGBA8,
+                              TextureUsage::RenderTarget, PipelineStage::ComputeShader);
+        graph.AddPass(target.SideEffect().Execute(record).Build());
+        try {
+            graph.Execute(4);
+        } catch (const std::runtime_error &) {
+            return true;
+        }
+        std::fprintf(stderr, "A compute pass writing a render target compiled\n");
+        return false;
+    }
+
+    /// <summary>
+    /// Declare and execute one frame with capture armed, then save the capture
+    /// </summary>
+    bool CaptureFrame(const BenchmarkConfig &config, const char *path) {
+        RecordingDevice device;
+        std::unique_ptr<CommandQueue> queue(device.CreateCommandQueue({QueueType::Graphics, "Graphics"}));
+        RecordingTexture backBuffer;
+        backBuffer.width = TextureSize;
+        backBuffer.height = TextureSize;
+        backBuffer.format = TextureFormat::RGBA8_UNORM;
+        backBuffer.usage = TextureUsage::Present;
+
+        RenderGraph graph(&device, queue.get());
+        SyntheticGraph synthetic(graph, config, &backBuffer);
+
+        synthetic.Declare();
+        graph.CaptureNextFrame();
+        graph.Execute(1);
+        queue->Signal(1);
+
+        const RenderGraphCapture *capture = graph.GetCapture();
+        if (!capture || !capture->Save(path)) {
+            return false;
+        }
+
+        std::printf("Captured %zu passes, %zu resources, %u commands to %s\n", capture->passes.size(),
+                    capture->resources.size(), capture->commandCount, path);
+        return true;
+    }
+
+    Options ParseOptions(int argc, char **argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--quick") == 0) {
+                options.quick = true;
+            } else if (std::strcmp(argv[i], "--csv") == 0) {
+                options.csv = true;
+            } else if (std::strcmp(argv[i], "--aliasing") == 0) {
+                options.aliasing = true;
+            } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                options.threads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            } else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc) {
+                options.capturePath = argv[++i];
+            } else {
+                std::fprintf(stderr, "Usage: %s [--quick] [--csv] [--aliasing] [--threads N] [--capture FILE]\n",
+                             argv[0]);
+                std::exit(1);
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char **argv) {
+    const Options options = ParseOptions(argc, argv);
+
+    if (options.capturePath) {
+        if (!CaptureFrame({Topology::Diamond, 100, 4}, options.capturePath)) {
+            std::fprintf(stderr, "Could not write capture to %s\n", options.capturePath);
+            return 1;
+        }
+        return 0;
+    }
+
+    std::vector<uint32_t> passCounts = {10, 100, 1000, 10000};
+    if (options.quick) {
+        passCounts = {10, 100, 1000};
+    }
+
+    if (options.csv) {
+        std::printf("topology,passes,resources_per_pass,declare_ms,compile_ms,cached_compile_ms,execute_ms,"
+                    "barriers,transient_bytes,peak_transient_bytes\n");
+    } else {
+        std::printf("%-8s %6s %4s %10s %12s %12s %10s %9s %12s %12s\n", "topology", "passes", "res",
+                    "declare", "compile", "cached", "execute", "barriers", "transient", "peak");
+    }
+
+    if (options.quick && !CheckMemoryBudget()) {
+        std::fprintf(stderr, "Memory budget check failed\n");
+        return 1;
+    }
+
+    if (options.quick && !CheckUavBarriers()) {
+        std::fprintf(stderr, "UAV barrier check failed\n");
+        return 1;
+    }
+
+    if (options.quick && !CheckAsyncCompute()) {
+        std::fprintf(stderr, "Async compute check failed\n");
+        return 1;
+    }
+
+    for (Topology topology: {Topology::Chain, Topology::FanOut, Topology::Diamond}) {
+        for (uint32_t passCount: passCounts) {
+            for (uint32_t resourcesPerPass: {1u, 4u}) {
+                BenchmarkConfig config{topology, passCount, resourcesPerPass};
+                if (options.quick && !CheckAliasing(config)) {
+                    std::fprintf(stderr, "Aliasing check failed for %s, %u passes, %u resources per pass\n",
+                                 TopologyName(topology), passCount, resourcesPerPass);
+                    return 1;
+                }
+
+                BenchmarkResult result = RunBenchmark(config, options);
+
+                if (options.csv) {
+                    std::printf("%s,%u,%u,%.4f,%.4f,%.4f,%.4f,%u,%llu,%llu\n", TopologyName(topology), passCount,
+                                resourcesPerPass, result.declareTime, result.coldCompileTime,
+                                result.cachedCompileTime, result.executeTime, result.barrierCount,
+                                (unsigned long long) result.transientBytes,
+                                (unsigned long long) result.peakTransientBytes);
+                } else {
+                    std::printf("%-8s %6u %4u %8.3fms %10.3fms %10.3fms %8.3fms %9u %10.2fMB %10.2fMB\n",
+                                TopologyName(topology), passCount, resourcesPerPass, result.declareTime,
+                                result.coldCompileTime, result.cachedCompileTime, result.executeTime,
+                                result.barrierCount, result.transientBytes / (1024.0 * 1024.0),
+                                result.peakTransientBytes / (1024.0 * 1024.0));
+                }
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    return 0;
+}
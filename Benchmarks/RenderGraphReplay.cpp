@@ -0,0 +1,232 @@
+//
+// Created by 2401Lucas on 2025-12-11.
+//
+// Headless replay of a captured RenderGraph frame. Rebuilds the captured passes against the recording
+// device, executes them repeatedly and reports compile and record timings, so a frame captured from
+// the renderer can be profiled and compared across graph changes without a GPU.
+//
+// Usage: RenderGraphReplay CAPTURE [--frames N] [--aliasing] [--threads N] [--null-device] [--deferred]
+//
+// --null-device replays against the RHI_NULL backend instead, whose resources hold CPU memory.
+// --deferred records into command streams first, record then excludes translation into the device's lists.
+//
+// Exits with 1 when a frame did not replay every captured command, or the device saw other barriers than
+// the graph reported plus the captured ones.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+
+#include "RecordingDevice.h"
+#include "Core/ThreadPool.h"
+#include "Rendering/RHI/Null/NullDevice.h"
+#include "Rendering/RenderGraph/RenderGraph.h"
+#include "Rendering/RenderGraph/RenderGraphCapture.h"
+
+namespace {
+    struct Options {
+        const char *capturePath = nullptr;
+        uint32_t frames = 100;
+        bool aliasing = false;
+        uint32_t threads = 0;
+        bool nullDevice = false;
+        bool deferred = false;
+    };
+
+    struct ReplayResult {
+        float declareTime = 0.0f;
+        float coldCompileTime = 0.0f; // Full compile after the plan was invalidated
+        float cachedCompileTime = 0.0f;
+        float recordTime = 0.0f;
+        float translateTime = 0.0f; // Command streams into native lists, with --deferred
+        float executeTime = 0.0f; // Recording and submission
+        uint64_t commands = 0; // Per frame, replayed and recorded by the graph
+        uint32_t barrierCount = 0;
+        uint32_t culledPassCount = 0;
+        uint64_t transientBytes = 0;
+
+        // Per frame, checked against the capture and the graph's statistics
+        uint64_t replayedCommands = 0;
+        uint64_t deviceBarriers = 0;
+        uint64_t expectedBarriers = 0; // Graph barriers plus replayed ones
+    };
+
+    // Commands the device saw, barriers excluded
+    uint64_t CommandCount(RecordingDevice &device) {
+        return device.counters.commands;
+    }
+
+    uint64_t CommandCount(NullDevice &device) {
+        const NullCounters &counters = device.GetCounters();
+        return counters.pipelines + counters.states + counters.bindings + counters.draws + counters.dispatches +
+               counters.clears + counters.copies + counters.discards + counters.queries +
+               counters.renderTargetBinds;
+    }
+
+    uint64_t BarrierCount(RecordingDevice &device) {
+        return device.counters.barriers;
+    }
+
+    uint64_t BarrierCount(NullDevice &device) {
+        return device.GetCounters().barriers;
+    }
+
+    void ResetCounters(RecordingDevice &device) {
+        device.counters.Reset();
+    }
+
+    void ResetCounters(NullDevice &device) {
+        device.GetCounters().Reset();
+    }
+
+    template<typename DeviceType>
+    ReplayResult Replay(const RenderGraphCapture &capture, const Options &options) {
+        DeviceType device;
+        std::unique_ptr<CommandQueue> queue(device.CreateCommandQueue({QueueType::Graphics, "Graphics"}));
+        std::unique_ptr<ThreadPool> threadPool;
+
+        ReplayResult result;
+        {
+            RenderGraphReplay replay(&device, capture);
+            RenderGraph graph(&device, queue.get());
+            graph.SetResourceAliasing(options.aliasing);
+            graph.SetDeferredRecording(options.deferred);
+            if (options.threads > 1) {
+                threadPool = std::make_unique<ThreadPool>(options.threads - 1);
+                graph.SetThreadPool(threadPool.get());
+            }
+
+            uint64_t fenceValue = 0;
+            auto runFrame = [&](bool invalidate) {
+                auto start = std::chrono::high_resolution_clock::now();
+                replay.Declare(graph);
+                result.declareTime += std::chrono::duration<float, std::milli>(
+                    std::chrono::high_resolution_clock::now() - start).count();
+
+                if (invalidate) {
+                    graph.InvalidatePlan();
+                }
+
+                graph.Execute(++fenceValue);
+                queue->Signal(fenceValue);
+                graph.Clear();
+                graph.NextFrame();
+            };
+
+            // Warm up the pool and plan cache, then time full compiles and cached frames separately
+            runFrame(false);
+            result.declareTime = 0.0f;
+
+            for (uint32_t i = 0; i < options.frames; ++i) {
+                runFrame(true);
+                result.coldCompileTime += graph.GetStatistics().lastRecompileTime;
+            }
+
+            ResetCounters(device);
+            const uint64_t replayedCommands = replay.GetReplayedCommandCount();
+            const uint64_t replayedBarriers = replay.GetReplayedBarrierCount();
+            uint64_t graphBarriers = 0;
+            for (uint32_t i = 0; i < options.frames; ++i) {
+                runFrame(false);
+                const RenderGraph::Statistics &stats = graph.GetStatistics();
+                graphBarriers += stats.barrierCount;
+                result.cachedCompileTime += stats.compileTime;
+                result.recordTime += stats.recordTime;
+                result.translateTime += stats.translateTime;
+                result.executeTime += stats.executeTime;
+            }
+
+            const RenderGraph::Statistics &stats = graph.GetStatistics();
+            const float frames = static_cast<float>(options.frames);
+            result.declareTime /= frames * 2.0f;
+            result.coldCompileTime /= frames;
+            result.cachedCompileTime /= frames;
+            result.recordTime /= frames;
+            result.translateTime /= frames;
+            result.executeTime /= frames;
+            result.commands = CommandCount(device) / options.frames;
+            result.barrierCount = stats.barrierCount;
+            result.culledPassCount = stats.culledPassCount + stats.disabledPassCount;
+            result.transientBytes = stats.transientMemoryUsed;
+
+            result.replayedCommands = (replay.GetReplayedCommandCount() - replayedCommands) / options.frames;
+            result.deviceBarriers = BarrierCount(device) / options.frames;
+            result.expectedBarriers = (graphBarriers + replay.GetReplayedBarrierCount() - replayedBarriers) /
+                                      options.frames;
+        }
+
+        return result;
+    }
+
+    Options ParseOptions(int argc, char **argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+                options.frames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            } else if (std::strcmp(argv[i], "--aliasing") == 0) {
+                options.aliasing = true;
+            } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+                options.threads = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            } else if (std::strcmp(argv[i], "--null-device") == 0) {
+                options.nullDevice = true;
+            } else if (std::strcmp(argv[i], "--deferred") == 0) {
+                options.deferred = true;
+            } else if (argv[i][0] != '-' && !options.capturePath) {
+                options.capturePath = argv[i];
+            } else {
+                options.capturePath = nullptr;
+                break;
+            }
+        }
+
+        if (!options.capturePath || options.frames == 0) {
+            std::fprintf(stderr,
+                         "Usage: %s CAPTURE [--frames N] [--aliasing] [--threads N] [--null-device] [--deferred]\n",
+                         argv[0]);
+            std::exit(1);
+        }
+        return options;
+    }
+}
+
+int main(int argc, char **argv) {
+    const Options options = ParseOptions(argc, argv);
+
+    try {
+        const RenderGraphCapture capture = RenderGraphCapture::Load(options.capturePath);
+        std::printf("%s: %zu passes, %zu resources, %zu objects, %u commands, %u pipelines\n",
+                    options.capturePath, capture.passes.size(), capture.resources.size(), capture.objects.size(),
+                    capture.commandCount, capture.pipelineCount);
+
+        const ReplayResult result = options.nullDevice
+                                        ? Replay<NullDevice>(capture, options)
+                                        : Replay<RecordingDevice>(capture, options);
+        std::printf("%10s %12s %12s %10s %10s %10s %10s %9s %7s %12s\n", "declare", "compile", "cached", "record",
+                    "translate", "execute", "commands", "barriers", "culled", "transient");
+        std::printf("%8.3fms %10.3fms %10.3fms %8.3fms %8.3fms %8.3fms %10llu %9u %7u %10.2fMB\n",
+                    result.declareTime, result.coldCompileTime, result.cachedCompileTime, result.recordTime,
+                    result.translateTime, result.executeTime,
+                    (unsigned long long) result.commands, result.barrierCount, result.culledPassCount,
+                    result.transientBytes / (1024.0 * 1024.0));
+
+        if (result.replayedCommands != capture.commandCount) {
+            std::fprintf(stderr, "Replayed %llu commands per frame, the capture has %u\n",
+                         (unsigned long long) result.replayedCommands, capture.commandCount);
+            return 1;
+        }
+        if (result.deviceBarriers != result.expectedBarriers) {
+            std::fprintf(stderr, "Device saw %llu barriers per frame, the graph and the capture account for %llu\n",
+                         (unsigned long long) result.deviceBarriers, (unsigned long long) result.expectedBarriers);
+            return 1;
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
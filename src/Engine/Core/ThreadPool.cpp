@@ -0,0 +1,80 @@
+//
+// Created by 2401Lucas on 2025-11-25.
+//
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t workerCount) {
+    if (workerCount == 0) {
+        workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    m_workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (auto &worker: m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Dispatch(uint32_t taskCount, const std::function<void(uint32_t)> &task) {
+    if (taskCount == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_task = &task;
+    m_taskCount = taskCount;
+    m_nextTask = 0;
+    m_pendingTasks = taskCount;
+    m_generation++;
+    m_workAvailable.notify_all();
+
+    // The calling thread works too instead of idling
+    RunTasks(lock);
+
+    m_workDone.wait(lock, [this] { return m_pendingTasks == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+    uint64_t seenGeneration = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_workAvailable.wait(lock, [&] { return m_stopping || m_generation != seenGeneration; });
+        if (m_stopping) {
+            return;
+        }
+
+        seenGeneration = m_generation;
+        RunTasks(lock);
+    }
+}
+
+void ThreadPool::RunTasks(std::unique_lock<std::mutex> &lock) {
+    while (m_task && m_nextTask < m_taskCount) {
+        uint32_t index = m_nextTask++;
+        const auto &task = *m_task;
+
+        lock.unlock();
+        task(index);
+        lock.lock();
+
+        if (--m_pendingTasks == 0) {
+            m_workDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+//
+// Created by 2401Lucas on 2025-11-25.
+//
+
+#ifndef GPU_PARTICLE_SIM_THREADPOOL_H
+#define GPU_PARTICLE_SIM_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Fixed set of worker threads for fork-join work.
+///
+/// Dispatch runs a task once per index across the workers and the calling thread, and returns
+/// when every index has finished. Only one Dispatch may run at a time.
+/// </summary>
+class ThreadPool {
+public:
+    /// <summary>
+    /// workerCount of 0 uses one worker per hardware thread, minus the calling thread
+    /// </summary>
+    explicit ThreadPool(uint32_t workerCount = 0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void Dispatch(uint32_t taskCount, const std::function<void(uint32_t)> &task);
+
+    /// <summary>
+    /// Workers plus the thread calling Dispatch
+    /// </summary>
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_workers.size()) + 1; }
+
+private:
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_workAvailable;
+    std::condition_variable m_workDone;
+
+    // Current dispatch, guarded by m_mutex
+    const std::function<void(uint32_t)> *m_task = nullptr;
+    uint32_t m_taskCount = 0;
+    uint32_t m_nextTask = 0;
+    uint32_t m_pendingTasks = 0;
+    uint64_t m_generation = 0;
+    bool m_stopping = false;
+
+    void WorkerLoop();
+
+    /// <summary>
+    /// Run tasks of the current dispatch until none are left. Called with the lock held.
+    /// </summary>
+    void RunTasks(std::unique_lock<std::mutex> &lock);
+};
+
+#endif //GPU_PARTICLE_SIM_THREADPOOL_H
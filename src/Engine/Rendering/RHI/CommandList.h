@@ -10,6 +10,7 @@
 #include "Buffer.h"
 #include "Pipeline.h"
 #include "Texture.h"
+#include "QueryHeap.h"
 #include "BindlessDescriptorManager.h"
 
 struct Viewport {
@@ -23,6 +24,99 @@ struct Rect {
     int32_t right, bottom;
 };
 
+/// <summary>
+/// One entry of a barrier batch. Exactly one of texture/buffer is set; states are
+/// TextureUsage or BufferUsage values depending on which.
+/// </summary>
+struct ResourceBarrier {
+    enum class Type {
+        Transition,
+        Aliasing, // Hand heap memory to the resource from any resource placed over it before, states are ignored
+        UAV, // Finish unordered access to the resource before later unordered access, states are ignored
+    } type = Type::Transition;
+
+    Texture *texture = nullptr;
+    Buffer *buffer = nullptr;
+
+    uint32_t stateBefore = 0;
+    uint32_t stateAfter = 0;
+
+    // Split transitions: Begin lets the GPU start the transition early, End completes it before use.
+    // Only valid when Device::SupportsSplitBarriers() is true.
+    enum class Split {
+        None,
+        Begin,
+        End,
+    } split = Split::None;
+
+    // Transitions of a texture can target one subresource (mip + slice * mipLevels)
+    static constexpr uint32_t AllSubresources = UINT32_MAX;
+    uint32_t subresource = AllSubresources;
+
+    static ResourceBarrier Transition(Texture *texture, TextureUsage before, TextureUsage after) {
+        return {Type::Transition, texture, nullptr, (uint32_t) before, (uint32_t) after};
+    }
+
+    static ResourceBarrier Transition(Buffer *buffer, BufferUsage before, BufferUsage after) {
+        return {Type::Transition, nullptr, buffer, (uint32_t) before, (uint32_t) after};
+    }
+
+    static ResourceBarrier Aliasing(Texture *after) {
+        return {Type::Aliasing, after, nullptr};
+    }
+
+    static ResourceBarrier Aliasing(Buffer *after) {
+        return {Type::Aliasing, nullptr, after};
+    }
+
+    static ResourceBarrier UAV(Texture *texture) {
+        return {Type::UAV, texture, nullptr};
+    }
+
+    static ResourceBarrier UAV(Buffer *buffer) {
+        return {Type::UAV, nullptr, buffer};
+    }
+};
+
+/// <summary>
+/// What happens to an attachment's contents when a render pass begins
+/// </summary>
+enum class AttachmentLoadOp {
+    Load, // Keep the previous contents
+    Clear, // Fill with the clear value
+    DontCare, // Contents are undefined, every pixel read is written first
+};
+
+/// <summary>
+/// What happens to an attachment's contents when a render pass ends
+/// </summary>
+enum class AttachmentStoreOp {
+    Store, // Later work reads the contents
+    Discard, // Nothing reads the contents again
+};
+
+struct ClearValue {
+    float color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float depth = 1.0f;
+    uint8_t stencil = 0;
+};
+
+struct RenderPassAttachment {
+    Texture *texture = nullptr;
+    AttachmentLoadOp loadOp = AttachmentLoadOp::Load;
+    AttachmentStoreOp storeOp = AttachmentStoreOp::Store;
+    ClearValue clearValue;
+};
+
+/// <summary>
+/// Attachments bound for the duration of a native render pass
+/// </summary>
+struct RenderPassBeginInfo {
+    const RenderPassAttachment *colorAttachments = nullptr;
+    uint32_t colorCount = 0;
+    const RenderPassAttachment *depthStencil = nullptr;
+};
+
 class CommandList {
 public:
     virtual ~CommandList() = default;
@@ -75,6 +169,12 @@ public:
     virtual void CopyBufferToTexture(Buffer *src, Texture *dst) = 0;
 
     // Resource Barriers
+
+    /// <summary>
+    /// Submit a batch of barriers with a single API call
+    /// </summary>
+    virtual void ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) = 0;
+
     virtual void TransitionTexture(Texture *texture,
                                    TextureUsage oldState,
                                    TextureUsage newState) = 0;
@@ -83,11 +183,38 @@ public:
                                   BufferUsage oldState,
                                   BufferUsage newState) = 0;
 
+    /// <summary>
+    /// Mark texture contents as undefined. Required for aliased render targets and depth
+    /// buffers that are not fully cleared or copied to on first use.
+    /// </summary>
+    virtual void DiscardTexture(Texture *texture) = 0;
+
+    // Queries
+
+    /// <summary>
+    /// Write the GPU timestamp into a query slot once preceding work has completed
+    /// </summary>
+    virtual void WriteTimestamp(QueryHeap *queryHeap, uint32_t index) = 0;
+
+    /// <summary>
+    /// Copy count query results, 8 bytes each, into a readback buffer at offset
+    /// </summary>
+    virtual void ResolveQueries(QueryHeap *queryHeap, uint32_t first, uint32_t count,
+                                Buffer *destination, uint64_t offset) = 0;
+
     // Render Targets
     virtual void SetRenderTarget(Texture *renderTarget, Texture *depthStencil = nullptr) = 0;
 
     virtual void SetRenderTargets(Texture **renderTargets, uint32_t count,
                                   Texture *depthStencil = nullptr) = 0;
+
+    /// <summary>
+    /// Bind attachments and apply their load ops; EndRenderPass applies the store ops.
+    /// Only valid when Device::SupportsRenderPasses() is true.
+    /// </summary>
+    virtual void BeginRenderPass(const RenderPassBeginInfo &info) = 0;
+
+    virtual void EndRenderPass() = 0;
 };
 
 #endif //GPU_PARTICLE_SIM_COMMANDLIST_H
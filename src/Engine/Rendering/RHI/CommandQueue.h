@@ -5,6 +5,7 @@
 #ifndef GPU_PARTICLE_SIM_COMMANDQUEUE_H
 #define GPU_PARTICLE_SIM_COMMANDQUEUE_H
 #include "CommandList.h"
+#include "Fence.h"
 
 enum class QueueType {
     Graphics, // Can do graphics, compute, and copy
@@ -12,6 +13,31 @@ enum class QueueType {
     Transfer // Can only do copy operations
 };
 
+/// <summary>
+/// Whether command lists of the queue can transition a resource into or out of the state, a TextureUsage
+/// or BufferUsage value. Compute lists cannot use pixel shader, render target, depth, present or index
+/// buffer states, copy lists only the copy states.
+/// </summary>
+inline bool IsQueueState(QueueType queue, bool texture, uint32_t state) {
+    switch (queue) {
+        case QueueType::Compute:
+            if (texture) {
+                TextureUsage usage = (TextureUsage) state;
+                return usage == TextureUsage::UnorderedAccess || usage == TextureUsage::NonPixelShaderResource ||
+                       usage == TextureUsage::CopySource || usage == TextureUsage::CopyDest;
+            }
+            return (state & (uint32_t) BufferUsage::Index) == 0;
+        case QueueType::Transfer:
+            if (texture) {
+                TextureUsage usage = (TextureUsage) state;
+                return usage == TextureUsage::CopySource || usage == TextureUsage::CopyDest;
+            }
+            return (state & ~((uint32_t) BufferUsage::CopySource | (uint32_t) BufferUsage::CopyDest)) == 0;
+        default:
+            return true;
+    }
+}
+
 struct CommandQueueCreateInfo {
     QueueType type = QueueType::Graphics;
     const char *debugName = nullptr;
@@ -26,6 +52,11 @@ public:
     /// </summary>
     virtual void Execute(CommandList *commandList) = 0;
 
+    /// <summary>
+    /// Executes several command lists in order with a single submission
+    /// </summary>
+    virtual void Execute(CommandList *const *commandLists, uint32_t count) = 0;
+
     /// <summary>
     /// Waits for a Queue to become Idle (D3D12 has no Device->WaitIdle() functionality)
     /// </summary>
@@ -35,6 +66,11 @@ public:
 
     virtual void WaitForFence(uint64_t fenceValue) = 0;
 
+    /// <summary>
+    /// Make the queue wait on the GPU until the fence reaches value. Does not block the CPU.
+    /// </summary>
+    virtual void Wait(Fence *fence, uint64_t value) = 0;
+
     /// <summary>
     /// Wait for frame fence and reset the frame resources
     /// </summary>
@@ -45,12 +81,18 @@ public:
     virtual uint64_t GetCompletedFenceValue() const = 0;
 
     /// <summary>
-    /// Assigns the memory for a CommandList from a Command Queue
+    /// Timestamp ticks per second for timestamps written on this queue
+    /// </summary>
+    virtual uint64_t GetTimestampFrequency() const = 0;
+
+    /// <summary>
+    /// Assigns the memory for a CommandList from a Command Queue.
+    /// Each frame has a set of allocators; lists recorded at the same time need different allocatorIndex values.
     /// </summary>
     /// <remarks>
     /// This is required for DX12 but unsure for vulkan, so the vulkan impl will be empty
     /// TODO: Investigate this
     /// </remarks>
-    virtual void AssignCommandList(CommandList *, uint32_t) = 0;
+    virtual void AssignCommandList(CommandList *, uint32_t frameIndex, uint32_t allocatorIndex) = 0;
 };
 #endif //GPU_PARTICLE_SIM_COMMANDQUEUE_H
@@ -0,0 +1,829 @@
+//
+// Created by 2401Lucas on 2025-12-13.
+//
+
+#include "CommandStream.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+    constexpr size_t StreamAlignment = 8;
+    constexpr size_t MinStreamCapacity = 64 * 1024;
+
+    constexpr size_t AlignStream(size_t size) {
+        return (size + StreamAlignment - 1) & ~(StreamAlignment - 1);
+    }
+
+    constexpr size_t HeaderSize = AlignStream(sizeof(CommandStream::Header));
+
+    // Arguments of each command as laid out in the stream
+    struct BeginArgs {
+        BindlessDescriptorManager *bindlessManager;
+    };
+
+    struct NoArgs {
+    };
+
+    struct PipelineArgs {
+        Pipeline *pipeline;
+    };
+
+    struct TextureArgs {
+        Texture *texture;
+    };
+
+    struct TopologyArgs {
+        PrimitiveTopology topology;
+    };
+
+    struct BufferSlotArgs {
+        Buffer *buffer;
+        uint32_t slot;
+        uint32_t offset;
+    };
+
+    struct TextureSlotArgs {
+        Texture *texture;
+        uint32_t slot;
+    };
+
+    struct DrawArgs {
+        uint32_t count;
+        uint32_t second; // Start vertex or index, or instance count
+    };
+
+    struct DispatchArgs {
+        uint32_t groupsX, groupsY, groupsZ;
+    };
+
+    struct ClearColorArgs {
+        Texture *texture;
+        float color[4];
+    };
+
+    struct ClearDepthArgs {
+        Texture *texture;
+        float depth;
+        uint8_t stencil;
+    };
+
+    struct CopyBufferArgs {
+        Buffer *src;
+        Buffer *dst;
+        uint64_t size;
+    };
+
+    struct TexturePairArgs {
+        Texture *first;
+        Texture *second;
+    };
+
+    struct BufferToTextureArgs {
+        Buffer *src;
+        Texture *dst;
+    };
+
+    struct ArrayArgs {
+        uint32_t count; // Elements of the array that follows
+    };
+
+    struct TransitionTextureArgs {
+        Texture *texture;
+        TextureUsage before;
+        TextureUsage after;
+    };
+
+    struct TransitionBufferArgs {
+        Buffer *buffer;
+        BufferUsage before;
+        BufferUsage after;
+    };
+
+    struct TimestampArgs {
+        QueryHeap *queryHeap;
+        uint32_t index;
+    };
+
+    struct ResolveArgs {
+        QueryHeap *queryHeap;
+        uint32_t first;
+        uint32_t count;
+        Buffer *destination;
+        uint64_t offset;
+    };
+
+    struct RenderTargetsArgs {
+        Texture *depthStencil;
+        uint32_t count;
+    };
+
+    struct RenderPassArgs {
+        uint32_t colorCount;
+        bool hasDepthStencil; // The depth attachment follows the color attachments
+    };
+
+    static_assert(std::is_trivially_copyable_v<ResourceBarrier>);
+    static_assert(std::is_trivially_copyable_v<RenderPassAttachment>);
+    static_assert(alignof(ResourceBarrier) <= StreamAlignment);
+    static_assert(alignof(RenderPassAttachment) <= StreamAlignment);
+
+    template<typename T>
+    const T &Arguments(const std::byte *command) {
+        return *reinterpret_cast<const T *>(command + HeaderSize);
+    }
+
+    template<typename T>
+    T &Arguments(std::byte *command) {
+        return *reinterpret_cast<T *>(command + HeaderSize);
+    }
+
+    template<typename T, typename Element>
+    const Element *ArrayOf(const std::byte *command) {
+        return reinterpret_cast<const Element *>(command + HeaderSize + AlignStream(sizeof(T)));
+    }
+
+    template<typename T, typename Element>
+    Element *ArrayOf(std::byte *command) {
+        return reinterpret_cast<Element *>(command + HeaderSize + AlignStream(sizeof(T)));
+    }
+
+    // Commands without arguments are written without room for them
+    template<typename T>
+    constexpr size_t ArgumentSize = std::is_empty_v<T> ? 0 : AlignStream(sizeof(T));
+
+    /// <summary>
+    /// Bytes of the command's arguments, 0 for an unknown command
+    /// </summary>
+    size_t ArgumentSizeOf(StreamCommand command) {
+        switch (command) {
+            case StreamCommand::Begin:
+                return ArgumentSize<BeginArgs>;
+            case StreamCommand::End:
+            case StreamCommand::EndRenderPass:
+                return ArgumentSize<NoArgs>;
+            case StreamCommand::SetPipeline:
+                return ArgumentSize<PipelineArgs>;
+            case StreamCommand::SetViewport:
+                return ArgumentSize<Viewport>;
+            case StreamCommand::SetScissor:
+                return ArgumentSize<Rect>;
+            case StreamCommand::SetPrimitiveTopology:
+                return ArgumentSize<TopologyArgs>;
+            case StreamCommand::SetVertexBuffer:
+            case StreamCommand::SetIndexBuffer:
+            case StreamCommand::SetConstantBuffer:
+                return ArgumentSize<BufferSlotArgs>;
+            case StreamCommand::SetTexture:
+                return ArgumentSize<TextureSlotArgs>;
+            case StreamCommand::Draw:
+            case StreamCommand::DrawIndexed:
+            case StreamCommand::DrawInstanced:
+            case StreamCommand::DrawIndexedInstanced:
+                return ArgumentSize<DrawArgs>;
+            case StreamCommand::Dispatch:
+                return ArgumentSize<DispatchArgs>;
+            case StreamCommand::ClearRenderTarget:
+                return ArgumentSize<ClearColorArgs>;
+            case StreamCommand::ClearDepthStencil:
+                return ArgumentSize<ClearDepthArgs>;
+            case StreamCommand::CopyBuffer:
+                return ArgumentSize<CopyBufferArgs>;
+            case StreamCommand::CopyTexture:
+            case StreamCommand::SetRenderTarget:
+                return ArgumentSize<TexturePairArgs>;
+            case StreamCommand::CopyBufferToTexture:
+                return ArgumentSize<BufferToTextureArgs>;
+            case StreamCommand::ResourceBarriers:
+                return ArgumentSize<ArrayArgs>;
+            case StreamCommand::TransitionTexture:
+                return ArgumentSize<TransitionTextureArgs>;
+            case StreamCommand::TransitionBuffer:
+                return ArgumentSize<TransitionBufferArgs>;
+            case StreamCommand::DiscardTexture:
+                return ArgumentSize<TextureArgs>;
+            case StreamCommand::WriteTimestamp:
+                return ArgumentSize<TimestampArgs>;
+            case StreamCommand::ResolveQueries:
+                return ArgumentSize<ResolveArgs>;
+            case StreamCommand::SetRenderTargets:
+                return ArgumentSize<RenderTargetsArgs>;
+            case StreamCommand::BeginRenderPass:
+                return ArgumentSize<RenderPassArgs>;
+            default:
+                return 0;
+        }
+    }
+
+    /// <summary>
+    /// Bytes of the array following the arguments, read from arguments already known to be in bounds
+    /// </summary>
+    size_t ArraySizeOf(const std::byte *command, StreamCommand type) {
+        switch (type) {
+            case StreamCommand::ResourceBarriers:
+                return Arguments<ArrayArgs>(command).count * sizeof(ResourceBarrier);
+            case StreamCommand::SetRenderTargets:
+                return Arguments<RenderTargetsArgs>(command).count * sizeof(Texture *);
+            case StreamCommand::BeginRenderPass: {
+                const auto &args = Arguments<RenderPassArgs>(command);
+                return (args.colorCount + (args.hasDepthStencil ? 1 : 0)) * sizeof(RenderPassAttachment);
+            }
+            default:
+                return 0;
+        }
+    }
+
+    template<typename T>
+    void RemapObject(T *&object, StreamObject type, const CommandStream::ObjectRemap &remap, uint32_t usage = 0) {
+        object = static_cast<T *>(remap(type, object, usage));
+    }
+
+    /// <summary>
+    /// Pass every object pointer of one command through remap, in place
+    /// </summary>
+    void RemapObjects(std::byte *command, StreamCommand type, const CommandStream::ObjectRemap &remap) {
+        switch (type) {
+            case StreamCommand::Begin:
+                RemapObject(Arguments<BeginArgs>(command).bindlessManager, StreamObject::BindlessManager, remap);
+                break;
+            case StreamCommand::SetPipeline:
+                RemapObject(Arguments<PipelineArgs>(command).pipeline, StreamObject::Pipeline, remap);
+                break;
+            case StreamCommand::SetVertexBuffer:
+                RemapObject(Arguments<BufferSlotArgs>(command).buffer, StreamObject::Buffer, remap,
+                            (uint32_t) BufferUsage::Vertex);
+                break;
+            case StreamCommand::SetIndexBuffer:
+                RemapObject(Arguments<BufferSlotArgs>(command).buffer, StreamObject::Buffer, remap,
+                            (uint32_t) BufferUsage::Index);
+                break;
+            case StreamCommand::SetConstantBuffer:
+                RemapObject(Arguments<BufferSlotArgs>(command).buffer, StreamObject::Buffer, remap,
+                            (uint32_t) BufferUsage::Uniform);
+                break;
+            case StreamCommand::SetTexture:
+                RemapObject(Arguments<TextureSlotArgs>(command).texture, StreamObject::Texture, remap);
+                break;
+            case StreamCommand::ClearRenderTarget:
+                RemapObject(Arguments<ClearColorArgs>(command).texture, StreamObject::Texture, remap);
+                break;
+            case StreamCommand::ClearDepthStencil:
+                RemapObject(Arguments<ClearDepthArgs>(command).texture, StreamObject::Texture, remap);
+                break;
+            case StreamCommand::CopyBuffer: {
+                auto &args = Arguments<CopyBufferArgs>(command);
+                RemapObject(args.src, StreamObject::Buffer, remap, (uint32_t) BufferUsage::CopySource);
+                RemapObject(args.dst, StreamObject::Buffer, remap, (uint32_t) BufferUsage::CopyDest);
+                break;
+            }
+            case StreamCommand::CopyTexture:
+            case StreamCommand::SetRenderTarget: {
+                auto &args = Arguments<TexturePairArgs>(command);
+                RemapObject(args.first, StreamObject::Texture, remap);
+                RemapObject(args.second, StreamObject::Texture, remap);
+                break;
+            }
+            case StreamCommand::CopyBufferToTexture: {
+                auto &args = Arguments<BufferToTextureArgs>(command);
+                RemapObject(args.src, StreamObject::Buffer, remap, (uint32_t) BufferUsage::CopySource);
+                RemapObject(args.dst, StreamObject::Texture, remap);
+                break;
+            }
+            case StreamCommand::ResourceBarriers: {
+                ResourceBarrier *barriers = ArrayOf<ArrayArgs, ResourceBarrier>(command);
+                for (uint32_t i = 0; i < Arguments<ArrayArgs>(command).count; ++i) {
+                    if (barriers[i].texture) {
+                        RemapObject(barriers[i].texture, StreamObject::Texture, remap);
+                    } else {
+                        RemapObject(barriers[i].buffer, StreamObject::Buffer, remap, barriers[i].stateAfter);
+                    }
+                }
+                break;
+            }
+            case StreamCommand::TransitionTexture:
+                RemapObject(Arguments<TransitionTextureArgs>(command).texture, StreamObject::Texture, remap);
+                break;
+            case StreamCommand::TransitionBuffer: {
+                auto &args = Arguments<TransitionBufferArgs>(command);
+                RemapObject(args.buffer, StreamObject::Buffer, remap, (uint32_t) args.after);
+                break;
+            }
+            case StreamCommand::DiscardTexture:
+                RemapObject(Arguments<TextureArgs>(command).texture, StreamObject::Texture, remap);
+                break;
+            case StreamCommand::WriteTimestamp:
+                RemapObject(Arguments<TimestampArgs>(command).queryHeap, StreamObject::QueryHeap, remap);
+                break;
+            case StreamCommand::ResolveQueries: {
+                auto &args = Arguments<ResolveArgs>(command);
+                RemapObject(args.queryHeap, StreamObject::QueryHeap, remap);
+                RemapObject(args.destination, StreamObject::Buffer, remap, (uint32_t) BufferUsage::CopyDest);
+                break;
+            }
+            case StreamCommand::SetRenderTargets: {
+                auto &args = Arguments<RenderTargetsArgs>(command);
+                Texture **renderTargets = ArrayOf<RenderTargetsArgs, Texture *>(command);
+                for (uint32_t i = 0; i < args.count; ++i) {
+                    RemapObject(renderTargets[i], StreamObject::Texture, remap);
+                }
+                RemapObject(args.depthStencil, StreamObject::Texture, remap);
+                break;
+            }
+            case StreamCommand::BeginRenderPass: {
+                const auto &args = Arguments<RenderPassArgs>(command);
+                RenderPassAttachment *attachments = ArrayOf<RenderPassArgs, RenderPassAttachment>(command);
+                for (uint32_t i = 0; i < args.colorCount + (args.hasDepthStencil ? 1u : 0u); ++i) {
+                    RemapObject(attachments[i].texture, StreamObject::Texture, remap);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    /// <summary>
+    /// State bound on the native list since the last Begin
+    /// </summary>
+    struct BoundState {
+        Pipeline *pipeline = nullptr;
+        Buffer *indexBuffer = nullptr;
+        PrimitiveTopology topology = PrimitiveTopology::TriangleList;
+        Viewport viewport{};
+        Rect scissor{};
+        bool hasTopology = false;
+        bool hasViewport = false;
+        bool hasScissor = false;
+    };
+}
+
+std::byte *CommandStream::Reserve(size_t size) {
+    if (m_size + size > m_capacity) {
+        size_t capacity = std::max({m_size + size, m_capacity * 2, MinStreamCapacity});
+        auto data = std::make_unique_for_overwrite<std::byte[]>(capacity);
+        if (m_size > 0) {
+            std::memcpy(data.get(), m_data.get(), m_size);
+        }
+        m_data = std::move(data);
+        m_capacity = capacity;
+    }
+
+    std::byte *reserved = m_data.get() + m_size;
+    m_size += size;
+    return reserved;
+}
+
+void *CommandStream::Allocate(StreamCommand command, size_t argumentSize, size_t arraySize) {
+    const size_t size = HeaderSize + AlignStream(argumentSize) + AlignStream(arraySize);
+    if (size > UINT32_MAX) {
+        throw std::runtime_error("CommandStream: command too large");
+    }
+
+    std::byte *header = Reserve(size);
+    const Header value{command, static_cast<uint32_t>(size)};
+    std::memcpy(header, &value, sizeof(value));
+
+    m_commandCount++;
+    return header + HeaderSize;
+}
+
+bool CommandStream::Assign(const std::byte *data, size_t size) {
+    Reset();
+    if (size == 0) {
+        return true;
+    }
+
+    std::byte *commands = Reserve(size);
+    std::memcpy(commands, data, size);
+
+    // Every header, argument block and array must lie inside the bytes, as the writing stream laid them out
+    size_t offset = 0;
+    while (offset < size) {
+        if (size - offset < HeaderSize) {
+            Reset();
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, commands + offset, sizeof(header));
+        const size_t argumentSize = ArgumentSizeOf(header.command);
+        const bool known = header.command < StreamCommand::Count &&
+                           (argumentSize > 0 || header.command == StreamCommand::End ||
+                            header.command == StreamCommand::EndRenderPass);
+        if (!known || header.size > size - offset || header.size < HeaderSize + argumentSize ||
+            header.size != HeaderSize + argumentSize + AlignStream(ArraySizeOf(commands + offset, header.command))) {
+            Reset();
+            return false;
+        }
+
+        offset += header.size;
+        m_commandCount++;
+    }
+    return true;
+}
+
+void CommandStream::Append(const CommandStream &source, const ObjectRemap &remap) {
+    const std::byte *command = source.m_data.get();
+    const std::byte *end = command + source.m_size;
+    while (command < end) {
+        const Header &header = *reinterpret_cast<const Header *>(command);
+        if (header.command != StreamCommand::Begin && header.command != StreamCommand::End) {
+            std::byte *copy = Reserve(header.size);
+            std::memcpy(copy, command, header.size);
+            RemapObjects(copy, header.command, remap);
+            m_commandCount++;
+        }
+        command += header.size;
+    }
+}
+
+CommandStream::TranslateResult CommandStream::Translate(CommandList *target, bool filterState) const {
+    TranslateResult result;
+    BoundState bound;
+
+    const std::byte *command = m_data.get();
+    const std::byte *end = command + m_size;
+    while (command < end) {
+        const Header &header = *reinterpret_cast<const Header *>(command);
+
+        switch (header.command) {
+            case StreamCommand::Begin:
+                bound = BoundState{};
+                target->Begin(Arguments<BeginArgs>(command).bindlessManager);
+                break;
+            case StreamCommand::End:
+                target->End();
+                break;
+            case StreamCommand::SetPipeline: {
+                Pipeline *pipeline = Arguments<PipelineArgs>(command).pipeline;
+                if (!pipeline || (filterState && pipeline == bound.pipeline)) {
+                    result.filtered++;
+                    command += header.size;
+                    continue;
+                }
+                bound.pipeline = pipeline;
+                target->SetPipeline(pipeline);
+                break;
+            }
+            case StreamCommand::SetViewport: {
+                const auto &viewport = Arguments<Viewport>(command);
+                if (filterState && bound.hasViewport &&
+                    std::memcmp(&viewport, &bound.viewport, sizeof(Viewport)) == 0) {
+                    result.filtered++;
+                    command += header.size;
+                    continue;
+                }
+                bound.viewport = viewport;
+                bound.hasViewport = true;
+                target->SetViewport(viewport);
+                break;
+            }
+            case StreamCommand::SetScissor: {
+                const auto &scissor = Arguments<Rect>(command);
+                if (filterState && bound.hasScissor && std::memcmp(&scissor, &bound.scissor, sizeof(Rect)) == 0) {
+                    result.filtered++;
+                    command += header.size;
+                    continue;
+                }
+                bound.scissor = scissor;
+                bound.hasScissor = true;
+                target->SetScissor(scissor);
+                break;
+            }
+            case StreamCommand::SetPrimitiveTopology: {
+                PrimitiveTopology topology = Arguments<TopologyArgs>(command).topology;
+                if (filterState && bound.hasTopology && topology == bound.topology) {
+                    result.filtered++;
+                    command += header.size;
+                    continue;
+                }
+                bound.topology = topology;
+                bound.hasTopology = true;
+                target->SetPrimitiveTopology(topology);
+                break;
+            }
+            case StreamCommand::SetVertexBuffer: {
+                const auto &args = Arguments<BufferSlotArgs>(command);
+                target->SetVertexBuffer(args.buffer, args.slot);
+                break;
+            }
+            case StreamCommand::SetIndexBuffer: {
+                Buffer *buffer = Arguments<BufferSlotArgs>(command).buffer;
+                if (filterState && buffer && buffer == bound.indexBuffer) {
+                    result.filtered++;
+                    command += header.size;
+                    continue;
+                }
+                bound.indexBuffer = buffer;
+                target->SetIndexBuffer(buffer);
+                break;
+            }
+            case StreamCommand::SetConstantBuffer: {
+                const auto &args = Arguments<BufferSlotArgs>(command);
+                target->SetConstantBuffer(args.buffer, args.slot, args.offset);
+                break;
+            }
+            case StreamCommand::SetTexture: {
+                const auto &args = Arguments<TextureSlotArgs>(command);
+                target->SetTexture(args.texture, args.slot);
+                break;
+            }
+            case StreamCommand::Draw: {
+                const auto &args = Arguments<DrawArgs>(command);
+                target->Draw(args.count, args.second);
+                break;
+            }
+            case StreamCommand::DrawIndexed: {
+                const auto &args = Arguments<DrawArgs>(command);
+                target->DrawIndexed(args.count, args.second);
+                break;
+            }
+            case StreamCommand::DrawInstanced: {
+                const auto &args = Arguments<DrawArgs>(command);
+                target->DrawInstanced(args.count, args.second);
+                break;
+            }
+            case StreamCommand::DrawIndexedInstanced: {
+                const auto &args = Arguments<DrawArgs>(command);
+                target->DrawIndexedInstanced(args.count, args.second);
+                break;
+            }
+            case StreamCommand::Dispatch: {
+                const auto &args = Arguments<DispatchArgs>(command);
+                target->Dispatch(args.groupsX, args.groupsY, args.groupsZ);
+                break;
+            }
+            case StreamCommand::ClearRenderTarget: {
+                const auto &args = Arguments<ClearColorArgs>(command);
+                target->ClearRenderTarget(args.texture, args.color);
+                break;
+            }
+            case StreamCommand::ClearDepthStencil: {
+                const auto &args = Arguments<ClearDepthArgs>(command);
+                target->ClearDepthStencil(args.texture, args.depth, args.stencil);
+                break;
+            }
+            case StreamCommand::CopyBuffer: {
+                const auto &args = Arguments<CopyBufferArgs>(command);
+                target->CopyBuffer(args.src, args.dst, args.size);
+                break;
+            }
+            case StreamCommand::CopyTexture: {
+                const auto &args = Arguments<TexturePairArgs>(command);
+                target->CopyTexture(args.first, args.second);
+                break;
+            }
+            case StreamCommand::CopyBufferToTexture: {
+                const auto &args = Arguments<BufferToTextureArgs>(command);
+                target->CopyBufferToTexture(args.src, args.dst);
+                break;
+            }
+            case StreamCommand::ResourceBarriers: {
+                const auto &args = Arguments<ArrayArgs>(command);
+                target->ResourceBarriers(ArrayOf<ArrayArgs, ResourceBarrier>(command), args.count);
+                result.barriers += args.count;
+                break;
+            }
+            case StreamCommand::TransitionTexture: {
+                const auto &args = Arguments<TransitionTextureArgs>(command);
+                target->TransitionTexture(args.texture, args.before, args.after);
+                result.barriers++;
+                break;
+            }
+            case StreamCommand::TransitionBuffer: {
+                const auto &args = Arguments<TransitionBufferArgs>(command);
+                target->TransitionBuffer(args.buffer, args.before, args.after);
+                result.barriers++;
+                break;
+            }
+            case StreamCommand::DiscardTexture:
+                target->DiscardTexture(Arguments<TextureArgs>(command).texture);
+                break;
+            case StreamCommand::WriteTimestamp: {
+                const auto &args = Arguments<TimestampArgs>(command);
+                target->WriteTimestamp(args.queryHeap, args.index);
+                break;
+            }
+            case StreamCommand::ResolveQueries: {
+                const auto &args = Arguments<ResolveArgs>(command);
+                target->ResolveQueries(args.queryHeap, args.first, args.count, args.destination, args.offset);
+                break;
+            }
+            case StreamCommand::SetRenderTarget: {
+                const auto &args = Arguments<TexturePairArgs>(command);
+                target->SetRenderTarget(args.first, args.second);
+                break;
+            }
+            case StreamCommand::SetRenderTargets: {
+                const auto &args = Arguments<RenderTargetsArgs>(command);
+                // The native list takes a mutable array, the stream is only read
+                auto *renderTargets = const_cast<Texture **>(ArrayOf<RenderTargetsArgs, Texture *>(command));
+                target->SetRenderTargets(renderTargets, args.count, args.depthStencil);
+                break;
+            }
+            case StreamCommand::BeginRenderPass: {
+                const auto &args = Arguments<RenderPassArgs>(command);
+                const RenderPassAttachment *attachments = ArrayOf<RenderPassArgs, RenderPassAttachment>(command);
+                RenderPassBeginInfo info{
+                    .colorAttachments = args.colorCount > 0 ? attachments : nullptr,
+                    .colorCount = args.colorCount,
+                    .depthStencil = args.hasDepthStencil ? attachments + args.colorCount : nullptr,
+                };
+                target->BeginRenderPass(info);
+                break;
+            }
+            case StreamCommand::EndRenderPass:
+                target->EndRenderPass();
+                break;
+            default:
+                throw std::runtime_error("CommandStream: unknown command");
+        }
+
+        result.commands++;
+        command += header.size;
+    }
+
+    return result;
+}
+
+template<typename T>
+void DeferredCommandList::Write(StreamCommand command, const T &arguments) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (!m_isRecording) {
+        throw std::runtime_error("DeferredCommandList: command recorded without Begin");
+    }
+    if constexpr (std::is_empty_v<T>) {
+        m_stream.Allocate(command, 0);
+    } else {
+        std::memcpy(m_stream.Allocate(command, sizeof(T)), &arguments, sizeof(T));
+    }
+}
+
+void DeferredCommandList::Begin(BindlessDescriptorManager *bindlessManager) {
+    if (m_isRecording) {
+        throw std::runtime_error("DeferredCommandList: Begin called while recording");
+    }
+
+    m_stream.Reset();
+    m_isRecording = true;
+    Write(StreamCommand::Begin, BeginArgs{bindlessManager});
+}
+
+void DeferredCommandList::End() {
+    Write(StreamCommand::End, NoArgs{});
+    m_isRecording = false;
+}
+
+void DeferredCommandList::SetPipeline(Pipeline *pipeline) {
+    Write(StreamCommand::SetPipeline, PipelineArgs{pipeline});
+}
+
+void DeferredCommandList::SetViewport(const Viewport &viewport) {
+    Write(StreamCommand::SetViewport, viewport);
+}
+
+void DeferredCommandList::SetScissor(const Rect &scissor) {
+    Write(StreamCommand::SetScissor, scissor);
+}
+
+void DeferredCommandList::SetPrimitiveTopology(PrimitiveTopology topology) {
+    Write(StreamCommand::SetPrimitiveTopology, TopologyArgs{topology});
+}
+
+void DeferredCommandList::SetVertexBuffer(Buffer *buffer, uint32_t slot) {
+    Write(StreamCommand::SetVertexBuffer, BufferSlotArgs{buffer, slot, 0});
+}
+
+void DeferredCommandList::SetIndexBuffer(Buffer *buffer) {
+    Write(StreamCommand::SetIndexBuffer, BufferSlotArgs{buffer, 0, 0});
+}
+
+void DeferredCommandList::SetConstantBuffer(Buffer *buffer, uint32_t slot, uint32_t offset) {
+    Write(StreamCommand::SetConstantBuffer, BufferSlotArgs{buffer, slot, offset});
+}
+
+void DeferredCommandList::SetTexture(Texture *texture, uint32_t slot) {
+    Write(StreamCommand::SetTexture, TextureSlotArgs{texture, slot});
+}
+
+void DeferredCommandList::Draw(uint32_t vertexCount, uint32_t startVertex) {
+    Write(StreamCommand::Draw, DrawArgs{vertexCount, startVertex});
+}
+
+void DeferredCommandList::DrawIndexed(uint32_t indexCount, uint32_t startIndex) {
+    Write(StreamCommand::DrawIndexed, DrawArgs{indexCount, startIndex});
+}
+
+void DeferredCommandList::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount) {
+    Write(StreamCommand::DrawInstanced, DrawArgs{vertexCount, instanceCount});
+}
+
+void DeferredCommandList::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount) {
+    Write(StreamCommand::DrawIndexedInstanced, DrawArgs{indexCount, instanceCount});
+}
+
+void DeferredCommandList::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    Write(StreamCommand::Dispatch, DispatchArgs{groupsX, groupsY, groupsZ});
+}
+
+void DeferredCommandList::ClearRenderTarget(Texture *texture, const float color[4]) {
+    ClearColorArgs args{texture, {color[0], color[1], color[2], color[3]}};
+    Write(StreamCommand::ClearRenderTarget, args);
+}
+
+void DeferredCommandList::ClearDepthStencil(Texture *texture, float depth, uint8_t stencil) {
+    Write(StreamCommand::ClearDepthStencil, ClearDepthArgs{texture, depth, stencil});
+}
+
+void DeferredCommandList::CopyBuffer(Buffer *src, Buffer *dst, uint64_t size) {
+    Write(StreamCommand::CopyBuffer, CopyBufferArgs{src, dst, size});
+}
+
+void DeferredCommandList::CopyTexture(Texture *src, Texture *dst) {
+    Write(StreamCommand::CopyTexture, TexturePairArgs{src, dst});
+}
+
+void DeferredCommandList::CopyBufferToTexture(Buffer *src, Texture *dst) {
+    Write(StreamCommand::CopyBufferToTexture, BufferToTextureArgs{src, dst});
+}
+
+void DeferredCommandList::ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) {
+    if (!m_isRecording) {
+        throw std::runtime_error("DeferredCommandList: command recorded without Begin");
+    }
+
+    const size_t arraySize = count * sizeof(ResourceBarrier);
+    void *args = m_stream.Allocate(StreamCommand::ResourceBarriers, sizeof(ArrayArgs), arraySize);
+    const ArrayArgs header{count};
+    std::memcpy(args, &header, sizeof(header));
+    if (count > 0) {
+        std::memcpy(static_cast<std::byte *>(args) + AlignStream(sizeof(ArrayArgs)), barriers, arraySize);
+    }
+}
+
+void DeferredCommandList::TransitionTexture(Texture *texture, TextureUsage oldState, TextureUsage newState) {
+    Write(StreamCommand::TransitionTexture, TransitionTextureArgs{texture, oldState, newState});
+}
+
+void DeferredCommandList::TransitionBuffer(Buffer *buffer, BufferUsage oldState, BufferUsage newState) {
+    Write(StreamCommand::TransitionBuffer, TransitionBufferArgs{buffer, oldState, newState});
+}
+
+void DeferredCommandList::DiscardTexture(Texture *texture) {
+    Write(StreamCommand::DiscardTexture, TextureArgs{texture});
+}
+
+void DeferredCommandList::WriteTimestamp(QueryHeap *queryHeap, uint32_t index) {
+    Write(StreamCommand::WriteTimestamp, TimestampArgs{queryHeap, index});
+}
+
+void DeferredCommandList::ResolveQueries(QueryHeap *queryHeap, uint32_t first, uint32_t count,
+                                         Buffer *destination, uint64_t offset) {
+    Write(StreamCommand::ResolveQueries, ResolveArgs{queryHeap, first, count, destination, offset});
+}
+
+void DeferredCommandList::SetRenderTarget(Texture *renderTarget, Texture *depthStencil) {
+    Write(StreamCommand::SetRenderTarget, TexturePairArgs{renderTarget, depthStencil});
+}
+
+void DeferredCommandList::SetRenderTargets(Texture **renderTargets, uint32_t count, Texture *depthStencil) {
+    if (!m_isRecording) {
+        throw std::runtime_error("DeferredCommandList: command recorded without Begin");
+    }
+
+    const size_t arraySize = count * sizeof(Texture *);
+    void *args = m_stream.Allocate(StreamCommand::SetRenderTargets, sizeof(RenderTargetsArgs), arraySize);
+    const RenderTargetsArgs header{depthStencil, count};
+    std::memcpy(args, &header, sizeof(header));
+    if (count > 0) {
+        std::memcpy(static_cast<std::byte *>(args) + AlignStream(sizeof(RenderTargetsArgs)), renderTargets,
+                    arraySize);
+    }
+}
+
+void DeferredCommandList::BeginRenderPass(const RenderPassBeginInfo &info) {
+    if (!m_isRecording) {
+        throw std::runtime_error("DeferredCommandList: command recorded without Begin");
+    }
+
+    // Color attachments first, the depth attachment after them
+    const bool hasDepthStencil = info.depthStencil != nullptr;
+    const size_t colorSize = info.colorCount * sizeof(RenderPassAttachment);
+    const size_t arraySize = colorSize + (hasDepthStencil ? sizeof(RenderPassAttachment) : 0);
+    void *args = m_stream.Allocate(StreamCommand::BeginRenderPass, sizeof(RenderPassArgs), arraySize);
+    const RenderPassArgs header{info.colorCount, hasDepthStencil};
+    std::memcpy(args, &header, sizeof(header));
+
+    std::byte *attachments = static_cast<std::byte *>(args) + AlignStream(sizeof(RenderPassArgs));
+    if (info.colorCount > 0) {
+        std::memcpy(attachments, info.colorAttachments, colorSize);
+    }
+    if (hasDepthStencil) {
+        std::memcpy(attachments + colorSize, info.depthStencil, sizeof(RenderPassAttachment));
+    }
+}
+
+void DeferredCommandList::EndRenderPass() {
+    Write(StreamCommand::EndRenderPass, NoArgs{});
+}
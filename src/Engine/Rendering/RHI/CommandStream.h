@@ -0,0 +1,221 @@
+//
+// Created by 2401Lucas on 2025-12-13.
+//
+
+#ifndef GPU_PARTICLE_SIM_COMMANDSTREAM_H
+#define GPU_PARTICLE_SIM_COMMANDSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "CommandList.h"
+
+/// <summary>
+/// Command of a CommandStream, one per CommandList call. SetRenderTarget is kept apart from
+/// SetRenderTargets so the backend sees the call that was made.
+/// </summary>
+enum class StreamCommand : uint16_t {
+    Begin,
+    End,
+    SetPipeline,
+    SetViewport,
+    SetScissor,
+    SetPrimitiveTopology,
+    SetVertexBuffer,
+    SetIndexBuffer,
+    SetConstantBuffer,
+    SetTexture,
+    Draw,
+    DrawIndexed,
+    DrawInstanced,
+    DrawIndexedInstanced,
+    Dispatch,
+    ClearRenderTarget,
+    ClearDepthStencil,
+    CopyBuffer,
+    CopyTexture,
+    CopyBufferToTexture,
+    ResourceBarriers,
+    TransitionTexture,
+    TransitionBuffer,
+    DiscardTexture,
+    WriteTimestamp,
+    ResolveQueries,
+    SetRenderTarget,
+    SetRenderTargets,
+    BeginRenderPass,
+    EndRenderPass,
+    Count
+};
+
+/// <summary>
+/// Kind of object a command argument points to, see CommandStream::Append
+/// </summary>
+enum class StreamObject : uint8_t {
+    Texture,
+    Buffer,
+    Pipeline,
+    QueryHeap,
+    BindlessManager,
+};
+
+/// <summary>
+/// Linear buffer of packed commands. Each command is a header followed by its arguments as plain
+/// data, 8 byte aligned; arrays passed by pointer (barriers, render targets, attachments) are copied in.
+/// Objects are referenced by pointer, they must outlive the translation. Storage is kept across
+/// Reset, so a stream reused every frame stops allocating once it has grown to the frame's size.
+/// </summary>
+class CommandStream {
+public:
+    struct Header {
+        StreamCommand command;
+        uint32_t size; // Bytes including the header, arguments and array
+    };
+
+    /// <summary>
+    /// What Translate issued to the native list
+    /// </summary>
+    struct TranslateResult {
+        uint32_t commands = 0;
+        uint32_t filtered = 0; // Redundant state changes and null pipelines left out
+        uint32_t barriers = 0; // Transition and aliasing barriers among the commands
+    };
+
+    /// <summary>
+    /// Replacement for an object pointer of a copied command. bufferUsage is the BufferUsage the command
+    /// uses a buffer with, 0 for other objects.
+    /// </summary>
+    using ObjectRemap = std::function<void *(StreamObject type, void *object, uint32_t bufferUsage)>;
+
+    void Reset() {
+        m_size = 0;
+        m_commandCount = 0;
+    }
+
+    size_t GetSize() const { return m_size; }
+
+    size_t GetCapacity() const { return m_capacity; }
+
+    uint32_t GetCommandCount() const { return m_commandCount; }
+
+    const std::byte *GetData() const { return m_data.get(); }
+
+    /// <summary>
+    /// Replace the commands with size bytes taken from another stream's GetData. Returns false, leaving
+    /// the stream empty, when they are not whole commands of this build.
+    /// </summary>
+    bool Assign(const std::byte *data, size_t size);
+
+    /// <summary>
+    /// Append every command of source except Begin and End, passing each object pointer through remap.
+    /// Frame captures use it to swap pointers for stable references, and replays to swap them back.
+    /// </summary>
+    void Append(const CommandStream &source, const ObjectRemap &remap);
+    /// <summary>
+    /// Issue every command on target in one pass. With filterState, pipeline, viewport, scissor,
+    /// topology and index buffer changes that set what is already bound since the last Begin are skipped.
+    /// A null pipeline is always skipped, it would unbind the state later draws need.
+    /// </summary>
+    TranslateResult Translate(CommandList *target, bool filterState) const;
+
+    /// <summary>
+    /// Append a command with room for its arguments followed by arraySize bytes, returns the
+    /// arguments. The array starts at the next 8 byte boundary. Valid until the next Allocate.
+    /// </summary>
+    void *Allocate(StreamCommand command, size_t argumentSize, size_t arraySize = 0);
+
+private:
+    std::unique_ptr<std::byte[]> m_data;
+    size_t m_size = 0;
+    size_t m_capacity = 0;
+    uint32_t m_commandCount = 0;
+
+    std::byte *Reserve(size_t size);
+};
+
+/// <summary>
+/// CommandList that records into a CommandStream instead of a native list. Recording only copies
+/// arguments, so it costs the same on every backend and measures what the caller spends apart from
+/// the driver. Begin resets the stream; CommandStream::Translate then replays Begin to End on a
+/// native list, on any thread.
+/// </summary>
+class DeferredCommandList final : public CommandList {
+public:
+    CommandStream &GetStream() { return m_stream; }
+
+    const CommandStream &GetStream() const { return m_stream; }
+
+    bool IsRecording() const { return m_isRecording; }
+
+    void Begin(BindlessDescriptorManager *bindlessManager = nullptr) override;
+
+    void End() override;
+
+    void SetPipeline(Pipeline *pipeline) override;
+
+    void SetViewport(const Viewport &viewport) override;
+
+    void SetScissor(const Rect &scissor) override;
+
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+
+    void SetVertexBuffer(Buffer *buffer, uint32_t slot) override;
+
+    void SetIndexBuffer(Buffer *buffer) override;
+
+    void SetConstantBuffer(Buffer *buffer, uint32_t slot, uint32_t offset) override;
+
+    void SetTexture(Texture *texture, uint32_t slot) override;
+
+    void Draw(uint32_t vertexCount, uint32_t startVertex) override;
+
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndex) override;
+
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount) override;
+
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount) override;
+
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+
+    void ClearRenderTarget(Texture *texture, const float color[4]) override;
+
+    void ClearDepthStencil(Texture *texture, float depth, uint8_t stencil) override;
+
+    void CopyBuffer(Buffer *src, Buffer *dst, uint64_t size) override;
+
+    void CopyTexture(Texture *src, Texture *dst) override;
+
+    void CopyBufferToTexture(Buffer *src, Texture *dst) override;
+
+    void ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) override;
+
+    void TransitionTexture(Texture *texture, TextureUsage oldState, TextureUsage newState) override;
+
+    void TransitionBuffer(Buffer *buffer, BufferUsage oldState, BufferUsage newState) override;
+
+    void DiscardTexture(Texture *texture) override;
+
+    void WriteTimestamp(QueryHeap *queryHeap, uint32_t index) override;
+
+    void ResolveQueries(QueryHeap *queryHeap, uint32_t first, uint32_t count,
+                        Buffer *destination, uint64_t offset) override;
+
+    void SetRenderTarget(Texture *renderTarget, Texture *depthStencil = nullptr) override;
+
+    void SetRenderTargets(Texture **renderTargets, uint32_t count, Texture *depthStencil = nullptr) override;
+
+    void BeginRenderPass(const RenderPassBeginInfo &info) override;
+
+    void EndRenderPass() override;
+
+private:
+    CommandStream m_stream;
+    bool m_isRecording = false;
+
+    template<typename T>
+    void Write(StreamCommand command, const T &arguments);
+};
+
+#endif //GPU_PARTICLE_SIM_COMMANDSTREAM_H
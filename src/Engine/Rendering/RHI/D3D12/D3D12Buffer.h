@@ -14,6 +14,7 @@ struct D3D12Buffer : public Buffer {
     size_t size = 0;
     uint32_t stride = 0;
     BufferUsage usage = BufferUsage::Vertex;
+    MemoryType memoryType = MemoryType::GPU;
     D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
     void *mappedData = nullptr;
 
@@ -44,10 +45,10 @@ struct D3D12Buffer : public Buffer {
         return gpuAddress;
     }
 
-    // TODO: Add ability for readback
     void *Map() override {
         if (!mappedData && resource) {
-            D3D12_RANGE readRange = {0, 0}; //  The buffer will not be read on CPU
+            // Only readback buffers are read on the CPU
+            D3D12_RANGE readRange = {0, memoryType == MemoryType::Readback ? size : 0};
             if (SUCCEEDED(resource->Map(0, &readRange, &mappedData))) {
                 return mappedData;
             }
@@ -58,7 +59,8 @@ struct D3D12Buffer : public Buffer {
     // Unmap buffer
     void Unmap() override {
         if (mappedData && resource) {
-            D3D12_RANGE writtenRange = {0, size}; // Assume the entire buffer was written
+            // Assume the entire buffer was written, readback buffers are never written by the CPU
+            D3D12_RANGE writtenRange = {0, memoryType == MemoryType::Readback ? 0 : size};
             resource->Unmap(0, &writtenRange);
             mappedData = nullptr;
         }
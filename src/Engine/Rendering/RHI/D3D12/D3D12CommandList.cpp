@@ -6,6 +6,8 @@
 #include "D3D12Buffer.h"
 #include "D3D12Texture.h"
 #include "D3D12Pipeline.h"
+#include "D3D12QueryHeap.h"
+#include <algorithm>
 #include <stdexcept>
 
 void D3D12CommandList::Begin(BindlessDescriptorManager *bindlessManager) {
@@ -218,6 +220,63 @@ void D3D12CommandList::ClearDepthStencil(Texture *texture, float depth, uint8_t
     }
 }
 
+void D3D12CommandList::ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) {
+    if (!barriers || count == 0 || !m_isRecording) return;
+
+    m_barrierScratch.clear();
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const ResourceBarrier &desc = barriers[i];
+
+        ID3D12Resource *resource = nullptr;
+        if (desc.texture) {
+            resource = static_cast<D3D12Texture *>(desc.texture)->resource.Get();
+        } else if (desc.buffer) {
+            resource = static_cast<D3D12Buffer *>(desc.buffer)->resource.Get();
+        }
+        if (!resource) continue;
+
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+
+        if (desc.type == ResourceBarrier::Type::Aliasing) {
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+            barrier.Aliasing.pResourceBefore = nullptr;
+            barrier.Aliasing.pResourceAfter = resource;
+        } else if (desc.type == ResourceBarrier::Type::UAV) {
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+            barrier.UAV.pResource = resource;
+        } else {
+            D3D12_RESOURCE_STATES before = desc.texture
+                                               ? TextureUsageToD3D12State((TextureUsage) desc.stateBefore)
+                                               : BufferUsageToD3D12State((BufferUsage) desc.stateBefore);
+            D3D12_RESOURCE_STATES after = desc.texture
+                                              ? TextureUsageToD3D12State((TextureUsage) desc.stateAfter)
+                                              : BufferUsageToD3D12State((BufferUsage) desc.stateAfter);
+            if (before == after) continue;
+
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            if (desc.split == ResourceBarrier::Split::Begin) {
+                barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+            } else if (desc.split == ResourceBarrier::Split::End) {
+                barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+            }
+            barrier.Transition.pResource = resource;
+            barrier.Transition.Subresource = desc.subresource == ResourceBarrier::AllSubresources
+                                                 ? D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+                                                 : desc.subresource;
+            barrier.Transition.StateBefore = before;
+            barrier.Transition.StateAfter = after;
+        }
+
+        m_barrierScratch.push_back(barrier);
+    }
+
+    if (!m_barrierScratch.empty()) {
+        m_cmdList->ResourceBarrier(static_cast<UINT>(m_barrierScratch.size()), m_barrierScratch.data());
+    }
+}
+
 void D3D12CommandList::TransitionTexture(Texture *texture, TextureUsage oldState, TextureUsage newState) {
     if (!texture || !m_isRecording) return;
     if (oldState == newState) return; // No transition needed
@@ -262,6 +321,26 @@ void D3D12CommandList::TransitionBuffer(Buffer *buffer, BufferUsage oldState, Bu
     }
 }
 
+void D3D12CommandList::DiscardTexture(Texture *texture) {
+    if (!texture || !m_isRecording) return;
+
+    m_cmdList->DiscardResource(static_cast<D3D12Texture *>(texture)->resource.Get(), nullptr);
+}
+
+void D3D12CommandList::WriteTimestamp(QueryHeap *queryHeap, uint32_t index) {
+    if (!queryHeap || !m_isRecording) return;
+
+    m_cmdList->EndQuery(static_cast<D3D12QueryHeap *>(queryHeap)->heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, index);
+}
+
+void D3D12CommandList::ResolveQueries(QueryHeap *queryHeap, uint32_t first, uint32_t count,
+                                      Buffer *destination, uint64_t offset) {
+    if (!queryHeap || !destination || count == 0 || !m_isRecording) return;
+
+    m_cmdList->ResolveQueryData(static_cast<D3D12QueryHeap *>(queryHeap)->heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+                                first, count, static_cast<D3D12Buffer *>(destination)->resource.Get(), offset);
+}
+
 void D3D12CommandList::SetRenderTarget(Texture *renderTarget, Texture *depthStencil) {
     if (!m_isRecording) return;
 
@@ -307,6 +386,84 @@ void D3D12CommandList::SetRenderTargets(Texture **renderTargets, uint32_t count,
     m_cmdList->OMSetRenderTargets(count, count > 0 ? rtvHandles : nullptr, FALSE, dsvHandle);
 }
 
+namespace {
+    D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE ToBeginningAccess(AttachmentLoadOp loadOp) {
+        switch (loadOp) {
+            case AttachmentLoadOp::Clear:
+                return D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_CLEAR;
+            case AttachmentLoadOp::DontCare:
+                return D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_DISCARD;
+            default:
+                return D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_PRESERVE;
+        }
+    }
+
+    D3D12_RENDER_PASS_ENDING_ACCESS_TYPE ToEndingAccess(AttachmentStoreOp storeOp) {
+        return storeOp == AttachmentStoreOp::Discard
+                   ? D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_DISCARD
+                   : D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_PRESERVE;
+    }
+}
+
+void D3D12CommandList::BeginRenderPass(const RenderPassBeginInfo &info) {
+    if (!m_isRecording || !m_cmdList4) return;
+
+    uint32_t count = std::min(info.colorCount, (uint32_t) D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT);
+    D3D12_RENDER_PASS_RENDER_TARGET_DESC renderTargets[D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT] = {};
+
+    for (uint32_t i = 0; i < count; ++i) {
+        const RenderPassAttachment &attachment = info.colorAttachments[i];
+        D3D12Texture *rt = static_cast<D3D12Texture *>(attachment.texture);
+
+        D3D12_RENDER_PASS_RENDER_TARGET_DESC &desc = renderTargets[i];
+        desc.cpuDescriptor = rt->rtvHandle;
+        desc.BeginningAccess.Type = ToBeginningAccess(attachment.loadOp);
+        if (attachment.loadOp == AttachmentLoadOp::Clear) {
+            D3D12_CLEAR_VALUE &clear = desc.BeginningAccess.Clear.ClearValue;
+            clear.Format = rt->resource->GetDesc().Format;
+            std::copy_n(attachment.clearValue.color, 4, clear.Color);
+        }
+        desc.EndingAccess.Type = ToEndingAccess(attachment.storeOp);
+    }
+
+    D3D12_RENDER_PASS_DEPTH_STENCIL_DESC depthStencil = {};
+    if (info.depthStencil) {
+        const RenderPassAttachment &attachment = *info.depthStencil;
+        D3D12Texture *ds = static_cast<D3D12Texture *>(attachment.texture);
+
+        depthStencil.cpuDescriptor = ds->dsvHandle;
+        depthStencil.DepthBeginningAccess.Type = ToBeginningAccess(attachment.loadOp);
+        depthStencil.DepthEndingAccess.Type = ToEndingAccess(attachment.storeOp);
+
+        // Stencil planes only exist on combined formats, the ops apply to both planes
+        bool hasStencil = ds->format == TextureFormat::Depth24Stencil8;
+        depthStencil.StencilBeginningAccess.Type = hasStencil
+                                                       ? depthStencil.DepthBeginningAccess.Type
+                                                       : D3D12_RENDER_PASS_BEGINNING_ACCESS_TYPE_NO_ACCESS;
+        depthStencil.StencilEndingAccess.Type = hasStencil
+                                                    ? depthStencil.DepthEndingAccess.Type
+                                                    : D3D12_RENDER_PASS_ENDING_ACCESS_TYPE_NO_ACCESS;
+
+        if (attachment.loadOp == AttachmentLoadOp::Clear) {
+            D3D12_CLEAR_VALUE clear = {};
+            clear.Format = ds->resource->GetDesc().Format;
+            clear.DepthStencil.Depth = attachment.clearValue.depth;
+            clear.DepthStencil.Stencil = attachment.clearValue.stencil;
+            depthStencil.DepthBeginningAccess.Clear.ClearValue = clear;
+            depthStencil.StencilBeginningAccess.Clear.ClearValue = clear;
+        }
+    }
+
+    m_cmdList4->BeginRenderPass(count, count > 0 ? renderTargets : nullptr,
+                                info.depthStencil ? &depthStencil : nullptr, D3D12_RENDER_PASS_FLAG_NONE);
+}
+
+void D3D12CommandList::EndRenderPass() {
+    if (!m_isRecording || !m_cmdList4) return;
+
+    m_cmdList4->EndRenderPass();
+}
+
 void D3D12CommandList::BindBindlessDescriptorHeaps(
     D3D12BindlessDescriptorManager *manager) {
     if (!m_isRecording || !manager) return;
@@ -440,6 +597,8 @@ D3D12_RESOURCE_STATES D3D12CommandList::TextureUsageToD3D12State(TextureUsage us
             return D3D12_RESOURCE_STATE_COPY_SOURCE;
         case TextureUsage::CopyDest:
             return D3D12_RESOURCE_STATE_COPY_DEST;
+        case TextureUsage::NonPixelShaderResource:
+            return D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
         case TextureUsage::Present:
             return D3D12_RESOURCE_STATE_PRESENT;
         default:
@@ -9,6 +9,8 @@
 #include "Rendering/RHI/CommandList.h"
 #include "D3D12Common.h"
 
+#include <vector>
+
 class D3D12CommandList : public CommandList {
 public:
     D3D12CommandList() = default;
@@ -40,12 +42,22 @@ public:
     void CopyTexture(Texture *src, Texture *dst) override;
     void CopyBufferToTexture(Buffer *src, Texture *dst) override;
 
+    void ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) override;
     void TransitionTexture(Texture *texture, TextureUsage oldState, TextureUsage newState) override;
     void TransitionBuffer(Buffer *buffer, BufferUsage oldState, BufferUsage newState) override;
 
+    void DiscardTexture(Texture *texture) override;
+
+    void WriteTimestamp(QueryHeap *queryHeap, uint32_t index) override;
+    void ResolveQueries(QueryHeap *queryHeap, uint32_t first, uint32_t count,
+                        Buffer *destination, uint64_t offset) override;
+
     void SetRenderTarget(Texture *renderTarget, Texture *depthStencil) override;
     void SetRenderTargets(Texture **renderTargets, uint32_t count, Texture *depthStencil) override;
 
+    void BeginRenderPass(const RenderPassBeginInfo &info) override;
+    void EndRenderPass() override;
+
     // D3D12-specific
     ID3D12GraphicsCommandList* GetNative() const { return m_cmdList.Get(); }
 
@@ -60,6 +72,7 @@ private:
     friend class D3D12CommandQueue;
 
     ComPtr<ID3D12GraphicsCommandList> m_cmdList;
+    ComPtr<ID3D12GraphicsCommandList4> m_cmdList4; // Null when the runtime has no render pass support
     ID3D12CommandAllocator* m_allocator = nullptr; // NOT owned - queue owns it
     D3D12_COMMAND_LIST_TYPE m_commandListType = D3D12_COMMAND_LIST_TYPE_DIRECT;
 
@@ -68,6 +81,9 @@ private:
     D3D12_PRIMITIVE_TOPOLOGY m_currentTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
     bool m_isRecording = false;
 
+    // Scratch storage for batched barriers, reused between calls
+    std::vector<D3D12_RESOURCE_BARRIER> m_barrierScratch;
+
     ID3D12RootSignature* m_currentRootSignature;
 
     // Helper functions
@@ -5,6 +5,7 @@
 #include "D3D12CommandQueue.h"
 
 #include "D3D12CommandList.h"
+#include "D3D12Fence.h"
 
 D3D12CommandQueue::~D3D12CommandQueue() {
     // Wait for GPU to finish before destroying resources
@@ -27,8 +28,11 @@ void D3D12CommandQueue::BeginFrame(uint32_t frameIndex) {
         WaitForFence(fenceValue);
     }
 
-    // Reset allocator for this frame
+    // Reset allocators for this frame
     DX_CHECK(m_allocators[frameIndex]->Reset());
+    for (auto &allocator: m_extraAllocators[frameIndex]) {
+        DX_CHECK(allocator->Reset());
+    }
 }
 
 void D3D12CommandQueue::Execute(CommandList *commandList) {
@@ -37,6 +41,17 @@ void D3D12CommandQueue::Execute(CommandList *commandList) {
     m_commandQueue->ExecuteCommandLists(1, lists);
 }
 
+void D3D12CommandQueue::Execute(CommandList *const *commandLists, uint32_t count) {
+    m_submitScratch.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        m_submitScratch.push_back(static_cast<D3D12CommandList *>(commandLists[i])->GetNative());
+    }
+
+    if (!m_submitScratch.empty()) {
+        m_commandQueue->ExecuteCommandLists(count, m_submitScratch.data());
+    }
+}
+
 void D3D12CommandQueue::Signal(uint64_t fenceValue) {
     DX_CHECK(m_commandQueue->Signal(m_fence.Get(), fenceValue));
     m_fenceValues[m_currentFrameIndex] = fenceValue;
@@ -50,20 +65,45 @@ void D3D12CommandQueue::WaitForFence(uint64_t fenceValue) {
     }
 }
 
+void D3D12CommandQueue::Wait(Fence *fence, uint64_t value) {
+    D3D12Fence *d3d12Fence = static_cast<D3D12Fence *>(fence);
+    DX_CHECK(m_commandQueue->Wait(d3d12Fence->GetNative(), value));
+}
+
 void D3D12CommandQueue::WaitIdle() {
     uint64_t fenceValue = m_nextFenceValue++;
     DX_CHECK(m_commandQueue->Signal(m_fence.Get(), fenceValue));
     WaitForFence(fenceValue);
 }
 
-void D3D12CommandQueue::AssignCommandList(CommandList* cmdList, uint32_t frameIndex) {
+void D3D12CommandQueue::AssignCommandList(CommandList* cmdList, uint32_t frameIndex, uint32_t allocatorIndex) {
     D3D12CommandList* d3d12CmdList = static_cast<D3D12CommandList*>(cmdList);
-    d3d12CmdList->SetAllocator(m_allocators[frameIndex].Get());
+    if (allocatorIndex == 0) {
+        d3d12CmdList->SetAllocator(m_allocators[frameIndex].Get());
+        return;
+    }
+
+    auto &extraAllocators = m_extraAllocators[frameIndex];
+    while (extraAllocators.size() < allocatorIndex) {
+        ComPtr<ID3D12Device> device;
+        DX_CHECK(m_commandQueue->GetDevice(IID_PPV_ARGS(&device)));
+
+        ComPtr<ID3D12CommandAllocator> allocator;
+        DX_CHECK(device->CreateCommandAllocator(m_d3d12Type, IID_PPV_ARGS(&allocator)));
+        extraAllocators.push_back(allocator);
+    }
+
+    d3d12CmdList->SetAllocator(extraAllocators[allocatorIndex - 1].Get());
 }
 
 uint64_t D3D12CommandQueue::GetCompletedFenceValue() const {
-    return m_nextFenceValue;
+    return m_fence->GetCompletedValue();
+}
 
+uint64_t D3D12CommandQueue::GetTimestampFrequency() const {
+    uint64_t frequency = 0;
+    DX_CHECK(m_commandQueue->GetTimestampFrequency(&frequency));
+    return frequency;
 }
 
 ID3D12CommandAllocator *D3D12CommandQueue::GetAllocator(uint32_t frameIndex) const {
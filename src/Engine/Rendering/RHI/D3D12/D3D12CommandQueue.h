@@ -17,16 +17,22 @@ public:
 
     void Execute(CommandList* commandList) override;
 
+    void Execute(CommandList *const *commandLists, uint32_t count) override;
+
     void Signal(uint64_t signalValue) override;
 
     void WaitForFence(uint64_t fenceValue) override;
 
+    void Wait(Fence *fence, uint64_t value) override;
+
     void WaitIdle() override;
 
-    void AssignCommandList(CommandList*, uint32_t) override;
+    void AssignCommandList(CommandList*, uint32_t frameIndex, uint32_t allocatorIndex) override;
 
     uint64_t GetCompletedFenceValue() const override;
 
+    uint64_t GetTimestampFrequency() const override;
+
     QueueType GetType() const override { return m_type; }
     ID3D12CommandQueue* GetNative() const { return m_commandQueue.Get(); }
     ID3D12CommandAllocator* GetAllocator(uint32_t frameIndex) const;
@@ -37,6 +43,9 @@ private:
     ComPtr<ID3D12CommandQueue> m_commandQueue;
     ComPtr<ID3D12Fence> m_fence;
     std::vector<ComPtr<ID3D12CommandAllocator>> m_allocators;
+    // Extra allocators per frame for lists recorded in parallel, created on demand
+    std::vector<std::vector<ComPtr<ID3D12CommandAllocator>>> m_extraAllocators;
+    std::vector<ID3D12CommandList *> m_submitScratch;
     std::vector<uint64_t> m_fenceValues;
 
     HANDLE m_fenceEvent = nullptr;
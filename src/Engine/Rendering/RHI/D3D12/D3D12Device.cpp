@@ -9,6 +9,7 @@
 #include <sstream>
 
 #include "D3D12CommandQueue.h"
+#include "D3D12Fence.h"
 
 ComPtr<IDXGIAdapter4> SelectAdapter(ComPtr<IDXGIFactory6> factory, uint32_t preferredIndex) {
     ComPtr<IDXGIAdapter4> chosenAdapter;
@@ -306,6 +307,12 @@ D3D12Device::D3D12Device(const DeviceCreateInfo &info) {
 
     CheckBindlessSupport();
 
+    // Tier 0 is a software emulation, no cheaper than clearing and discarding ourselves
+    D3D12_FEATURE_DATA_D3D12_OPTIONS5 options5 = {};
+    if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS5, &options5, sizeof(options5)))) {
+        m_supportsRenderPasses = options5.RenderPassesTier >= D3D12_RENDER_PASS_TIER_1;
+    }
+
 #if defined(_DEBUG)
     if (info.enableDebugLayer) {
         ComPtr<ID3D12InfoQueue> infoQueue;
@@ -505,6 +512,11 @@ CommandList *D3D12Device::CreateCommandList(QueueType queueType) {
     // Close immediately as it starts recording upon creation
     cmdList->m_cmdList->Close();
 
+    // Render passes need the newer interface, older runtimes fall back to clears and discards
+    if (SupportsRenderPasses()) {
+        cmdList->m_cmdList.As(&cmdList->m_cmdList4);
+    }
+
     const wchar_t *typeName = GetQueueTypeName(queueType);
     std::wstring name = std::wstring(typeName) + L" CommandList";
     cmdList->m_cmdList->SetName(name.c_str());
@@ -605,6 +617,7 @@ CommandQueue *D3D12Device::CreateCommandQueue(const CommandQueueCreateInfo &crea
 
         // Create per-frame command allocators
         queue->m_allocators.resize(FrameCount);
+        queue->m_extraAllocators.resize(FrameCount);
         queue->m_fenceValues.resize(FrameCount, 0);
 
         for (uint32_t i = 0; i < FrameCount; ++i) {
@@ -645,12 +658,7 @@ CommandQueue *D3D12Device::CreateCommandQueue(const CommandQueueCreateInfo &crea
     return queue.release();
 }
 
-Buffer *D3D12Device::CreateBuffer(const BufferCreateInfo &desc) {
-    auto buffer = std::make_unique<D3D12Buffer>();
-    buffer->size = desc.size;
-    buffer->usage = desc.usage;
-    buffer->stride = desc.stride;
-
+D3D12_RESOURCE_DESC D3D12Device::BuildBufferResourceDesc(const BufferCreateInfo &desc) {
     D3D12_RESOURCE_DESC resourceDesc = {
         .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
         .Alignment = 0,
@@ -666,33 +674,15 @@ Buffer *D3D12Device::CreateBuffer(const BufferCreateInfo &desc) {
         .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
         .Flags = D3D12_RESOURCE_FLAG_NONE,
     };
-    // Determine heap type and initial state based on usage
-    D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
-    D3D12_RESOURCE_STATES initialState = BufferUsageToResourceState(desc.usage);
-
-    if (desc.memoryType == MemoryType::Upload) {
-        heapType = D3D12_HEAP_TYPE_UPLOAD;
-        initialState = D3D12_RESOURCE_STATE_GENERIC_READ;
-    } else if (desc.memoryType == MemoryType::Readback) {
-        heapType = D3D12_HEAP_TYPE_READBACK;
-        initialState = D3D12_RESOURCE_STATE_COPY_DEST;
-    }
 
     if (desc.usage == BufferUsage::UnorderedAccess) {
         resourceDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
     }
 
-    CD3DX12_HEAP_PROPERTIES heapProps(heapType);
-    DX_CHECK(m_device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &resourceDesc,
-        initialState,
-        nullptr,
-        IID_PPV_ARGS(&buffer->resource)));
-
-    m_stateTracker.TrackResource(buffer->resource.Get(), initialState);
+    return resourceDesc;
+}
 
+void D3D12Device::CreateBufferViews(D3D12Buffer *buffer, const BufferCreateInfo &desc) {
     // Cache GPU address
     buffer->gpuAddress = buffer->resource->GetGPUVirtualAddress();
 
@@ -739,18 +729,78 @@ Buffer *D3D12Device::CreateBuffer(const BufferCreateInfo &desc) {
         };
         buffer->cbvHandle = m_bindlessManager->AllocateCBV(&cbvDesc);
     }
+}
+
+Buffer *D3D12Device::CreateBuffer(const BufferCreateInfo &desc) {
+    auto buffer = std::make_unique<D3D12Buffer>();
+    buffer->size = desc.size;
+    buffer->usage = desc.usage;
+    buffer->stride = desc.stride;
+    buffer->memoryType = desc.memoryType;
+
+    D3D12_RESOURCE_DESC resourceDesc = BuildBufferResourceDesc(desc);
+
+    // Determine heap type and initial state based on usage
+    D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT;
+    D3D12_RESOURCE_STATES initialState = BufferUsageToResourceState(desc.usage);
+
+    if (desc.memoryType == MemoryType::Upload) {
+        heapType = D3D12_HEAP_TYPE_UPLOAD;
+        initialState = D3D12_RESOURCE_STATE_GENERIC_READ;
+    } else if (desc.memoryType == MemoryType::Readback) {
+        heapType = D3D12_HEAP_TYPE_READBACK;
+        initialState = D3D12_RESOURCE_STATE_COPY_DEST;
+    }
 
+    CD3DX12_HEAP_PROPERTIES heapProps(heapType);
+    DX_CHECK(m_device->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &resourceDesc,
+        initialState,
+        nullptr,
+        IID_PPV_ARGS(&buffer->resource)));
+
+    m_stateTracker.TrackResource(buffer->resource.Get(), initialState);
+
+    CreateBufferViews(buffer.get(), desc);
 
     return buffer.release();
 }
 
-Texture *D3D12Device::CreateTexture(const TextureCreateInfo &desc) {
-    D3D12Texture *texture = new D3D12Texture();
-    texture->width = desc.width;
-    texture->height = desc.height;
-    texture->format = desc.format;
-    texture->usage = desc.usage;
+Buffer *D3D12Device::CreatePlacedBuffer(const BufferCreateInfo &desc, Heap *heap, uint64_t offset) {
+    if (!heap || heap->resourceClass != HeapResourceClass::Buffers) {
+        throw std::runtime_error("CreatePlacedBuffer: heap cannot hold buffers");
+    }
+
+    if (desc.memoryType != MemoryType::GPU) {
+        throw std::runtime_error("CreatePlacedBuffer: only GPU memory buffers can be placed");
+    }
 
+    auto buffer = std::make_unique<D3D12Buffer>();
+    buffer->size = desc.size;
+    buffer->usage = desc.usage;
+    buffer->stride = desc.stride;
+
+    D3D12_RESOURCE_DESC resourceDesc = BuildBufferResourceDesc(desc);
+    D3D12_RESOURCE_STATES initialState = BufferUsageToResourceState(desc.usage);
+
+    DX_CHECK(m_device->CreatePlacedResource(
+        static_cast<D3D12Heap *>(heap)->heap.Get(),
+        offset,
+        &resourceDesc,
+        initialState,
+        nullptr,
+        IID_PPV_ARGS(&buffer->resource)));
+
+    m_stateTracker.TrackResource(buffer->resource.Get(), initialState);
+
+    CreateBufferViews(buffer.get(), desc);
+
+    return buffer.release();
+}
+
+D3D12_RESOURCE_DESC D3D12Device::BuildTextureResourceDesc(const TextureCreateInfo &desc) {
     D3D12_RESOURCE_DESC resourceDesc = {
         .Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D,
         .Alignment = 0,
@@ -766,7 +816,6 @@ Texture *D3D12Device::CreateTexture(const TextureCreateInfo &desc) {
         .Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN,
         .Flags = D3D12_RESOURCE_FLAG_NONE,
     };
-    D3D12_RESOURCE_STATES initialState = TextureUsageToResourceState(desc.usage);
 
     if (desc.usage == TextureUsage::RenderTarget) {
         resourceDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
@@ -776,41 +825,41 @@ Texture *D3D12Device::CreateTexture(const TextureCreateInfo &desc) {
         resourceDesc.Flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
     }
 
-    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+    return resourceDesc;
+}
 
-    D3D12_CLEAR_VALUE *clearValue = nullptr;
-    D3D12_CLEAR_VALUE clearValueData = {};
+const D3D12_CLEAR_VALUE *D3D12Device::GetOptimizedClearValue(const TextureCreateInfo &desc,
+                                                             D3D12_CLEAR_VALUE &clearValueData) {
+    clearValueData = {};
 
     if (desc.usage == TextureUsage::RenderTarget) {
-        clearValueData.Format = resourceDesc.Format;
+        clearValueData.Format = TextureFormatToDxgiFormat(desc.format);
         clearValueData.Color[0] = 0.0f;
         clearValueData.Color[1] = 0.0f;
         clearValueData.Color[2] = 0.0f;
         clearValueData.Color[3] = 1.0f;
-        clearValue = &clearValueData;
-    } else if (desc.usage == TextureUsage::DepthStencil) {
-        clearValueData.Format = resourceDesc.Format;
+        return &clearValueData;
+    }
+
+    if (desc.usage == TextureUsage::DepthStencil) {
+        clearValueData.Format = TextureFormatToDxgiFormat(desc.format);
         clearValueData.DepthStencil.Depth = 1.0f;
         clearValueData.DepthStencil.Stencil = 0;
-        clearValue = &clearValueData;
+        return &clearValueData;
     }
 
-    DX_CHECK(m_device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &resourceDesc,
-        initialState,
-        clearValue,
-        IID_PPV_ARGS(&texture->resource)));
+    return nullptr;
+}
 
-    m_stateTracker.TrackResource(texture->resource.Get(), initialState);
+void D3D12Device::CreateTextureViews(D3D12Texture *texture, const TextureCreateInfo &desc) {
+    DXGI_FORMAT format = TextureFormatToDxgiFormat(desc.format);
 
     // Create views
     // RTV and DSV remain non-bindless (they must be CPU descriptors)
     if (desc.usage == TextureUsage::RenderTarget) {
         texture->rtvHandle = m_rtvHeap->AllocateCPU();
         D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {
-            .Format = resourceDesc.Format,
+            .Format = format,
             .ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D,
             .Texture2D = {.MipSlice = 0},
         };
@@ -820,7 +869,7 @@ Texture *D3D12Device::CreateTexture(const TextureCreateInfo &desc) {
     if (desc.usage == TextureUsage::DepthStencil) {
         texture->dsvHandle = m_dsvHeap->AllocateCPU();
         D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc = {
-            .Format = resourceDesc.Format,
+            .Format = format,
             .ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D,
             .Flags = D3D12_DSV_FLAG_NONE,
             .Texture2D = {.MipSlice = 0},
@@ -829,9 +878,10 @@ Texture *D3D12Device::CreateTexture(const TextureCreateInfo &desc) {
     }
 
     // Create bindless SRV for shader access
-    if (desc.usage == TextureUsage::ShaderResource || desc.usage == TextureUsage::RenderTarget) {
+    if (desc.usage == TextureUsage::ShaderResource || desc.usage == TextureUsage::NonPixelShaderResource ||
+        desc.usage == TextureUsage::RenderTarget) {
         D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {
-            .Format = resourceDesc.Format,
+            .Format = format,
             .ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D,
             .Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING,
             .Texture2D = {
@@ -845,17 +895,163 @@ Texture *D3D12Device::CreateTexture(const TextureCreateInfo &desc) {
     // Create bindless UAV for RW access
     if (desc.usage == TextureUsage::UnorderedAccess) {
         D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {
-            .Format = resourceDesc.Format,
+            .Format = format,
             .ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D,
             .Texture2D = {.MipSlice = 0},
         };
         texture->uavHandle = m_bindlessManager->AllocateUAV(texture->resource.Get(), &uavDesc);
     }
+}
 
+Texture *D3D12Device::CreateTexture(const TextureCreateInfo &desc) {
+    D3D12Texture *texture = new D3D12Texture();
+    texture->width = desc.width;
+    texture->height = desc.height;
+    texture->mipLevels = desc.mipLevels;
+    texture->format = desc.format;
+    texture->usage = desc.usage;
+
+    D3D12_RESOURCE_DESC resourceDesc = BuildTextureResourceDesc(desc);
+    D3D12_RESOURCE_STATES initialState = TextureUsageToResourceState(desc.usage);
+
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
+
+    D3D12_CLEAR_VALUE clearValueData = {};
+    const D3D12_CLEAR_VALUE *clearValue = GetOptimizedClearValue(desc, clearValueData);
+
+    DX_CHECK(m_device->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &resourceDesc,
+        initialState,
+        clearValue,
+        IID_PPV_ARGS(&texture->resource)));
+
+    m_stateTracker.TrackResource(texture->resource.Get(), initialState);
+
+    CreateTextureViews(texture, desc);
 
     return texture;
 }
 
+Texture *D3D12Device::CreatePlacedTexture(const TextureCreateInfo &desc, Heap *heap, uint64_t offset) {
+    bool isRenderTarget = desc.usage == TextureUsage::RenderTarget || desc.usage == TextureUsage::DepthStencil;
+    HeapResourceClass requiredClass = isRenderTarget ? HeapResourceClass::RenderTargets : HeapResourceClass::Textures;
+    if (!heap || heap->resourceClass != requiredClass) {
+        throw std::runtime_error("CreatePlacedTexture: heap cannot hold this texture usage");
+    }
+
+    D3D12Texture *texture = new D3D12Texture();
+    texture->width = desc.width;
+    texture->height = desc.height;
+    texture->mipLevels = desc.mipLevels;
+    texture->format = desc.format;
+    texture->usage = desc.usage;
+
+    D3D12_RESOURCE_DESC resourceDesc = BuildTextureResourceDesc(desc);
+    D3D12_RESOURCE_STATES initialState = TextureUsageToResourceState(desc.usage);
+
+    D3D12_CLEAR_VALUE clearValueData = {};
+    const D3D12_CLEAR_VALUE *clearValue = GetOptimizedClearValue(desc, clearValueData);
+
+    DX_CHECK(m_device->CreatePlacedResource(
+        static_cast<D3D12Heap *>(heap)->heap.Get(),
+        offset,
+        &resourceDesc,
+        initialState,
+        clearValue,
+        IID_PPV_ARGS(&texture->resource)));
+
+    m_stateTracker.TrackResource(texture->resource.Get(), initialState);
+
+    CreateTextureViews(texture, desc);
+
+    return texture;
+}
+
+Heap *D3D12Device::CreateHeap(const HeapCreateInfo &desc) {
+    auto heap = std::make_unique<D3D12Heap>();
+    heap->size = desc.size;
+    heap->resourceClass = desc.resourceClass;
+
+    D3D12_HEAP_FLAGS flags = D3D12_HEAP_FLAG_NONE;
+    switch (desc.resourceClass) {
+        case HeapResourceClass::Buffers:
+            flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+            break;
+        case HeapResourceClass::Textures:
+            flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+            break;
+        case HeapResourceClass::RenderTargets:
+            flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+            break;
+    }
+
+    D3D12_HEAP_DESC heapDesc = {
+        .SizeInBytes = desc.size,
+        .Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        .Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT,
+        .Flags = flags,
+    };
+
+    DX_CHECK(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap->heap)));
+
+    if (desc.debugName) {
+        std::wstring name(desc.debugName, desc.debugName + strlen(desc.debugName));
+        DX_CHECK(heap->heap->SetName(name.c_str()));
+    }
+
+    return heap.release();
+}
+
+QueryHeap *D3D12Device::CreateQueryHeap(const QueryHeapCreateInfo &desc) {
+    auto queryHeap = std::make_unique<D3D12QueryHeap>();
+    queryHeap->type = desc.type;
+    queryHeap->count = desc.count;
+
+    D3D12_QUERY_HEAP_DESC heapDesc = {
+        .Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP,
+        .Count = desc.count,
+        .NodeMask = 0,
+    };
+
+    DX_CHECK(m_device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&queryHeap->heap)));
+
+    if (desc.debugName) {
+        std::wstring name(desc.debugName, desc.debugName + strlen(desc.debugName));
+        DX_CHECK(queryHeap->heap->SetName(name.c_str()));
+    }
+
+    return queryHeap.release();
+}
+
+Fence *D3D12Device::CreateFence(uint64_t initialValue) {
+    auto fence = std::make_unique<D3D12Fence>();
+
+    DX_CHECK(m_device->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence->m_fence)));
+
+    fence->m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (fence->m_fenceEvent == nullptr) {
+        DX_CHECK(HRESULT_FROM_WIN32(GetLastError()));
+    }
+
+    return fence.release();
+}
+
+ResourceAllocationInfo D3D12Device::GetTextureAllocationInfo(const TextureCreateInfo &desc) const {
+    D3D12_RESOURCE_DESC resourceDesc = BuildTextureResourceDesc(desc);
+    D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+
+    return ResourceAllocationInfo{.size = info.SizeInBytes, .alignment = info.Alignment};
+}
+
+ResourceAllocationInfo D3D12Device::GetBufferAllocationInfo(const BufferCreateInfo &desc) const {
+    D3D12_RESOURCE_DESC resourceDesc = BuildBufferResourceDesc(desc);
+    D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &resourceDesc);
+
+    return ResourceAllocationInfo{.size = info.SizeInBytes, .alignment = info.Alignment};
+}
+
 void D3D12Device::DestroyBuffer(Buffer *buffer) {
     if (buffer) {
         D3D12Buffer *d3d12Buf = static_cast<D3D12Buffer *>(buffer);
@@ -896,6 +1092,14 @@ void D3D12Device::DestroyPipeline(Pipeline *pipeline) {
     delete pipeline;
 }
 
+void D3D12Device::DestroyHeap(Heap *heap) {
+    delete heap;
+}
+
+void D3D12Device::DestroyQueryHeap(QueryHeap *queryHeap) {
+    delete queryHeap;
+}
+
 bool D3D12Device::SupportsRayTracing() const {
     D3D12_FEATURE_DATA_D3D12_OPTIONS5 options5 = {};
     if (SUCCEEDED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS5, &options5, sizeof(options5)))) {
@@ -912,6 +1116,11 @@ bool D3D12Device::SupportsMeshShaders() const {
     return false;
 }
 
+bool D3D12Device::SupportsSplitBarriers() const {
+    // Part of core D3D12
+    return true;
+}
+
 uint64_t D3D12Device::GetVideoMemoryBudget() const {
     DXGI_QUERY_VIDEO_MEMORY_INFO memInfo = {};
     if (SUCCEEDED(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memInfo))) {
@@ -1400,6 +1609,7 @@ D3D12_RESOURCE_STATES D3D12Device::BufferUsageToResourceState(BufferUsage usage)
 D3D12_RESOURCE_STATES D3D12Device::TextureUsageToResourceState(TextureUsage usage) {
     switch (usage) {
         case TextureUsage::ShaderResource: return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        case TextureUsage::NonPixelShaderResource: return D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
         case TextureUsage::RenderTarget: return D3D12_RESOURCE_STATE_RENDER_TARGET;
         case TextureUsage::DepthStencil: return D3D12_RESOURCE_STATE_DEPTH_WRITE;
         case TextureUsage::UnorderedAccess: return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
@@ -16,6 +16,8 @@
 #include "D3D12Pipeline.h"
 #include "D3D12Buffer.h"
 #include "D3D12Texture.h"
+#include "D3D12Heap.h"
+#include "D3D12QueryHeap.h"
 #include "D3D12CommandList.h"
 #include "D3D12Swapchain.h"
 
@@ -139,12 +141,26 @@ public:
 
     Pipeline *CreatePipeline(const PipelineCreateInfo &pipelineCreateInfo) override;
 
+    Heap *CreateHeap(const HeapCreateInfo &desc) override;
+
+    Fence *CreateFence(uint64_t initialValue) override;
+
+    QueryHeap *CreateQueryHeap(const QueryHeapCreateInfo &desc) override;
+
+    Texture *CreatePlacedTexture(const TextureCreateInfo &desc, Heap *heap, uint64_t offset) override;
+
+    Buffer *CreatePlacedBuffer(const BufferCreateInfo &desc, Heap *heap, uint64_t offset) override;
+
     void DestroyBuffer(Buffer *buffer) override;
 
     void DestroyTexture(Texture *texture) override;
 
     void DestroyPipeline(Pipeline *pipeline) override;
 
+    void DestroyHeap(Heap *heap) override;
+
+    void DestroyQueryHeap(QueryHeap *queryHeap) override;
+
     void UploadBufferData(Buffer *buffer, const void *data, size_t size) override;
 
     void UploadTextureData(Texture *texture, const void *data, size_t size) override;
@@ -153,8 +169,16 @@ public:
 
     bool SupportsMeshShaders() const override;
 
+    bool SupportsSplitBarriers() const override;
+
+    bool SupportsRenderPasses() const override { return m_supportsRenderPasses; }
+
     uint64_t GetVideoMemoryBudget() const override;
 
+    ResourceAllocationInfo GetTextureAllocationInfo(const TextureCreateInfo &desc) const override;
+
+    ResourceAllocationInfo GetBufferAllocationInfo(const BufferCreateInfo &desc) const override;
+
     void FlushUploads() override;
 
     void WaitIdle() override;
@@ -175,6 +199,7 @@ public:
 private:
     ComPtr<ID3D12Device> m_device;
     ComPtr<IDXGIAdapter4> m_adapter;
+    bool m_supportsRenderPasses = false; // Queried once at creation, the graph asks every frame
     ComPtr<ID3D12RootSignature> m_graphicsRootSignature;
     ComPtr<ID3D12RootSignature> m_computeRootSignature;
     std::unique_ptr<D3D12CommandQueue> m_uploadCommandQueue;
@@ -230,6 +255,17 @@ private:
 
     static std::string ShaderTargetToString(ShaderStage stage);
 
+    static D3D12_RESOURCE_DESC BuildBufferResourceDesc(const BufferCreateInfo &desc);
+
+    static D3D12_RESOURCE_DESC BuildTextureResourceDesc(const TextureCreateInfo &desc);
+
+    static const D3D12_CLEAR_VALUE *GetOptimizedClearValue(const TextureCreateInfo &desc,
+                                                           D3D12_CLEAR_VALUE &clearValueData);
+
+    void CreateBufferViews(D3D12Buffer *buffer, const BufferCreateInfo &desc);
+
+    void CreateTextureViews(D3D12Texture *texture, const TextureCreateInfo &desc);
+
     static DXGI_FORMAT TextureFormatToDxgiFormat(TextureFormat format);
 
     static D3D12_RESOURCE_STATES BufferUsageToResourceState(BufferUsage usage);
@@ -0,0 +1,34 @@
+//
+// Created by 2401Lucas on 2025-11-24.
+//
+
+#include "D3D12Fence.h"
+
+#include "D3D12CommandQueue.h"
+
+D3D12Fence::~D3D12Fence() {
+    if (m_fenceEvent) {
+        CloseHandle(m_fenceEvent);
+        m_fenceEvent = nullptr;
+    }
+}
+
+void D3D12Fence::Signal(CommandQueue *queue, uint64_t value) {
+    D3D12CommandQueue *d3d12Queue = static_cast<D3D12CommandQueue *>(queue);
+    DX_CHECK(d3d12Queue->GetNative()->Signal(m_fence.Get(), value));
+}
+
+void D3D12Fence::WaitCPU(uint64_t value) {
+    if (m_fence->GetCompletedValue() < value) {
+        DX_CHECK(m_fence->SetEventOnCompletion(value, m_fenceEvent));
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+    }
+}
+
+uint64_t D3D12Fence::GetCompletedValue() const {
+    return m_fence->GetCompletedValue();
+}
+
+void D3D12Fence::Reset(uint64_t value) {
+    DX_CHECK(m_fence->Signal(value));
+}
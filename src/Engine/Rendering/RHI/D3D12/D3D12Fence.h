@@ -0,0 +1,33 @@
+//
+// Created by 2401Lucas on 2025-11-24.
+//
+
+#ifndef GPU_PARTICLE_SIM_D3D12FENCE_H
+#define GPU_PARTICLE_SIM_D3D12FENCE_H
+
+#include "../Fence.h"
+#include "D3D12Common.h"
+
+class D3D12Fence : public Fence {
+public:
+    D3D12Fence() = default;
+    ~D3D12Fence() override;
+
+    void Signal(CommandQueue *queue, uint64_t value) override;
+
+    void WaitCPU(uint64_t value) override;
+
+    uint64_t GetCompletedValue() const override;
+
+    void Reset(uint64_t value = 0) override;
+
+    ID3D12Fence *GetNative() const { return m_fence.Get(); }
+
+private:
+    friend class D3D12Device;
+
+    ComPtr<ID3D12Fence> m_fence;
+    HANDLE m_fenceEvent = nullptr;
+};
+
+#endif //GPU_PARTICLE_SIM_D3D12FENCE_H
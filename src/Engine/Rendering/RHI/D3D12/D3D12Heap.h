@@ -0,0 +1,16 @@
+//
+// Created by 2401Lucas on 2025-11-21.
+//
+
+#ifndef GPU_PARTICLE_SIM_D3D12HEAP_H
+#define GPU_PARTICLE_SIM_D3D12HEAP_H
+
+#include "../Heap.h"
+#include "D3D12Common.h"
+
+class D3D12Heap : public Heap {
+public:
+    ComPtr<ID3D12Heap> heap;
+};
+
+#endif //GPU_PARTICLE_SIM_D3D12HEAP_H
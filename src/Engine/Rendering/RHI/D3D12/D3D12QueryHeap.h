@@ -0,0 +1,16 @@
+//
+// Created by 2401Lucas on 2025-12-03.
+//
+
+#ifndef GPU_PARTICLE_SIM_D3D12QUERYHEAP_H
+#define GPU_PARTICLE_SIM_D3D12QUERYHEAP_H
+
+#include "../QueryHeap.h"
+#include "D3D12Common.h"
+
+class D3D12QueryHeap : public QueryHeap {
+public:
+    ComPtr<ID3D12QueryHeap> heap;
+};
+
+#endif //GPU_PARTICLE_SIM_D3D12QUERYHEAP_H
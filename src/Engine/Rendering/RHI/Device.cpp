@@ -12,6 +12,10 @@
 #include "Vulkan/VulkanDevice.h"
 #endif
 
+#ifdef RHI_NULL
+#include "Null/NullDevice.h"
+#endif
+
 
 std::unique_ptr<Device> Device::Create(const DeviceCreateInfo &desc) {
     // Choose backend based on platform or config
@@ -19,6 +23,8 @@ std::unique_ptr<Device> Device::Create(const DeviceCreateInfo &desc) {
     return std::make_unique<D3D12Device>(desc);
 #elif defined(RHI_VULKAN)
     return std::make_unique<VulkanDevice> (desc);
+#elif defined(RHI_NULL)
+    return std::make_unique<NullDevice>(desc);
 #else
 #error "No RHI backend defined"
 #endif
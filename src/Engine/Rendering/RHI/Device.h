@@ -11,6 +11,8 @@
 #include "BindlessDescriptorManager.h"
 #include "Swapchain.h"
 #include "CommandQueue.h"
+#include "Heap.h"
+#include "QueryHeap.h"
 
 struct DeviceCreateInfo {
     bool enableDebugLayer = false;
@@ -42,6 +44,20 @@ public:
 
     virtual Pipeline *CreatePipeline(const PipelineCreateInfo &desc) = 0;
 
+    virtual Heap *CreateHeap(const HeapCreateInfo &desc) = 0;
+
+    virtual Fence *CreateFence(uint64_t initialValue = 0) = 0;
+
+    virtual QueryHeap *CreateQueryHeap(const QueryHeapCreateInfo &desc) = 0;
+
+    /// <summary>
+    /// Create a resource at an offset inside a heap. The heap must outlive the resource,
+    /// and the offset must honour the alignment reported by Get*AllocationInfo.
+    /// </summary>
+    virtual Texture *CreatePlacedTexture(const TextureCreateInfo &desc, Heap *heap, uint64_t offset) = 0;
+
+    virtual Buffer *CreatePlacedBuffer(const BufferCreateInfo &desc, Heap *heap, uint64_t offset) = 0;
+
     // Resource Management
 
     virtual void UploadBufferData(Buffer *buffer, const void *data, size_t size) = 0;
@@ -56,14 +72,30 @@ public:
 
     virtual void DestroyPipeline(Pipeline *pipeline) = 0;
 
+    virtual void DestroyHeap(Heap *heap) = 0;
+
+    virtual void DestroyQueryHeap(QueryHeap *queryHeap) = 0;
+
     // Device Queries
 
     virtual bool SupportsRayTracing() const = 0;
 
     virtual bool SupportsMeshShaders() const = 0;
 
+    virtual bool SupportsSplitBarriers() const = 0;
+
+    /// <summary>
+    /// Whether CommandList::BeginRenderPass is available. Without it load and store ops are
+    /// emulated with clears and discards.
+    /// </summary>
+    virtual bool SupportsRenderPasses() const = 0;
+
     virtual uint64_t GetVideoMemoryBudget() const = 0;
 
+    virtual ResourceAllocationInfo GetTextureAllocationInfo(const TextureCreateInfo &desc) const = 0;
+
+    virtual ResourceAllocationInfo GetBufferAllocationInfo(const BufferCreateInfo &desc) const = 0;
+
     virtual BindlessDescriptorManager *GetBindlessManager() const = 0;
 
     // Sync
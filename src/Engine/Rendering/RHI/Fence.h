@@ -5,10 +5,21 @@
 #ifndef GPU_PARTICLE_SIM_FENCE_H
 #define GPU_PARTICLE_SIM_FENCE_H
 
+#include <cstdint>
+
+class CommandQueue;
+
+/// <summary>
+/// Monotonic GPU timeline that any queue can signal and any queue or the CPU can wait on.
+/// Used to order work between queues.
+/// </summary>
 class Fence {
     public:
     virtual ~Fence() = default;
 
+    /// <summary>
+    /// Set the fence to value once all work previously submitted to the queue completes
+    /// </summary>
     virtual void Signal(CommandQueue* queue, uint64_t value) = 0;
 
     virtual void WaitCPU(uint64_t value) = 0;
@@ -18,4 +29,4 @@ class Fence {
     virtual void Reset(uint64_t value = 0) = 0;
 };
 
-#endif //GPU_PARTICLE_SIM_FENCE_H
\ No newline at end of file
+#endif //GPU_PARTICLE_SIM_FENCE_H
@@ -0,0 +1,47 @@
+//
+// Created by 2401Lucas on 2025-11-21.
+//
+
+#ifndef GPU_PARTICLE_SIM_HEAP_H
+#define GPU_PARTICLE_SIM_HEAP_H
+
+#include <cstdint>
+
+/// <summary>
+/// Kind of resources a heap may hold. D3D12 resource heap tier 1 hardware cannot mix
+/// buffers, render target/depth textures and other textures in one heap.
+/// </summary>
+enum class HeapResourceClass {
+    Buffers,
+    Textures,
+    RenderTargets, // Render target and depth stencil textures
+};
+
+struct HeapCreateInfo {
+    uint64_t size;
+    HeapResourceClass resourceClass;
+    const char *debugName = nullptr;
+};
+
+/// <summary>
+/// Size and alignment a resource needs when placed in a heap
+/// </summary>
+struct ResourceAllocationInfo {
+    uint64_t size = 0;
+    uint64_t alignment = 0;
+};
+
+/// <summary>
+/// Device memory that placed resources can be created in.
+/// Resources placed at overlapping offsets alias each other and need an aliasing barrier
+/// before the memory changes owner.
+/// </summary>
+class Heap {
+public:
+    virtual ~Heap() = default;
+
+    uint64_t size = 0;
+    HeapResourceClass resourceClass = HeapResourceClass::Buffers;
+};
+
+#endif //GPU_PARTICLE_SIM_HEAP_H
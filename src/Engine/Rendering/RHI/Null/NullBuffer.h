@@ -0,0 +1,47 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLBUFFER_H
+#define GPU_PARTICLE_SIM_NULLBUFFER_H
+
+#include <memory>
+
+#include "../Buffer.h"
+
+/// <summary>
+/// Buffer in CPU memory. Committed buffers own their bytes, placed buffers point into their heap's,
+/// so aliased buffers really share memory.
+/// </summary>
+class NullBuffer : public Buffer {
+public:
+    std::unique_ptr<uint8_t[]> storage; // Null when placed
+    uint8_t *data = nullptr;
+    uint64_t size = 0;
+    uint32_t stride = 0;
+    BufferUsage usage = BufferUsage::Vertex;
+    MemoryType memoryType = MemoryType::GPU;
+    uint32_t bindlessIndex = 0;
+    bool mapped = false;
+
+    void *Map() override {
+        // Like D3D12, only upload and readback buffers are CPU visible
+        if (memoryType == MemoryType::GPU) {
+            return nullptr;
+        }
+        mapped = true;
+        return data;
+    }
+
+    void *GetMappedPtr() const override { return mapped ? data : nullptr; }
+
+    void Unmap() override { mapped = false; }
+
+    uint64_t GetSize() const override { return size; }
+
+    uint64_t GetGPUAddress() const override { return reinterpret_cast<uint64_t>(data); }
+
+    uint32_t GetBindlessIndex() const override { return bindlessIndex; }
+};
+
+#endif //GPU_PARTICLE_SIM_NULLBUFFER_H
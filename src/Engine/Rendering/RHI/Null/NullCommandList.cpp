@@ -0,0 +1,189 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#include "NullCommandList.h"
+#include "NullBuffer.h"
+#include "NullQueryHeap.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+void NullCommandList::Begin(BindlessDescriptorManager *) {
+    if (m_isRecording) {
+        throw std::runtime_error("NullCommandList: Begin called while recording");
+    }
+
+    m_isRecording = true;
+    m_counts = {};
+}
+
+void NullCommandList::End() {
+    if (!m_isRecording) {
+        throw std::runtime_error("NullCommandList: End called without Begin");
+    }
+    if (m_inRenderPass) {
+        throw std::runtime_error("NullCommandList: End called inside a render pass");
+    }
+
+    m_isRecording = false;
+    m_counters.Add(m_counts);
+}
+
+void NullCommandList::SetPipeline(Pipeline *) {
+    m_counts.pipelines++;
+}
+
+void NullCommandList::SetViewport(const Viewport &) {
+    m_counts.states++;
+}
+
+void NullCommandList::SetScissor(const Rect &) {
+    m_counts.states++;
+}
+
+void NullCommandList::SetPrimitiveTopology(PrimitiveTopology) {
+    m_counts.states++;
+}
+
+void NullCommandList::SetVertexBuffer(Buffer *, uint32_t) {
+    m_counts.bindings++;
+}
+
+void NullCommandList::SetIndexBuffer(Buffer *) {
+    m_counts.bindings++;
+}
+
+void NullCommandList::SetConstantBuffer(Buffer *, uint32_t, uint32_t) {
+    m_counts.bindings++;
+}
+
+void NullCommandList::SetTexture(Texture *, uint32_t) {
+    m_counts.bindings++;
+}
+
+void NullCommandList::Draw(uint32_t, uint32_t) {
+    m_counts.draws++;
+}
+
+void NullCommandList::DrawIndexed(uint32_t, uint32_t) {
+    m_counts.draws++;
+}
+
+void NullCommandList::DrawInstanced(uint32_t, uint32_t) {
+    m_counts.draws++;
+}
+
+void NullCommandList::DrawIndexedInstanced(uint32_t, uint32_t) {
+    m_counts.draws++;
+}
+
+void NullCommandList::Dispatch(uint32_t, uint32_t, uint32_t) {
+    m_counts.dispatches++;
+}
+
+void NullCommandList::ClearRenderTarget(Texture *, const float[4]) {
+    m_counts.clears++;
+}
+
+void NullCommandList::ClearDepthStencil(Texture *, float, uint8_t) {
+    m_counts.clears++;
+}
+
+void NullCommandList::CopyBuffer(Buffer *src, Buffer *dst, uint64_t size) {
+    m_counts.copies++;
+
+    NullBuffer *source = static_cast<NullBuffer *>(src);
+    NullBuffer *destination = static_cast<NullBuffer *>(dst);
+    if (source && destination && source->data != destination->data) {
+        std::memmove(destination->data, source->data, std::min({size, source->size, destination->size}));
+    }
+}
+
+void NullCommandList::CopyTexture(Texture *, Texture *) {
+    m_counts.copies++;
+}
+
+void NullCommandList::CopyBufferToTexture(Buffer *, Texture *) {
+    m_counts.copies++;
+}
+
+void NullCommandList::ResourceBarriers(const ResourceBarrier *, uint32_t count) {
+    m_counts.barriers += count;
+    m_counts.barrierCalls++;
+}
+
+void NullCommandList::TransitionTexture(Texture *, TextureUsage, TextureUsage) {
+    m_counts.barriers++;
+    m_counts.barrierCalls++;
+}
+
+void NullCommandList::TransitionBuffer(Buffer *, BufferUsage, BufferUsage) {
+    m_counts.barriers++;
+    m_counts.barrierCalls++;
+}
+
+void NullCommandList::DiscardTexture(Texture *) {
+    m_counts.discards++;
+}
+
+void NullCommandList::WriteTimestamp(QueryHeap *queryHeap, uint32_t index) {
+    m_counts.queries++;
+
+    NullQueryHeap *heap = static_cast<NullQueryHeap *>(queryHeap);
+    if (heap && index < heap->results.size()) {
+        heap->results[index] = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
+
+void NullCommandList::ResolveQueries(QueryHeap *queryHeap, uint32_t first, uint32_t count,
+                                     Buffer *destination, uint64_t offset) {
+    m_counts.queries++;
+
+    NullQueryHeap *heap = static_cast<NullQueryHeap *>(queryHeap);
+    NullBuffer *buffer = static_cast<NullBuffer *>(destination);
+    if (!heap || !buffer || first >= heap->results.size() || offset >= buffer->size) {
+        return;
+    }
+
+    uint64_t bytes = std::min<uint64_t>(std::min<uint64_t>(count, heap->results.size() - first) * sizeof(uint64_t),
+                                        buffer->size - offset);
+    std::memcpy(buffer->data + offset, heap->results.data() + first, bytes);
+}
+
+void NullCommandList::SetRenderTarget(Texture *, Texture *) {
+    m_counts.renderTargetBinds++;
+}
+
+void NullCommandList::SetRenderTargets(Texture **, uint32_t, Texture *) {
+    m_counts.renderTargetBinds++;
+}
+
+void NullCommandList::BeginRenderPass(const RenderPassBeginInfo &info) {
+    if (m_inRenderPass) {
+        throw std::runtime_error("NullCommandList: render passes cannot nest");
+    }
+
+    m_inRenderPass = true;
+    m_counts.renderTargetBinds++;
+
+    // Load ops are where a render pass clears and discards
+    for (uint32_t i = 0; i < info.colorCount; ++i) {
+        m_counts.clears += info.colorAttachments[i].loadOp == AttachmentLoadOp::Clear;
+        m_counts.discards += info.colorAttachments[i].loadOp == AttachmentLoadOp::DontCare;
+    }
+    if (info.depthStencil) {
+        m_counts.clears += info.depthStencil->loadOp == AttachmentLoadOp::Clear;
+        m_counts.discards += info.depthStencil->loadOp == AttachmentLoadOp::DontCare;
+    }
+}
+
+void NullCommandList::EndRenderPass() {
+    if (!m_inRenderPass) {
+        throw std::runtime_error("NullCommandList: EndRenderPass without BeginRenderPass");
+    }
+
+    m_inRenderPass = false;
+}
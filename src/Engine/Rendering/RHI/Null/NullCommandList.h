@@ -0,0 +1,90 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLCOMMANDLIST_H
+#define GPU_PARTICLE_SIM_NULLCOMMANDLIST_H
+
+#include "Rendering/RHI/CommandList.h"
+#include "NullCommon.h"
+
+/// <summary>
+/// Counts what is recorded. Commands take effect as they are recorded: buffer copies and query
+/// resolves move bytes so readback paths see data, draws, dispatches and clears only count.
+/// </summary>
+class NullCommandList : public CommandList {
+public:
+    explicit NullCommandList(NullCounters &counters) : m_counters(counters) {
+    }
+
+    void Begin(BindlessDescriptorManager *bindlessManager = nullptr) override;
+
+    void End() override;
+
+    void SetPipeline(Pipeline *pipeline) override;
+
+    void SetViewport(const Viewport &viewport) override;
+
+    void SetScissor(const Rect &scissor) override;
+
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+
+    void SetVertexBuffer(Buffer *buffer, uint32_t slot) override;
+
+    void SetIndexBuffer(Buffer *buffer) override;
+
+    void SetConstantBuffer(Buffer *buffer, uint32_t slot, uint32_t offset) override;
+
+    void SetTexture(Texture *texture, uint32_t slot) override;
+
+    void Draw(uint32_t vertexCount, uint32_t startVertex) override;
+
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndex) override;
+
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount) override;
+
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount) override;
+
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+
+    void ClearRenderTarget(Texture *texture, const float color[4]) override;
+
+    void ClearDepthStencil(Texture *texture, float depth, uint8_t stencil) override;
+
+    void CopyBuffer(Buffer *src, Buffer *dst, uint64_t size) override;
+
+    void CopyTexture(Texture *src, Texture *dst) override;
+
+    void CopyBufferToTexture(Buffer *src, Texture *dst) override;
+
+    void ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) override;
+
+    void TransitionTexture(Texture *texture, TextureUsage oldState, TextureUsage newState) override;
+
+    void TransitionBuffer(Buffer *buffer, BufferUsage oldState, BufferUsage newState) override;
+
+    void DiscardTexture(Texture *texture) override;
+
+    void WriteTimestamp(QueryHeap *queryHeap, uint32_t index) override;
+
+    void ResolveQueries(QueryHeap *queryHeap, uint32_t first, uint32_t count,
+                        Buffer *destination, uint64_t offset) override;
+
+    void SetRenderTarget(Texture *renderTarget, Texture *depthStencil = nullptr) override;
+
+    void SetRenderTargets(Texture **renderTargets, uint32_t count, Texture *depthStencil = nullptr) override;
+
+    void BeginRenderPass(const RenderPassBeginInfo &info) override;
+
+    void EndRenderPass() override;
+
+    bool IsRecording() const { return m_isRecording; }
+
+private:
+    NullCounters &m_counters;
+    NullCommandCounts m_counts;
+    bool m_isRecording = false;
+    bool m_inRenderPass = false;
+};
+
+#endif //GPU_PARTICLE_SIM_NULLCOMMANDLIST_H
@@ -0,0 +1,34 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#include "NullCommandQueue.h"
+#include "NullCommandList.h"
+#include <stdexcept>
+
+void NullCommandQueue::Execute(CommandList *commandList) {
+    Execute(&commandList, 1);
+}
+
+void NullCommandQueue::Execute(CommandList *const *commandLists, uint32_t count) {
+    // Submitting a list that is still recording is a bug the GPU backends would only report through the debug layer
+    for (uint32_t i = 0; i < count; ++i) {
+        if (static_cast<NullCommandList *>(commandLists[i])->IsRecording()) {
+            throw std::runtime_error("NullCommandQueue: submitted a command list that was not ended");
+        }
+    }
+
+    m_counters.submissions++;
+}
+
+void NullCommandQueue::Signal(uint64_t fenceValue) {
+    m_completedValue = fenceValue;
+    m_counters.signals++;
+}
+
+void NullCommandQueue::WaitForFence(uint64_t) {
+}
+
+void NullCommandQueue::Wait(Fence *, uint64_t) {
+    m_counters.waits++;
+}
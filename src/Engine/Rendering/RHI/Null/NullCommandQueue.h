@@ -0,0 +1,53 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLCOMMANDQUEUE_H
+#define GPU_PARTICLE_SIM_NULLCOMMANDQUEUE_H
+
+#include <atomic>
+
+#include "Rendering/RHI/CommandQueue.h"
+#include "NullCommon.h"
+
+/// <summary>
+/// Submitted work completes immediately: every signaled value is also the completed one and
+/// fence waits never block
+/// </summary>
+class NullCommandQueue : public CommandQueue {
+public:
+    NullCommandQueue(QueueType type, NullCounters &counters) : m_type(type), m_counters(counters) {
+    }
+
+    void Execute(CommandList *commandList) override;
+
+    void Execute(CommandList *const *commandLists, uint32_t count) override;
+
+    void WaitIdle() override {
+    }
+
+    void Signal(uint64_t fenceValue) override;
+
+    void WaitForFence(uint64_t fenceValue) override;
+
+    void Wait(Fence *fence, uint64_t value) override;
+
+    void BeginFrame(uint32_t) override {}
+
+    QueueType GetType() const override { return m_type; }
+
+    uint64_t GetCompletedFenceValue() const override { return m_completedValue; }
+
+    // Timestamps are steady clock nanoseconds
+    uint64_t GetTimestampFrequency() const override { return 1000000000; }
+
+    void AssignCommandList(CommandList *, uint32_t, uint32_t) override {
+    }
+
+private:
+    QueueType m_type;
+    NullCounters &m_counters;
+    std::atomic<uint64_t> m_completedValue{0};
+};
+
+#endif //GPU_PARTICLE_SIM_NULLCOMMANDQUEUE_H
@@ -0,0 +1,94 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLCOMMON_H
+#define GPU_PARTICLE_SIM_NULLCOMMON_H
+
+#include <atomic>
+#include <cstdint>
+
+/// <summary>
+/// Calls one command list recorded. Kept as plain counts while recording so parallel lists never
+/// share a cache line, and added to the device's NullCounters when the list ends.
+/// </summary>
+struct NullCommandCounts {
+    uint64_t pipelines = 0; // SetPipeline
+    uint64_t states = 0; // Viewport, scissor and topology
+    uint64_t bindings = 0; // Vertex, index and constant buffers, textures
+    uint64_t draws = 0;
+    uint64_t dispatches = 0;
+    uint64_t clears = 0;
+    uint64_t copies = 0;
+    uint64_t barriers = 0; // Every transition, aliasing and UAV barrier
+    uint64_t barrierCalls = 0; // ResourceBarriers, TransitionX and AliasX calls
+    uint64_t discards = 0;
+    uint64_t queries = 0; // Timestamps written and resolves
+    uint64_t renderTargetBinds = 0; // SetRenderTarget(s) and BeginRenderPass
+};
+
+/// <summary>
+/// Everything the null device and the objects it created saw. Shared by every thread recording for it.
+/// </summary>
+struct NullCounters {
+    // Commands, summed over every ended command list
+    std::atomic<uint64_t> pipelines{0};
+    std::atomic<uint64_t> states{0};
+    std::atomic<uint64_t> bindings{0};
+    std::atomic<uint64_t> draws{0};
+    std::atomic<uint64_t> dispatches{0};
+    std::atomic<uint64_t> clears{0};
+    std::atomic<uint64_t> copies{0};
+    std::atomic<uint64_t> barriers{0};
+    std::atomic<uint64_t> barrierCalls{0};
+    std::atomic<uint64_t> discards{0};
+    std::atomic<uint64_t> queries{0};
+    std::atomic<uint64_t> renderTargetBinds{0};
+    std::atomic<uint64_t> commandLists{0}; // Lists ended
+
+    // Queues
+    std::atomic<uint64_t> submissions{0}; // Execute calls
+    std::atomic<uint64_t> signals{0};
+    std::atomic<uint64_t> waits{0}; // Queue waits on fences, always already satisfied
+    std::atomic<uint64_t> presents{0};
+
+    // Objects
+    std::atomic<uint64_t> bufferCreates{0};
+    std::atomic<uint64_t> textureCreates{0};
+    std::atomic<uint64_t> pipelineCreates{0};
+    std::atomic<uint64_t> heapCreates{0};
+    std::atomic<uint64_t> uploads{0};
+    std::atomic<uint64_t> uploadBytes{0};
+    std::atomic<uint64_t> allocatedBytes{0}; // CPU memory currently held by committed resources and heaps
+
+    void Add(const NullCommandCounts &counts) {
+        pipelines += counts.pipelines;
+        states += counts.states;
+        bindings += counts.bindings;
+        draws += counts.draws;
+        dispatches += counts.dispatches;
+        clears += counts.clears;
+        copies += counts.copies;
+        barriers += counts.barriers;
+        barrierCalls += counts.barrierCalls;
+        discards += counts.discards;
+        queries += counts.queries;
+        renderTargetBinds += counts.renderTargetBinds;
+        commandLists++;
+    }
+
+    /// <summary>
+    /// Zero the call counters, allocatedBytes keeps tracking live memory
+    /// </summary>
+    void Reset() {
+        for (std::atomic<uint64_t> *counter: {
+                 &pipelines, &states, &bindings, &draws, &dispatches, &clears, &copies, &barriers, &barrierCalls,
+                 &discards, &queries, &renderTargetBinds, &commandLists, &submissions, &signals, &waits,
+                 &presents, &bufferCreates, &textureCreates, &pipelineCreates, &heapCreates, &uploads, &uploadBytes
+             }) {
+            *counter = 0;
+        }
+    }
+};
+
+#endif //GPU_PARTICLE_SIM_NULLCOMMON_H
@@ -0,0 +1,206 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#include "NullDevice.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+NullDevice::NullDevice(const DeviceCreateInfo &) {
+}
+
+CommandQueue *NullDevice::CreateCommandQueue(const CommandQueueCreateInfo &createInfo) {
+    return new NullCommandQueue(createInfo.type, m_counters);
+}
+
+CommandList *NullDevice::CreateCommandList(QueueType) {
+    return new NullCommandList(m_counters);
+}
+
+Swapchain *NullDevice::CreateSwapchain(void *, CommandQueue *, uint32_t width, uint32_t height) {
+    return new NullSwapchain(m_counters, width, height);
+}
+
+Buffer *NullDevice::CreateBuffer(const BufferCreateInfo &desc) {
+    NullBuffer *buffer = InitBuffer(desc);
+    buffer->storage = std::make_unique_for_overwrite<uint8_t[]>(buffer->size);
+    buffer->data = buffer->storage.get();
+    m_counters.allocatedBytes += buffer->size;
+    return buffer;
+}
+
+Texture *NullDevice::CreateTexture(const TextureCreateInfo &desc) {
+    NullTexture *texture = InitTexture(desc);
+    texture->storage = std::make_unique_for_overwrite<uint8_t[]>(texture->size);
+    texture->data = texture->storage.get();
+    m_counters.allocatedBytes += texture->size;
+    return texture;
+}
+
+Pipeline *NullDevice::CreatePipeline(const PipelineCreateInfo &desc) {
+    m_counters.pipelineCreates++;
+
+    NullPipeline *pipeline = new NullPipeline();
+    pipeline->isCompute = !desc.computeShader.filepath.empty();
+    pipeline->topology = desc.topology;
+    pipeline->renderTargetCount = desc.renderTargetCount;
+    return pipeline;
+}
+
+Heap *NullDevice::CreateHeap(const HeapCreateInfo &desc) {
+    m_counters.heapCreates++;
+
+    NullHeap *heap = new NullHeap();
+    heap->size = desc.size;
+    heap->resourceClass = desc.resourceClass;
+    heap->memory = std::make_unique_for_overwrite<uint8_t[]>(desc.size);
+    m_counters.allocatedBytes += desc.size;
+    return heap;
+}
+
+Fence *NullDevice::CreateFence(uint64_t initialValue) {
+    return new NullFence(initialValue);
+}
+
+QueryHeap *NullDevice::CreateQueryHeap(const QueryHeapCreateInfo &desc) {
+    NullQueryHeap *queryHeap = new NullQueryHeap();
+    queryHeap->type = desc.type;
+    queryHeap->count = desc.count;
+    queryHeap->results.assign(desc.count, 0);
+    return queryHeap;
+}
+
+Texture *NullDevice::CreatePlacedTexture(const TextureCreateInfo &desc, Heap *heap, uint64_t offset) {
+    NullTexture *texture = InitTexture(desc);
+    texture->data = PlaceIn(heap, offset, texture->size);
+    return texture;
+}
+
+Buffer *NullDevice::CreatePlacedBuffer(const BufferCreateInfo &desc, Heap *heap, uint64_t offset) {
+    NullBuffer *buffer = InitBuffer(desc);
+    buffer->data = PlaceIn(heap, offset, buffer->size);
+    return buffer;
+}
+
+void NullDevice::UploadBufferData(Buffer *buffer, const void *data, size_t size) {
+    if (!buffer || !data || size == 0) return;
+
+    NullBuffer *nullBuffer = static_cast<NullBuffer *>(buffer);
+    size = std::min<size_t>(size, nullBuffer->size);
+    std::memcpy(nullBuffer->data, data, size);
+
+    m_counters.uploads++;
+    m_counters.uploadBytes += size;
+}
+
+void NullDevice::UploadTextureData(Texture *texture, const void *data, size_t size) {
+    if (!texture || !data || size == 0) return;
+
+    NullTexture *nullTexture = static_cast<NullTexture *>(texture);
+    size = std::min<size_t>(size, nullTexture->size);
+    std::memcpy(nullTexture->data, data, size);
+
+    m_counters.uploads++;
+    m_counters.uploadBytes += size;
+}
+
+void NullDevice::DestroyBuffer(Buffer *buffer) {
+    NullBuffer *nullBuffer = static_cast<NullBuffer *>(buffer);
+    if (nullBuffer && nullBuffer->storage) {
+        m_counters.allocatedBytes -= nullBuffer->size;
+    }
+    delete nullBuffer;
+}
+
+void NullDevice::DestroyTexture(Texture *texture) {
+    NullTexture *nullTexture = static_cast<NullTexture *>(texture);
+    if (nullTexture && nullTexture->storage) {
+        m_counters.allocatedBytes -= nullTexture->size;
+    }
+    delete nullTexture;
+}
+
+void NullDevice::DestroyPipeline(Pipeline *pipeline) {
+    delete pipeline;
+}
+
+void NullDevice::DestroyHeap(Heap *heap) {
+    if (heap) {
+        m_counters.allocatedBytes -= heap->size;
+    }
+    delete heap;
+}
+
+void NullDevice::DestroyQueryHeap(QueryHeap *queryHeap) {
+    delete queryHeap;
+}
+
+ResourceAllocationInfo NullDevice::GetTextureAllocationInfo(const TextureCreateInfo &desc) const {
+    uint64_t size = 0;
+    uint32_t width = desc.width;
+    uint32_t height = desc.height;
+    for (uint32_t mip = 0; mip < desc.mipLevels; ++mip) {
+        size += static_cast<uint64_t>(width) * height * desc.depth * BytesPerPixel(desc.format);
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+    return {AlignUp(size * desc.arraySize, Alignment), Alignment};
+}
+
+ResourceAllocationInfo NullDevice::GetBufferAllocationInfo(const BufferCreateInfo &desc) const {
+    return {AlignUp(desc.size, Alignment), Alignment};
+}
+
+uint32_t NullDevice::BytesPerPixel(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::RGBA32_FLOAT:
+            return 16;
+        case TextureFormat::RGB32_FLOAT:
+            return 12;
+        case TextureFormat::RG32_FLOAT:
+        case TextureFormat::RGBA16_FLOAT:
+            return 8;
+        case TextureFormat::R16_FLOAT:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+NullTexture *NullDevice::InitTexture(const TextureCreateInfo &desc) {
+    m_counters.textureCreates++;
+
+    NullTexture *texture = new NullTexture();
+    texture->width = desc.width;
+    texture->height = desc.height;
+    texture->mipLevels = desc.mipLevels;
+    texture->arraySize = desc.arraySize;
+    texture->format = desc.format;
+    texture->usage = desc.usage;
+    texture->size = GetTextureAllocationInfo(desc).size;
+    texture->bindlessIndex = m_nextBindlessIndex++;
+    return texture;
+}
+
+NullBuffer *NullDevice::InitBuffer(const BufferCreateInfo &desc) {
+    m_counters.bufferCreates++;
+
+    NullBuffer *buffer = new NullBuffer();
+    buffer->size = desc.size;
+    buffer->stride = desc.stride;
+    buffer->usage = desc.usage;
+    buffer->memoryType = desc.memoryType;
+    buffer->bindlessIndex = m_nextBindlessIndex++;
+    return buffer;
+}
+
+uint8_t *NullDevice::PlaceIn(Heap *heap, uint64_t offset, uint64_t size) {
+    NullHeap *nullHeap = static_cast<NullHeap *>(heap);
+    if (!nullHeap || offset % Alignment != 0 || offset + size > nullHeap->size) {
+        throw std::runtime_error("NullDevice: placed resource of " + std::to_string(size) + " bytes at offset " +
+                                 std::to_string(offset) + " does not fit its heap");
+    }
+    return nullHeap->memory.get() + offset;
+}
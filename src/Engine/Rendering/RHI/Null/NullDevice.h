@@ -0,0 +1,124 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLDEVICE_H
+#define GPU_PARTICLE_SIM_NULLDEVICE_H
+
+#include <atomic>
+
+#include "../Device.h"
+#include "NullCommon.h"
+#include "NullBuffer.h"
+#include "NullTexture.h"
+#include "NullHeap.h"
+#include "NullQueryHeap.h"
+#include "NullPipeline.h"
+#include "NullFence.h"
+#include "NullCommandList.h"
+#include "NullCommandQueue.h"
+#include "NullSwapchain.h"
+
+/// <summary>
+/// Headless backend, selected with RHI_NULL. Resources live in CPU memory, queues complete work the
+/// moment it is submitted and every call is counted in GetCounters(), so everything above the RHI runs
+/// without a GPU and timings measure the engine rather than a driver.
+/// </summary>
+class NullDevice : public Device {
+public:
+    explicit NullDevice(const DeviceCreateInfo &info = {});
+
+    ~NullDevice() override = default;
+
+    NullDevice(const NullDevice &) = delete;
+
+    NullDevice &operator=(const NullDevice &) = delete;
+
+    CommandQueue *CreateCommandQueue(const CommandQueueCreateInfo &createInfo) override;
+
+    CommandList *CreateCommandList(QueueType queueType) override;
+
+    Swapchain *CreateSwapchain(void *windowHandle, CommandQueue *queue, uint32_t width, uint32_t height) override;
+
+    Buffer *CreateBuffer(const BufferCreateInfo &desc) override;
+
+    Texture *CreateTexture(const TextureCreateInfo &desc) override;
+
+    Pipeline *CreatePipeline(const PipelineCreateInfo &desc) override;
+
+    Heap *CreateHeap(const HeapCreateInfo &desc) override;
+
+    Fence *CreateFence(uint64_t initialValue) override;
+
+    QueryHeap *CreateQueryHeap(const QueryHeapCreateInfo &desc) override;
+
+    Texture *CreatePlacedTexture(const TextureCreateInfo &desc, Heap *heap, uint64_t offset) override;
+
+    Buffer *CreatePlacedBuffer(const BufferCreateInfo &desc, Heap *heap, uint64_t offset) override;
+
+    void UploadBufferData(Buffer *buffer, const void *data, size_t size) override;
+
+    void UploadTextureData(Texture *texture, const void *data, size_t size) override;
+
+    void FlushUploads() override {
+    }
+
+    void DestroyBuffer(Buffer *buffer) override;
+
+    void DestroyTexture(Texture *texture) override;
+
+    void DestroyPipeline(Pipeline *pipeline) override;
+
+    void DestroyHeap(Heap *heap) override;
+
+    void DestroyQueryHeap(QueryHeap *queryHeap) override;
+
+    bool SupportsRayTracing() const override { return false; }
+
+    bool SupportsMeshShaders() const override { return false; }
+
+    bool SupportsSplitBarriers() const override { return true; }
+
+    bool SupportsRenderPasses() const override { return true; }
+
+    uint64_t GetVideoMemoryBudget() const override { return m_videoMemoryBudget; }
+
+    ResourceAllocationInfo GetTextureAllocationInfo(const TextureCreateInfo &desc) const override;
+
+    ResourceAllocationInfo GetBufferAllocationInfo(const BufferCreateInfo &desc) const override;
+
+    BindlessDescriptorManager *GetBindlessManager() const override { return nullptr; }
+
+    void WaitIdle() override {
+    }
+
+    // Null-specific access
+    NullCounters &GetCounters() { return m_counters; }
+
+    /// <summary>
+    /// Budget reported to the memory budget of the render graph, 8 GB by default
+    /// </summary>
+    void SetVideoMemoryBudget(uint64_t bytes) { m_videoMemoryBudget = bytes; }
+
+private:
+    // Same placement alignment as D3D12, so aliasing numbers match a GPU closely enough to compare
+    static constexpr uint64_t Alignment = 64 * 1024;
+
+    NullCounters m_counters;
+    std::atomic<uint64_t> m_videoMemoryBudget{8ull << 30};
+    std::atomic<uint32_t> m_nextBindlessIndex{1}; // 0 is what unbound slots read
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    static uint32_t BytesPerPixel(TextureFormat format);
+
+    NullTexture *InitTexture(const TextureCreateInfo &desc);
+
+    NullBuffer *InitBuffer(const BufferCreateInfo &desc);
+
+    static uint8_t *PlaceIn(Heap *heap, uint64_t offset, uint64_t size);
+};
+
+#endif //GPU_PARTICLE_SIM_NULLDEVICE_H
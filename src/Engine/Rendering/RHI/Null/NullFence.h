@@ -0,0 +1,34 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLFENCE_H
+#define GPU_PARTICLE_SIM_NULLFENCE_H
+
+#include <atomic>
+
+#include "../Fence.h"
+
+/// <summary>
+/// Work completes the moment it is submitted, so a signaled value is also the completed one
+/// and waits never block
+/// </summary>
+class NullFence : public Fence {
+public:
+    explicit NullFence(uint64_t initialValue = 0) : m_value(initialValue) {
+    }
+
+    void Signal(CommandQueue *, uint64_t value) override { m_value = value; }
+
+    void WaitCPU(uint64_t) override {
+    }
+
+    uint64_t GetCompletedValue() const override { return m_value; }
+
+    void Reset(uint64_t value = 0) override { m_value = value; }
+
+private:
+    std::atomic<uint64_t> m_value;
+};
+
+#endif //GPU_PARTICLE_SIM_NULLFENCE_H
@@ -0,0 +1,17 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLHEAP_H
+#define GPU_PARTICLE_SIM_NULLHEAP_H
+
+#include <memory>
+
+#include "../Heap.h"
+
+class NullHeap : public Heap {
+public:
+    std::unique_ptr<uint8_t[]> memory;
+};
+
+#endif //GPU_PARTICLE_SIM_NULLHEAP_H
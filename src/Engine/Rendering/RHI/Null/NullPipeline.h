@@ -0,0 +1,20 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLPIPELINE_H
+#define GPU_PARTICLE_SIM_NULLPIPELINE_H
+
+#include "Rendering/RHI/Pipeline.h"
+
+/// <summary>
+/// Keeps the description only, shaders are never compiled
+/// </summary>
+class NullPipeline : public Pipeline {
+public:
+    bool isCompute = false;
+    PrimitiveTopology topology = PrimitiveTopology::TriangleList;
+    uint32_t renderTargetCount = 0;
+};
+
+#endif //GPU_PARTICLE_SIM_NULLPIPELINE_H
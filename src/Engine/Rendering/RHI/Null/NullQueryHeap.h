@@ -0,0 +1,20 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLQUERYHEAP_H
+#define GPU_PARTICLE_SIM_NULLQUERYHEAP_H
+
+#include <vector>
+
+#include "../QueryHeap.h"
+
+/// <summary>
+/// Timestamps are written when the command is recorded, in steady clock nanoseconds
+/// </summary>
+class NullQueryHeap : public QueryHeap {
+public:
+    std::vector<uint64_t> results;
+};
+
+#endif //GPU_PARTICLE_SIM_NULLQUERYHEAP_H
@@ -0,0 +1,34 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#include "NullSwapchain.h"
+
+NullSwapchain::NullSwapchain(NullCounters &counters, uint32_t width, uint32_t height)
+    : m_counters(counters) {
+    Resize(width, height);
+}
+
+SwapchainPresentResult NullSwapchain::Present(bool) {
+    m_counters.presents++;
+    m_frameIndex = (m_frameIndex + 1) % FrameCount;
+    return SwapchainPresentResult::Success;
+}
+
+void NullSwapchain::Resize(uint32_t width, uint32_t height) {
+    for (auto &backBuffer: m_backBuffers) {
+        backBuffer = std::make_unique<NullTexture>();
+        backBuffer->width = width;
+        backBuffer->height = height;
+        backBuffer->format = GetColorFormat();
+        backBuffer->usage = TextureUsage::Present;
+        backBuffer->size = static_cast<uint64_t>(width) * height * 4;
+        backBuffer->storage = std::make_unique_for_overwrite<uint8_t[]>(backBuffer->size);
+        backBuffer->data = backBuffer->storage.get();
+    }
+    m_frameIndex = 0;
+}
+
+Texture *NullSwapchain::GetSwapchainBuffer(uint32_t frameIndex) const {
+    return frameIndex < FrameCount ? m_backBuffers[frameIndex].get() : nullptr;
+}
@@ -0,0 +1,39 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLSWAPCHAIN_H
+#define GPU_PARTICLE_SIM_NULLSWAPCHAIN_H
+
+#include <memory>
+
+#include "Rendering/RHI/Swapchain.h"
+#include "NullCommon.h"
+#include "NullTexture.h"
+
+/// <summary>
+/// FrameCount CPU back buffers. Present only advances the current buffer.
+/// </summary>
+class NullSwapchain : public Swapchain {
+public:
+    NullSwapchain(NullCounters &counters, uint32_t width, uint32_t height);
+
+    SwapchainPresentResult Present(bool vsync) override;
+
+    void Resize(uint32_t width, uint32_t height) override;
+
+    const TextureFormat GetColorFormat() const override { return TextureFormat::RGBA8_UNORM; }
+
+    const uint32_t GetImageCount() const override { return FrameCount; }
+
+    Texture *GetSwapchainBuffer(uint32_t frameIndex) const override;
+
+    uint32_t GetCurrentIndex() const { return m_frameIndex; }
+
+private:
+    NullCounters &m_counters;
+    std::unique_ptr<NullTexture> m_backBuffers[FrameCount];
+    uint32_t m_frameIndex = 0;
+};
+
+#endif //GPU_PARTICLE_SIM_NULLSWAPCHAIN_H
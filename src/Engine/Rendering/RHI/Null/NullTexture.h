@@ -0,0 +1,25 @@
+//
+// Created by 2401Lucas on 2025-12-12.
+//
+
+#ifndef GPU_PARTICLE_SIM_NULLTEXTURE_H
+#define GPU_PARTICLE_SIM_NULLTEXTURE_H
+
+#include <memory>
+
+#include "Rendering/RHI/Texture.h"
+
+/// <summary>
+/// Texture in CPU memory, size bytes of tightly packed mips and slices. Placed textures point into
+/// their heap's memory like placed buffers.
+/// </summary>
+class NullTexture : public Texture {
+public:
+    std::unique_ptr<uint8_t[]> storage; // Null when placed
+    uint8_t *data = nullptr;
+    uint32_t bindlessIndex = 0;
+
+    uint32_t GetBindlessIndex() const override { return bindlessIndex; }
+};
+
+#endif //GPU_PARTICLE_SIM_NULLTEXTURE_H
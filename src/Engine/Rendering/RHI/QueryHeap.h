@@ -0,0 +1,32 @@
+//
+// Created by 2401Lucas on 2025-12-03.
+//
+
+#ifndef GPU_PARTICLE_SIM_QUERYHEAP_H
+#define GPU_PARTICLE_SIM_QUERYHEAP_H
+
+#include <cstdint>
+
+enum class QueryType {
+    Timestamp, // Graphics and compute queues only
+};
+
+struct QueryHeapCreateInfo {
+    QueryType type = QueryType::Timestamp;
+    uint32_t count = 0;
+    const char *debugName = nullptr;
+};
+
+/// <summary>
+/// Slots the GPU writes query results into. Results are copied to a readback buffer with
+/// CommandList::ResolveQueries and can be read once the submitting frame's fence has passed.
+/// </summary>
+class QueryHeap {
+public:
+    virtual ~QueryHeap() = default;
+
+    QueryType type = QueryType::Timestamp;
+    uint32_t count = 0;
+};
+
+#endif //GPU_PARTICLE_SIM_QUERYHEAP_H
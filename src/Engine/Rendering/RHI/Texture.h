@@ -15,6 +15,7 @@ enum class TextureUsage {
     Present,
     CopySource,
     CopyDest,
+    NonPixelShaderResource, // Read by non-pixel shaders, the read state compute lists can use
 };
 
 enum class TextureFormat {
@@ -52,6 +53,7 @@ public:
     uint32_t width = 0;
     uint32_t height = 0;
     uint32_t mipLevels = 1;
+    uint32_t arraySize = 1;
     TextureFormat format = TextureFormat::Undefined;
     TextureUsage usage;
     uint64_t size = 0;
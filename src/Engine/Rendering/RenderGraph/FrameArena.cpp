@@ -0,0 +1,57 @@
+//
+// Created by 2401Lucas on 2025-12-05.
+//
+
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t blockSize) : m_blockSize(blockSize) {
+}
+
+void FrameArena::Reset() {
+    // A frame that spilled into several blocks gets one block large enough for all of it, so the
+    // next frame of the same shape allocates nothing
+    if (m_blocks.size() > 1) {
+        size_t total = GetBytesReserved();
+        m_blocks.clear();
+        m_blocks.push_back({std::make_unique<std::byte[]>(total), total});
+    }
+
+    m_currentBlock = 0;
+    m_offset = 0;
+    m_bytesUsed = 0;
+}
+
+size_t FrameArena::GetBytesReserved() const {
+    size_t total = 0;
+    for (const Block &block: m_blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+void *FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    while (m_currentBlock < m_blocks.size()) {
+        Block &block = m_blocks[m_currentBlock];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+        uintptr_t aligned = (base + m_offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        size_t offset = aligned - base;
+
+        if (offset + bytes <= block.size) {
+            m_offset = offset + bytes;
+            m_bytesUsed += bytes;
+            return block.memory.get() + offset;
+        }
+
+        m_currentBlock++;
+        m_offset = 0;
+    }
+
+    // Out of blocks, big requests get a block of their own size
+    size_t size = std::max(m_blockSize, bytes + alignment);
+    m_blocks.push_back({std::make_unique<std::byte[]>(size), size});
+    m_currentBlock = static_cast<uint32_t>(m_blocks.size() - 1);
+    m_offset = 0;
+    return do_allocate(bytes, alignment);
+}
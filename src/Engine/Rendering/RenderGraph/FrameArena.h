@@ -0,0 +1,71 @@
+//
+// Created by 2401Lucas on 2025-12-05.
+//
+
+#ifndef GPU_PARTICLE_SIM_FRAMEARENA_H
+#define GPU_PARTICLE_SIM_FRAMEARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+/// <summary>
+/// Linear allocator for data that only lives for one frame of graph declaration: passes, their
+/// resource declarations and names. Allocation bumps an offset, deallocation does nothing and
+/// Reset() rewinds everything at once. Blocks are kept across resets and merged into one block of
+/// the frame's high-water mark, so a steady-state frame never touches the global heap.
+///
+/// Not thread safe, each arena is only used by the thread declaring the graph.
+/// </summary>
+class FrameArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+    explicit FrameArena(size_t blockSize = DefaultBlockSize);
+
+    FrameArena(const FrameArena &) = delete;
+
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    /// <summary>
+    /// Construct an object in the arena. Its destructor is never called by the arena.
+    /// </summary>
+    template<typename T, typename... Args>
+    T *New(Args &&... args) {
+        return new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /// <summary>
+    /// Invalidate every allocation. Objects with destructors must be destroyed first.
+    /// </summary>
+    void Reset();
+
+    size_t GetBytesUsed() const { return m_bytesUsed; }
+    size_t GetBytesReserved() const;
+    uint32_t GetBlockCount() const { return static_cast<uint32_t>(m_blocks.size()); }
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    // Memory is reclaimed by Reset
+    void do_deallocate(void *, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size = 0;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_blockSize;
+    uint32_t m_currentBlock = 0;
+    size_t m_offset = 0; // Into the current block
+    size_t m_bytesUsed = 0;
+};
+
+#endif //GPU_PARTICLE_SIM_FRAMEARENA_H
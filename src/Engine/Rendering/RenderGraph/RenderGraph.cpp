@@ -4,675 +4,3334 @@
 
 #include "RenderGraph.h"
 #include "RenderPass.h"
+#include "RenderGraphCapture.h"
+#include "Core/ThreadPool.h"
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
-#include <unordered_set>
-#include <queue>
+#include <cstdio>
 #include <chrono>
+#include <map>
+#include <queue>
+
+namespace {
+    // FNV-1a, used to fingerprint the declared pass structure
+    constexpr uint64_t HashOffsetBasis = 14695981039346656037ull;
+    constexpr uint64_t HashPrime = 1099511628211ull;
+
+    void HashBytes(uint64_t &hash, const void *data, size_t size) {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= HashPrime;
+        }
+    }
+
+    template<typename T>
+    void HashValue(uint64_t &hash, const T &value) {
+        HashBytes(hash, &value, sizeof(T));
+    }
+
+    void HashString(uint64_t &hash, std::string_view value) {
+        HashValue(hash, value.size());
+        HashBytes(hash, value.data(), value.size());
+    }
+
+    HeapResourceClass GetHeapResourceClass(const RenderPassResource &desc) {
+        if (desc.type == RenderPassResource::Type::Buffer) {
+            return HeapResourceClass::Buffers;
+        }
+
+        TextureUsage usage = (TextureUsage) desc.stateFlag;
+        return usage == TextureUsage::RenderTarget || usage == TextureUsage::DepthStencil
+                   ? HeapResourceClass::RenderTargets
+                   : HeapResourceClass::Textures;
+    }
+
+    uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return alignment ? (value + alignment - 1) / alignment * alignment : value;
+    }
+
+    // Everything but the debug name, like TransientResourcePool::Key
+    bool SameCreateInfo(const TextureCreateInfo &a, const TextureCreateInfo &b) {
+        return a.width == b.width && a.height == b.height && a.depth == b.depth && a.mipLevels == b.mipLevels &&
+               a.arraySize == b.arraySize && a.format == b.format && a.usage == b.usage;
+    }
+
+    bool SameCreateInfo(const BufferCreateInfo &a, const BufferCreateInfo &b) {
+        return a.size == b.size && a.stride == b.stride && a.usage == b.usage && a.memoryType == b.memoryType;
+    }
+}
 
 RenderGraph::RenderGraph(Device *device, CommandQueue *commandQueue, uint32_t frameCount)
-    : m_device(device), m_commandQueue(commandQueue), m_frameCount(frameCount) {
+    : m_device(device), m_commandQueue(commandQueue), m_frameCount(frameCount), m_pool(device) {
     if (!m_commandQueue) {
         throw std::runtime_error("RenderGraph: CommandQueue cannot be null");
     }
 
-    QueueType queueType = m_commandQueue->GetType();
+    // The frame always ends on the graphics queue (present transition, frame fence)
+    if (m_commandQueue->GetType() != QueueType::Graphics) {
+        throw std::runtime_error("RenderGraph: CommandQueue must be a graphics queue");
+    }
 
-    m_commandLists.resize(frameCount);
-    for (uint32_t i = 0; i < frameCount; ++i) {
-        // Create command list for this queue type
-        m_commandLists[i] = std::unique_ptr<CommandList>(m_device->CreateCommandList(queueType));
+    SetQueue(QueueType::Graphics, m_commandQueue);
 
-        // Assign the allocator from the queue to this command list
-        m_commandQueue->AssignCommandList(m_commandLists[i].get(), i);
-    }
+    // A device capability, read once rather than per recorded group
+    m_deviceRenderPasses = m_device->SupportsRenderPasses();
 
     // Initialize per-frame resource tracking
     m_frameResources.resize(frameCount);
     for (uint32_t i = 0; i < frameCount; ++i) {
         m_frameResources[i].frameIndex = i;
     }
+    m_timestampFrames.resize(frameCount);
+
+    for (uint32_t i = 0; i < frameCount; ++i) {
+        m_frameArenas.push_back(std::make_unique<FrameArena>());
+    }
 }
 
 RenderGraph::~RenderGraph() {
+    // A failed compile has nobody left to report to
+    if (m_pendingCompile.valid()) {
+        m_pendingCompile.wait();
+        m_pendingCompile = {};
+    }
+
     Flush(); // Ensure GPU is done with all resources
     Clear();
 }
 
-void RenderGraph::AddPass(std::unique_ptr<RenderPass> pass) {
+void RenderGraph::AddPass(RenderPassPtr pass) {
     if (!pass) {
         throw std::runtime_error("Cannot add null pass to RenderGraph");
     }
 
+    WaitForCompile();
     m_passes.push_back(std::move(pass));
 }
 
 void RenderGraph::Clear() {
+    // The compiled plan is kept so it can be reused if the same structure is declared again.
+    // Passes may come from another slot's arena, they are destroyed before any arena is reset.
+    WaitForCompile();
     m_passes.clear();
-    m_compiledPasses.clear();
-    m_dependencies.clear();
+    GetFrameArena().Reset();
 }
 
-CommandList *RenderGraph::Execute() {
+void RenderGraph::Execute(uint64_t fenceValue) {
     auto startTime = std::chrono::high_resolution_clock::now();
 
-    CommandList *commandList = m_commandLists[m_currentFrameIndex].get();
-    commandList->Begin(m_device->GetBindlessManager());
-
     m_statistics.barrierCount = 0;
-
-    BuildDependencyGraph();
-
-    TopologicalSort();
+    m_statistics.barrierBatchCount = 0;
+    m_statistics.splitBarrierCount = 0;
+    m_statistics.fullBarrierCount = 0;
+    m_statistics.subresourceBarrierCount = 0;
+    m_statistics.uavBarrierCount = 0;
+    m_statistics.skippedUavBarrierCount = 0;
+    m_statistics.aliasingBarrierCount = 0;
+    m_statistics.commandListCount = 0;
+    m_statistics.crossQueueWaitCount = 0;
+    m_statistics.compileWaitTime = 0.0f;
+
+    Compile();
 
     AllocateResources();
 
-    CalculateResourceLifetimes();
+    ResolveResources();
 
-    if (m_resourceAliasing) {
-        AliasResources();
+    // External states are taken before the barriers of this frame move them
+    if (m_captureRequested) {
+        BeginCapture();
     }
 
+    // Every barrier is resolved up front, in plan order, so recording only reads prepared state
+    ResolveBarriers();
+
+    StoreHistoryStates();
+
     auto compileTime = std::chrono::high_resolution_clock::now();
     m_statistics.compileTime = std::chrono::duration<float, std::milli>(
         compileTime - startTime).count();
 
-    for (size_t i = 0; i < m_compiledPasses.size(); i++) {
-        const auto &compiledPass = m_compiledPasses[i];
-
-        if (!compiledPass.pass->IsEnabled()) {
-            continue;
+    // The GPU finished this slot's previous frame, its timestamps can be read before they are reused
+    m_timestamps = m_passTimings || m_renderScaleController;
+    if (m_passTimings && m_passTimingGeneration != m_plan.generation) {
+        RebuildPassTimings();
+    }
+    if (m_timestamps) {
+        if (ReadBackTimestamps() && m_renderScaleController) {
+            m_renderScale = std::min(m_renderScaleController->Update(m_statistics.gpuFrameTime), m_maxRenderScale);
+        }
+        PrepareTimestamps();
+    }
+    m_statistics.renderScale = m_renderScale;
+
+    // Each group gets its own command list, and so its own allocator
+    std::array<uint32_t, QueueCount> listCounts{};
+    m_groupCommandLists.resize(m_plan.groups.size());
+    for (uint32_t i = 0; i < m_plan.groups.size(); ++i) {
+        QueueType queue = m_plan.batches[m_plan.groups[i].batch].queue;
+        m_groupCommandLists[i] = AcquireCommandList(queue, listCounts[(uint32_t) queue]++);
+    }
+    if (m_deferredRecording) {
+        while (m_groupStreams.size() < m_plan.groups.size()) {
+            m_groupStreams.push_back(std::make_unique<DeferredCommandList>());
         }
+    }
 
-        if (m_autoBarriers) {
-            InsertBarriers(static_cast<uint32_t>(i));
+    const uint32_t groupCount = static_cast<uint32_t>(m_plan.groups.size());
+    // A capture appends to one stream, so its frame records serially
+    if (m_threadPool && groupCount > 1 && !m_captureRecorder) {
+        m_threadPool->Dispatch(groupCount, [this](uint32_t groupIndex) {
+            RecordPassGroup(groupIndex);
+        });
+    } else {
+        for (uint32_t i = 0; i < groupCount; ++i) {
+            RecordPassGroup(i);
         }
+    }
+
+    auto recordTime = std::chrono::high_resolution_clock::now();
+    m_statistics.recordTime = std::chrono::duration<float, std::milli>(recordTime - compileTime).count();
+    m_statistics.recordGroupCount = groupCount;
 
-        ExecutePass(compiledPass);
+    if (m_captureRecorder) {
+        m_capture = m_captureRecorder->Finish();
+        m_captureRecorder.reset();
     }
 
-    if (!m_presentTarget.empty()) {
-        auto it = m_externalResources.find(m_presentTarget);
-        if (it != m_externalResources.end() && it->second.type == ExternalResource::Type::Texture) {
-            TransitionExternalResource(m_presentTarget, (uint32_t) TextureUsage::Present);
-        }
+    if (m_deferredRecording) {
+        TranslatePassGroups();
+    } else {
+        m_statistics.translateTime = 0.0f;
+        m_statistics.commandStreamBytes = 0;
+        m_statistics.commandStreamCommands = 0;
+        m_statistics.filteredStateCount = 0;
     }
 
-    commandList->End();
+    if (m_passTimings) {
+        UpdatePassTimings();
+    }
+
+    // Batches are submitted in plan order: uses of a resource on different queues are always
+    // separated by a fence wait on an earlier batch
+    m_batchSignalValues.assign(m_plan.batches.size(), 0);
+    for (uint32_t batchIndex = 0; batchIndex < m_plan.batches.size(); ++batchIndex) {
+        SubmitBatch(batchIndex);
+    }
+
+    // The caller's frame fence is signaled on graphics, make it cover the other queues too
+    for (uint32_t wait: m_plan.joinWaits) {
+        const QueueContext &producer = m_queues[(uint32_t) m_plan.batches[wait].queue];
+        m_commandQueue->Wait(producer.fence.get(), m_batchSignalValues[wait]);
+        m_statistics.crossQueueWaitCount++;
+    }
 
     auto executeTime = std::chrono::high_resolution_clock::now();
     m_statistics.executeTime = std::chrono::duration<float, std::milli>(
         executeTime - compileTime).count();
 
+    m_lastFenceValue = fenceValue;
+
     UpdateStatistics();
+    if (m_memoryReporting) {
+        BuildMemoryReport(fenceValue);
+    }
 #if defined(DEBUG_RENDERGRAPH)
     //LogRenderGraph();
 #endif
 
-    return commandList;
+    ReleasePooledResources(fenceValue);
 }
 
 void RenderGraph::NextFrame() {
+    WaitForCompile();
+
     m_currentFrameIndex = (m_currentFrameIndex + 1) % m_frameCount;
+    m_frameNumber++;
 
-    auto &currentFrame = m_frameResources[m_currentFrameIndex];
-    for (auto &[name, resource]: currentFrame.resources) {
-        resource.canBeDestroyed = true;
+    // Other queues' work for this slot finished before the graphics frame fence the caller waited on
+    for (uint32_t i = 0; i < QueueCount; ++i) {
+        CommandQueue *queue = m_queues[i].queue;
+        if (queue && queue != m_commandQueue) {
+            queue->BeginFrame(m_currentFrameIndex);
+        }
     }
 
-    CleanupOldResources();
+    // Evicts pooled resources no pass has asked for in a while (e.g. after a resize)
+    m_pool.NextFrame(m_commandQueue->GetCompletedFenceValue());
 }
 
 void RenderGraph::Flush() {
+    WaitForCompile();
+
     for (auto &frameRes: m_frameResources) {
-        for (auto &[name, resource]: frameRes.resources) {
-            if (resource.texture) {
-                m_device->DestroyTexture(resource.texture);
-                resource.texture = nullptr;
-            }
-            if (resource.buffer) {
-                m_device->DestroyBuffer(resource.buffer);
-                resource.buffer = nullptr;
-            }
+        for (auto &resource: frameRes.resources) {
+            DestroyTransient(resource);
         }
         frameRes.resources.clear();
-    }
-}
-
-void RenderGraph::BuildDependencyGraph() {
-    m_dependencies.clear();
-
-    // Build map of resource producers
-    std::unordered_map<std::string, RenderPass *> producers;
 
-    for (auto &pass: m_passes) {
-        for (const auto &output: pass->GetOutputs()) {
-            producers[output.name] = pass.get();
-        }
-    }
-
-    // Find dependencies
-    for (auto &pass: m_passes) {
-        for (const auto &input: pass->GetInputs()) {
-            auto it = producers.find(input.name);
-            if (it != producers.end()) {
-                // Found a dependency
-                PassDependency dep;
-                dep.producer = it->second;
-                dep.consumer = pass.get();
-                dep.resourceName = input.name;
-                m_dependencies.push_back(dep);
+        for (Heap *heap: frameRes.heaps) {
+            if (heap) {
+                m_device->DestroyHeap(heap);
             }
-            // If not found, assume it's an external resource
         }
+        frameRes.heaps.clear();
     }
-}
-
-void RenderGraph::TopologicalSort() {
-    m_compiledPasses.clear();
-
-    if (m_passes.empty()) {
-        return;
-    }
-
-    // Build adjacency list and in-degree count
-    std::unordered_map<RenderPass *, std::vector<RenderPass *> > adjacencyList;
-    std::unordered_map<RenderPass *, int> inDegree;
 
-    // Initialize
-    for (auto &pass: m_passes) {
-        inDegree[pass.get()] = 0;
-        adjacencyList[pass.get()] = {};
+    for (auto &timestamps: m_timestampFrames) {
+        ReleaseTimestampFrame(timestamps);
     }
 
-    // Build graph
-    for (const auto &dep: m_dependencies) {
-        adjacencyList[dep.producer].push_back(dep.consumer);
-        inDegree[dep.consumer]++;
+    // History versions are pool entries, they are destroyed with the pool and reallocated on next use
+    for (auto &history: m_histories) {
+        history.poolEntries.clear();
+        history.states.clear();
+        history.written.clear();
+        BindHistory(history);
     }
 
-    // Kahn's algorithm for topological sort
-    std::queue<RenderPass *> queue;
+    m_pool.Clear();
+}
 
-    // Add all nodes with no incoming edges
-    for (auto &pass: m_passes) {
-        if (inDegree[pass.get()] == 0) {
-            queue.push(pass.get());
-        }
+void RenderGraph::SetQueue(QueueType type, CommandQueue *queue) {
+    if (queue && queue->GetType() != type) {
+        throw std::runtime_error("RenderGraph: queue registered under a different queue type");
+    }
+    if (type == QueueType::Graphics && queue != m_commandQueue) {
+        throw std::runtime_error("RenderGraph: the graphics queue is set at construction");
     }
 
-    uint32_t index = 0;
-    while (!queue.empty()) {
-        RenderPass *current = queue.front();
-        queue.pop();
+    // Queue registration changes which queue passes compile to
+    InvalidatePlan();
 
-        // Add to sorted list
-        CompiledPass compiled;
-        compiled.pass = current;
-        compiled.index = index++;
-        m_compiledPasses.push_back(compiled);
+    QueueContext &context = m_queues[(uint32_t) type];
+    context.queue = queue;
 
-        // Reduce in-degree for neighbors
-        for (RenderPass *neighbor: adjacencyList[current]) {
-            inDegree[neighbor]--;
-            if (inDegree[neighbor] == 0) {
-                queue.push(neighbor);
-            }
-        }
-    }
+    // Command lists are bound to the previous queue's allocators
+    context.commandLists.clear();
+    context.commandLists.resize(m_frameCount);
 
-    // Check for cycles
-    if (m_compiledPasses.size() != m_passes.size()) {
-        throw std::runtime_error("RenderGraph contains circular dependencies!");
+    if (queue && !context.fence) {
+        context.fence = std::unique_ptr<Fence>(m_device->CreateFence(0));
+        context.fenceValue = 0;
     }
 }
 
-void RenderGraph::CleanupOldResources() {
-    // Resources can be destroyed if they haven't been used in m_frameCount frames
-    for (auto &frameRes: m_frameResources) {
-        std::vector<std::string> toRemove;
-
-        for (auto &[name, resource]: frameRes.resources) {
-            uint32_t framesSinceUse = m_currentFrameIndex >= resource.lastUsedFrame
-                                          ? m_currentFrameIndex - resource.lastUsedFrame
-                                          : (m_frameCount - resource.lastUsedFrame) + m_currentFrameIndex;
+uint32_t RenderGraph::DeclareResource(std::string_view name, RenderPassResource::Type type) {
+    WaitForCompile();
 
-            if (framesSinceUse >= m_frameCount && resource.canBeDestroyed) {
-                if (resource.texture) {
-                    m_device->DestroyTexture(resource.texture);
-                    resource.texture = nullptr;
-                }
-                if (resource.buffer) {
-                    m_device->DestroyBuffer(resource.buffer);
-                    resource.buffer = nullptr;
-                }
-                toRemove.push_back(name);
-            }
-        }
-
-        for (const auto &name: toRemove) {
-            frameRes.resources.erase(name);
+    auto it = m_resourceLookup.find(name);
+    if (it != m_resourceLookup.end()) {
+        if (m_resources[it->second].type != type) {
+            throw std::runtime_error("RenderGraph resource '" + std::string(name) +
+                                     "' declared as both texture and buffer");
         }
+        return it->second;
     }
+
+    uint32_t index = static_cast<uint32_t>(m_resources.size());
+    ResourceEntry entry;
+    entry.name = name;
+    entry.type = type;
+    m_resources.push_back(entry);
+    m_resourceLookup.emplace(name, index);
+
+    return index;
 }
 
+RenderGraphTextureHandle RenderGraph::DeclareTexture(std::string_view name) {
+    return RenderGraphTextureHandle{.index = DeclareResource(name, RenderPassResource::Type::Texture)};
+}
 
-void RenderGraph::AllocateResources() {
-    auto &currentFrame = m_frameResources[m_currentFrameIndex];
+RenderGraphBufferHandle RenderGraph::DeclareBuffer(std::string_view name) {
+    return RenderGraphBufferHandle{.index = DeclareResource(name, RenderPassResource::Type::Buffer)};
+}
 
-    for (auto &compiled: m_compiledPasses) {
-        RenderPass *pass = compiled.pass;
+void RenderGraph::Compile() {
+    if (m_pendingCompile.valid()) {
+        auto waitStart = std::chrono::high_resolution_clock::now();
+        WaitForCompile();
+        m_statistics.compileWaitTime = std::chrono::duration<float, std::milli>(
+            std::chrono::high_resolution_clock::now() - waitStart).count();
+    }
 
-        // Allocate output resources
-        for (const auto &output: pass->GetOutputs()) {
-            if (IsExternalResource(output.name)) {
-                compiled.outputResourceNames.push_back(output.name);
-                continue;
-            }
+    // The worker's compile may also have been waited for earlier, e.g. by a late AddPass
+    const bool compiledAsync = m_asyncPlanUnused;
+    m_asyncPlanUnused = false;
 
-            GetOrCreateResource(output.name, output);
-            compiled.outputResourceNames.push_back(output.name);
-        }
+    uint64_t structureHash = ComputeStructureHash();
+    uint64_t budgetBytes = GetTransientBudget();
 
-        // Track input resources
-        for (const auto &input: pass->GetInputs()) {
-            compiled.inputResourceNames.push_back(input.name);
+    if (IsPlanUsable(m_plan, structureHash, budgetBytes)) {
+        RebindPlan();
+        m_statistics.planCacheHit = !compiledAsync; // WaitForCompile counted the worker's compile as the miss
+        if (!compiledAsync) {
+            m_statistics.planCacheHits++;
         }
+        return;
     }
-}
 
-Texture *RenderGraph::CreateTransientTexture(const RenderPassResource &desc) {
-    TextureCreateInfo textureCI{
-        .width = desc.width,
-        .height = desc.height,
-        .depth = 1,
-        .mipLevels = 1,
-        .arraySize = 1,
-        .usage = (TextureUsage) desc.stateFlag
-    };
+    // The declaration changed after CompileAsync, its plan is kept as the previous one
+    if (compiledAsync) {
+        m_statistics.asyncCompilesDiscarded++;
+    }
 
-    // Map format
-    switch (desc.format) {
-        case RenderPassResource::Format::RGBA8:
-            textureCI.format = TextureFormat::RGBA8_UNORM;
-            break;
-        case RenderPassResource::Format::RGBA16F:
-            textureCI.format = TextureFormat::RGBA16_FLOAT;
-            break;
-        case RenderPassResource::Format::RGBA32F:
-            textureCI.format = TextureFormat::RGBA32_FLOAT;
-            break;
-        case RenderPassResource::Format::Depth32:
-            textureCI.format = TextureFormat::Depth32;
-            break;
-        default:
-            break;
+    // Toggling between two structures (e.g. a pass enabled every other frame) hits the previous plan
+    if (IsPlanUsable(m_previousPlan, structureHash, budgetBytes)) {
+        std::swap(m_plan, m_previousPlan);
+        RebindPlan();
+        m_statistics.planCacheHit = true;
+        m_statistics.planCacheHits++;
+        return;
     }
 
-    return m_device->CreateTexture(textureCI);
-}
+    if (m_plan.valid) {
+        std::swap(m_plan, m_previousPlan);
+    }
 
-Buffer *RenderGraph::CreateTransientBuffer(const RenderPassResource &desc) {
-    BufferCreateInfo bufferInfo;
-    bufferInfo.size = desc.size;
-    bufferInfo.usage = BufferUsage::Storage;
-    bufferInfo.memoryType = MemoryType::GPU;
+    float compileTime = CompilePlan(structureHash, budgetBytes);
 
-    return m_device->CreateBuffer(bufferInfo);
+    m_statistics.planCacheHit = false;
+    m_statistics.planCacheMisses++;
+    m_statistics.lastRecompileTime = compileTime;
 }
 
-void RenderGraph::CalculateResourceLifetimes() {
-    // Reset lifetimes
-    for (auto &[name, resource]: m_frameResources[m_currentFrameIndex].resources) {
-        resource.firstUse = UINT32_MAX;
-        resource.lastUse = 0;
-    }
-
-    // Calculate first and last use for each resource
-    for (const auto &compiled: m_compiledPasses) {
-        uint32_t passIndex = compiled.index;
+void RenderGraph::CompileAsync() {
+    WaitForCompile();
 
-        // Check inputs
-        for (const auto &input: compiled.pass->GetInputs()) {
-            auto it = m_frameResources[m_currentFrameIndex].resources.find(input.name);
-            if (it != m_frameResources[m_currentFrameIndex].resources.end()) {
-                it->second.firstUse = std::min(it->second.firstUse, passIndex);
-                it->second.lastUse = std::max(it->second.lastUse, passIndex);
-            }
-        }
+    uint64_t structureHash = ComputeStructureHash();
+    uint64_t budgetBytes = GetTransientBudget();
+    if (IsPlanUsable(m_plan, structureHash, budgetBytes) || IsPlanUsable(m_previousPlan, structureHash, budgetBytes)) {
+        return;
+    }
 
-        // Check outputs
-        for (const auto &output: compiled.pass->GetOutputs()) {
-            auto it = m_frameResources[m_currentFrameIndex].resources.find(output.name);
-            if (it != m_frameResources[m_currentFrameIndex].resources.end()) {
-                it->second.firstUse = std::min(it->second.firstUse, passIndex);
-                it->second.lastUse = std::max(it->second.lastUse, passIndex);
-            }
-        }
+    if (m_plan.valid) {
+        std::swap(m_plan, m_previousPlan);
     }
-}
+    m_plan.valid = false;
 
-// TODO: Implement
-void RenderGraph::AliasResources() {
-    // Find resources with non-overlapping lifetimes that could share memory
+    m_pendingCompile = std::async(std::launch::async, [this, structureHash, budgetBytes] {
+        return CompilePlan(structureHash, budgetBytes);
+    });
 }
 
-// TODO: Barriers for Buffers?
-void RenderGraph::InsertBarriers(uint32_t passIndex) {
-    CommandList *commandList = m_commandLists[m_currentFrameIndex].get();
-    const auto &compiled = m_compiledPasses[passIndex];
-
-    // Handle inputs
-    for (const auto &input: compiled.pass->GetInputs()) {
-        // Check if it's an external resource
-        auto extIt = m_externalResources.find(input.name);
-        if (extIt != m_externalResources.end()) {
-            TransitionExternalResource(input.name, input.stateFlag);
-            continue;
-        }
+void RenderGraph::WaitForCompile() {
+    if (!m_pendingCompile.valid()) {
+        return;
+    }
 
-        // Check transient resources
-        TransientResource *resource = GetCurrentFrameResource(input.name);
-        if (!resource) {
-            continue;
-        }
+    // Rethrows a compile failure on the calling thread
+    float compileTime = m_pendingCompile.get();
 
-        if (resource->currentStateFlag != input.stateFlag) {
-            if (resource->type == TransientResource::Type::Texture) {
-                commandList->TransitionTexture(
-                    resource->texture,
-                    (TextureUsage) resource->currentStateFlag,
-                    (TextureUsage) input.stateFlag
-                );
-            } else {
-                commandList->TransitionBuffer(
-                    resource->buffer,
-                    (BufferUsage) resource->currentStateFlag,
-                    (BufferUsage) input.stateFlag
-                );
-            }
+    m_asyncPlanUnused = true;
+    m_statistics.asyncCompiles++;
+    m_statistics.planCacheMisses++;
+    m_statistics.lastRecompileTime = compileTime;
+}
 
-            resource->currentStateFlag = input.stateFlag;
-            m_statistics.barrierCount++;
-        }
+void RenderGraph::InvalidatePlan() {
+    WaitForCompile();
+    if (m_asyncPlanUnused) {
+        m_statistics.asyncCompilesDiscarded++;
+        m_asyncPlanUnused = false;
     }
+    m_plan.valid = false;
+    m_previousPlan.valid = false;
+}
 
-    // Handle outputs
-    for (const auto &output: compiled.pass->GetOutputs()) {
-        // Check external resources
-        auto extIt = m_externalResources.find(output.name);
-        if (extIt != m_externalResources.end()) {
-            TransitionExternalResource(output.name, output.stateFlag);
-            continue;
-        }
+float RenderGraph::CompilePlan(uint64_t structureHash, uint64_t budgetBytes) {
+    // Runs on a worker when started by CompileAsync, so only the plan is written
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-        TransientResource *resource = GetCurrentFrameResource(output.name);
-        if (!resource) {
-            continue;
-        }
+    m_plan.valid = false;
+    m_plan.scheduleStrategy = m_scheduleStrategy;
+    m_plan.resolutionScale = 1.0f;
+    m_plan.dropOptionalPasses = false;
 
-        if (resource->currentStateFlag != output.stateFlag) {
-            if (resource->type == TransientResource::Type::Texture) {
-                commandList->TransitionTexture(
-                    resource->texture,
-                    (TextureUsage) resource->currentStateFlag,
-                    (TextureUsage) output.stateFlag
-                );
-            } else {
-                commandList->TransitionBuffer(
-                    resource->buffer,
-                    (BufferUsage) resource->currentStateFlag,
-                    (BufferUsage) output.stateFlag
-                );
-            }
+    BuildSchedule();
 
-            resource->currentStateFlag = output.stateFlag;
-            m_statistics.barrierCount++;
-        }
-    }
-}
+    ApplyMemoryBudget(budgetBytes);
 
-void RenderGraph::TransitionExternalResource(const std::string &name, uint32_t newState) {
-    auto it = m_externalResources.find(name);
-    if (it == m_externalResources.end()) {
-        return;
-    }
+    BuildBarrierPlan();
 
-    auto &resource = it->second;
-    if (resource.currentStateFlag == newState) {
-        return;
+    if (m_resourceAliasing) {
+        AliasResources();
     }
 
-    CommandList *commandList = m_commandLists[m_currentFrameIndex].get();
-
-    if (resource.type == ExternalResource::Type::Texture) {
-        commandList->TransitionTexture(
-            resource.texture,
-            (TextureUsage) resource.currentStateFlag,
-            (TextureUsage) newState
-        );
-    } else {
-        commandList->TransitionBuffer(
-            resource.buffer,
-            (BufferUsage) resource.currentStateFlag,
-            (BufferUsage) newState
-        );
+    m_plan.structureHash = structureHash;
+    m_plan.passCount = (uint32_t) m_passes.size();
+    m_plan.resourceCount = (uint32_t) m_resources.size();
+    m_plan.declarationCounts.clear();
+    for (const auto &pass: m_passes) {
+        m_plan.declarationCounts.push_back((uint32_t) pass->GetInputs().size());
+        m_plan.declarationCounts.push_back((uint32_t) pass->GetOutputs().size());
     }
+    m_plan.generation = ++m_planGenerations;
+    m_plan.valid = true;
 
-    resource.currentStateFlag = newState;
-    m_statistics.barrierCount++;
+    return std::chrono::duration<float, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
 }
 
-void RenderGraph::ExecutePass(const CompiledPass &compiledPass) {
-    RenderPassContext context = BuildPassContext(compiledPass);
-
-    compiledPass.pass->Execute(context);
-}
+void RenderGraph::BuildSchedule() {
+    BuildDependencyGraph();
 
-RenderPassContext RenderGraph::BuildPassContext(const CompiledPass &compiledPass) {
-    RenderPassContext context;
-    context.commandList = m_commandLists[m_currentFrameIndex].get();
-    context.frameIndex = m_currentFrameIndex;
-    context.deltaTime = 0.016f; // Would get from timer
+    CullPasses();
 
-    // Populate input textures and buffers
-    for (const auto &inputName: compiledPass.inputResourceNames) {
-        // Try to find as texture first
-        Texture *tex = GetTexture(inputName);
-        if (tex) {
-            context.inputTextures.push_back(tex);
-        }
+    TopologicalSort();
 
-        // Try to find as buffer
-        Buffer *buf = GetBuffer(inputName);
-        if (buf) {
-            context.inputBuffers.push_back(buf);
-        }
-    }
+    BuildQueueBatches();
 
-    // Populate output textures and buffers
-    for (const auto &outputName: compiledPass.outputResourceNames) {
-        Texture *tex = GetTexture(outputName);
-        if (tex) {
-            context.outputTextures.push_back(tex);
-        }
+    BuildRecordGroups();
 
-        Buffer *buf = GetBuffer(outputName);
-        if (buf) {
-            context.outputBuffers.push_back(buf);
-        }
-    }
+    CollectTransients();
 
-    return context;
-}
+    CalculateResourceLifetimes();
 
-void RenderGraph::RegisterExternalTexture(const std::string &name, Texture *texture,
-                                          TextureUsage initialState) {
-    ExternalResource resource;
-    resource.texture = texture;
-    resource.type = ExternalResource::Type::Texture;
-    resource.initialStateFlag = (uint32_t) initialState;
-    resource.currentStateFlag = (uint32_t) initialState;
-    resource.isPresentTarget = false;
+    BuildAttachmentPlan();
 
-    m_externalResources[name] = resource;
+    EstimatePeakTransientMemory();
 }
 
-void RenderGraph::RegisterExternalBuffer(const std::string &name, Buffer *buffer,
-                                         BufferUsage initialState) {
-    ExternalResource resource;
-    resource.buffer = buffer;
-    resource.type = ExternalResource::Type::Buffer;
-    resource.initialStateFlag = (uint32_t) initialState;
-    resource.currentStateFlag = (uint32_t) initialState;
-    resource.isPresentTarget = false;
+void RenderGraph::SetMaxRenderScale(float maxScale) {
+    InvalidatePlan();
+    m_maxRenderScale = maxScale;
+    m_renderScale = std::min(m_renderScale, m_maxRenderScale);
+}
 
-    m_externalResources[name] = resource;
+void RenderGraph::SetRenderScale(float scale) {
+    m_renderScale = std::clamp(scale, 0.0f, m_maxRenderScale);
 }
 
-void RenderGraph::SetPresentTarget(const std::string &name) {
-    m_presentTarget = name;
+void RenderGraph::SetDynamicResolution(bool enable, const RenderScaleSettings &settings) {
+    if (!enable) {
+        m_renderScaleController.reset();
+        return;
+    }
 
-    auto it = m_externalResources.find(name);
-    if (it != m_externalResources.end()) {
-        it->second.isPresentTarget = true;
+    if (settings.maxScale != m_maxRenderScale) {
+        SetMaxRenderScale(settings.maxScale);
     }
+    m_renderScaleController = std::make_unique<RenderScaleController>(settings);
+    m_renderScaleController->Reset(m_renderScale);
 }
 
-bool RenderGraph::IsExternalResource(const std::string &name) const {
-    return m_externalResources.find(name) != m_externalResources.end();
+uint64_t RenderGraph::GetTransientBudget() const {
+    if (m_memoryBudgetFraction <= 0.0f) {
+        return 0;
+    }
+    return static_cast<uint64_t>(static_cast<double>(m_device->GetVideoMemoryBudget()) * m_memoryBudgetFraction);
 }
 
+void RenderGraph::ApplyMemoryBudget(uint64_t budgetBytes) {
+    m_plan.budgetBytes = budgetBytes;
+    m_plan.undegradedPeakBytes = m_plan.peakTransientBytes;
+    m_plan.degradations = 0;
+    m_plan.policiesTried = 0;
 
-RenderGraph::TransientResource *RenderGraph::GetOrCreateResource(const std::string &name,
-                                                                 const RenderPassResource &desc) {
-    auto &currentFrame = m_frameResources[m_currentFrameIndex];
-    auto it = currentFrame.resources.find(name);
-
-    if (it != currentFrame.resources.end()) {
-        return &it->second;
-    }
+    // Each policy keeps the ones before it, the schedule is rebuilt until the peak fits
+    for (DegradationPolicy policy: m_degradationPolicies) {
+        if (budgetBytes == 0 || m_plan.peakTransientBytes <= budgetBytes) {
+            break;
+        }
+        m_plan.policiesTried++;
 
-    // Create new transient resource for this frame
-    TransientResource resource;
-    resource.name = name;
-    resource.type = desc.type == RenderPassResource::Type::Texture
-                        ? TransientResource::Type::Texture
-                        : TransientResource::Type::Buffer;
-    resource.lastUsedFrame = m_currentFrameIndex;
-    resource.canBeDestroyed = false; // Will be set true after frame is fully executed
-    resource.initialStateFlag = desc.stateFlag;
-    resource.currentStateFlag = desc.stateFlag;
+        switch (policy) {
+            case DegradationPolicy::Reschedule:
+                if (m_plan.scheduleStrategy == ScheduleStrategy::MinimizeMemory) {
+                    continue;
+                }
+                m_plan.scheduleStrategy = ScheduleStrategy::MinimizeMemory;
+                break;
+            case DegradationPolicy::ReduceResolution:
+                m_plan.resolutionScale = std::min(m_plan.resolutionScale, m_degradedResolutionScale);
+                break;
+            case DegradationPolicy::DropOptionalPasses:
+                m_plan.dropOptionalPasses = true;
+                break;
+            default:
+                continue;
+        }
 
-    if (resource.type == TransientResource::Type::Texture) {
-        resource.texture = CreateTransientTexture(desc);
-        resource.width = desc.width;
-        resource.height = desc.height;
-    } else {
-        resource.buffer = CreateTransientBuffer(desc);
-        resource.size = desc.size;
+        const uint64_t peakBefore = m_plan.peakTransientBytes;
+        BuildSchedule();
+        if (m_plan.peakTransientBytes < peakBefore) {
+            m_plan.degradations |= 1u << (uint32_t) policy;
+        }
     }
-
-    currentFrame.resources[name] = resource;
-    return &currentFrame.resources[name];
 }
 
-RenderGraph::TransientResource *RenderGraph::GetCurrentFrameResource(const std::string &name) {
-    auto &currentFrame = m_frameResources[m_currentFrameIndex];
-    auto it = currentFrame.resources.find(name);
+bool RenderGraph::IsPlanUsable(const CompiledPlan &plan, uint64_t structureHash, uint64_t budgetBytes) const {
+    if (!plan.valid || plan.structureHash != structureHash || !MatchesDeclarationShape(plan)) {
+        return false;
+    }
 
-    if (it != currentFrame.resources.end()) {
-        it->second.lastUsedFrame = m_currentFrameIndex;
-        return &it->second;
+    // The budget moves with other applications' usage, the plan is only redone when its verdict changes:
+    // it now fits undegraded, it no longer does, or it is over again and has policies left to try
+    const bool exceeded = budgetBytes != 0 && plan.undegradedPeakBytes > budgetBytes;
+    const bool wasExceeded = plan.budgetBytes != 0 && plan.undegradedPeakBytes > plan.budgetBytes;
+    if (exceeded != wasExceeded) {
+        return false;
     }
 
-    return nullptr;
+    return !exceeded || plan.peakTransientBytes <= budgetBytes || plan.policiesTried == m_degradationPolicies.size();
 }
 
-Texture *RenderGraph::GetTexture(const std::string &name) {
-    // Check external first
-    auto extIt = m_externalResources.find(name);
-    if (extIt != m_externalResources.end() &&
-        extIt->second.type == ExternalResource::Type::Texture) {
-        return extIt->second.texture;
+bool RenderGraph::MatchesDeclarationShape(const CompiledPlan &plan) const {
+    if (plan.passCount != m_passes.size() || plan.resourceCount != m_resources.size()) {
+        return false;
     }
 
-    // Check current frame transients
-    TransientResource *resource = GetCurrentFrameResource(name);
-    if (resource && resource->type == TransientResource::Type::Texture) {
-        return resource->texture;
+    for (size_t i = 0; i < m_passes.size(); i++) {
+        if (plan.declarationCounts[i * 2] != m_passes[i]->GetInputs().size() ||
+            plan.declarationCounts[i * 2 + 1] != m_passes[i]->GetOutputs().size()) {
+            return false;
+        }
     }
 
-    return nullptr;
+    return true;
 }
 
-Buffer *RenderGraph::GetBuffer(const std::string &name) {
-    // Check external first
-    auto extIt = m_externalResources.find(name);
-    if (extIt != m_externalResources.end() &&
-        extIt->second.type == ExternalResource::Type::Buffer) {
-        return extIt->second.buffer;
-    }
+uint64_t RenderGraph::ComputeStructureHash() const {
+    uint64_t hash = HashOffsetBasis;
+
+    HashValue(hash, m_passes.size());
+    for (const auto &pass: m_passes) {
+        HashString(hash, pass->GetName());
+        HashValue(hash, pass->IsEnabled());
+        HashValue(hash, GetPassQueue(*pass)); // Depends on which queues are registered
+        HashValue(hash, pass->HasSideEffects());
+        HashValue(hash, pass->IsOptional());
+        HashValue(hash, pass->HasManualAttachments());
+
+        // Whether a resource is external decides if the graph allocates it
+        auto hashResources = [&](const std::pmr::vector<RenderPassResource> &resources) {
+            HashValue(hash, resources.size());
+            for (const auto &resource: resources) {
+                HashValue(hash, resource.resource);
+                HashValue(hash, resource.type);
+                HashValue(hash, resource.access);
+                HashValue(hash, resource.stateFlag);
+                HashValue(hash, resource.nonOverlapping);
+                HashValue(hash, resource.stage);
+                HashValue(hash, resource.width);
+                HashValue(hash, resource.height);
+                HashValue(hash, resource.mipLevels);
+                HashValue(hash, resource.downscalable);
+                HashValue(hash, resource.scaled);
+                HashValue(hash, resource.range);
+                HashValue(hash, resource.format);
+                HashValue(hash, resource.size);
+                HashValue(hash, resource.loadOp); // Clear values are read when recording
+                HashValue(hash, resource.storeOp);
+                HashValue(hash, IsExternalResource(resource.resource));
+            }
+        };
 
-    // Check current frame transients
-    TransientResource *resource = GetCurrentFrameResource(name);
-    if (resource && resource->type == TransientResource::Type::Buffer) {
-        return resource->buffer;
+        hashResources(pass->GetInputs());
+        hashResources(pass->GetOutputs());
     }
 
-    return nullptr;
-}
+    HashValue(hash, m_presentTarget);
 
-void RenderGraph::UpdateStatistics() {
-    m_statistics.passCount = static_cast<uint32_t>(m_compiledPasses.size());
-    m_statistics.transientResourceCount = static_cast<uint32_t>(m_frameResources[m_currentFrameIndex].resources.size());
+    return hash;
+}
 
-    uint64_t memoryUsed = 0;
-    for (const auto &[name, resource]: m_frameResources[m_currentFrameIndex].resources) {
-        if (resource.type == TransientResource::Type::Texture) {
-            // Estimate texture memory (simplified)
-            memoryUsed += static_cast<uint64_t>(resource.width) * resource.height * 4;
-        } else {
-            memoryUsed += resource.size;
-        }
+void RenderGraph::RebindPlan() {
+    // Same structure as the cached plan, only the pass objects were recreated
+    for (auto &compiled: m_plan.passes) {
+        compiled.pass = m_passes[compiled.declarationIndex].get();
     }
-    m_statistics.transientMemoryUsed = memoryUsed;
 }
 
-void RenderGraph::LogRenderGraph() {
-    printf("\n===== RenderGraph =====\n");
+void RenderGraph::BuildDependencyGraph() {
+    m_plan.dependencies.clear();
 
-    char msg[512];
-    sprintf_s(msg, "Passes: %u\n", m_statistics.passCount);
-    printf(msg);
+    const uint32_t resourceCount = static_cast<uint32_t>(m_resources.size());
+    constexpr uint32_t None = UINT32_MAX;
 
-    sprintf_s(msg, "Dependencies: %zu\n", m_dependencies.size());
-    printf(msg);
+    // Writers of each resource in declaration order. A read depends on the last writer declared
+    // before it; a read declared before any writer consumes the first writer's output, unless the
+    // resource is external, in which case it reads the imported contents.
+    std::vector<uint32_t> firstWriter(resourceCount, None);
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        if (!m_passes[i]->IsEnabled()) {
+            continue;
+        }
+
+        for (const auto &output: m_passes[i]->GetOutputs()) {
+            if (firstWriter[output.resource] == None) {
+                firstWriter[output.resource] = i;
+            }
+        }
+    }
+
+    std::vector<uint32_t> lastWriter(resourceCount, None);
+    std::vector<std::vector<uint32_t> > readers(resourceCount);
+
+    using Type = PassDependency::Type;
+    auto addDependency = [&](uint32_t producer, uint32_t consumer, uint32_t resource, Type type) {
+        if (producer != None && producer != consumer) {
+            m_plan.dependencies.push_back({producer, consumer, resource, type});
+        }
+    };
+
+    // Disabled passes neither read nor write, they constrain nothing
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        if (!m_passes[i]->IsEnabled()) {
+            continue;
+        }
+
+        // Read-after-write
+        for (const auto &input: m_passes[i]->GetInputs()) {
+            uint32_t resource = input.resource;
+            if (lastWriter[resource] != None) {
+                addDependency(lastWriter[resource], i, resource, Type::ReadAfterWrite);
+                readers[resource].push_back(i);
+            } else if (IsExternalResource(resource)) {
+                readers[resource].push_back(i);
+            } else {
+                addDependency(firstWriter[resource], i, resource, Type::ReadAfterWrite);
+            }
+        }
+
+        // Write-after-write and write-after-read
+        for (const auto &output: m_passes[i]->GetOutputs()) {
+            uint32_t resource = output.resource;
+            addDependency(lastWriter[resource], i, resource, Type::WriteAfterWrite);
+            for (uint32_t reader: readers[resource]) {
+                addDependency(reader, i, resource, Type::WriteAfterRead);
+            }
+            readers[resource].clear();
+            lastWriter[resource] = i;
+        }
+    }
+}
+
+void RenderGraph::CullPasses() {
+    const uint32_t passCount = static_cast<uint32_t>(m_passes.size());
+    m_plan.culled.assign(passCount, false);
+
+    // Disabled passes and optional passes dropped for the memory budget are never live, whoever reads their outputs
+    auto dropped = [&](uint32_t pass) {
+        return !m_passes[pass]->IsEnabled() || (m_plan.dropOptionalPasses && m_passes[pass]->IsOptional());
+    };
+
+    // A pass is needed if a needed pass reads its output. Earlier writers of a resource a needed pass
+    // writes are kept too, the graph cannot tell a full overwrite from a partial one.
+    std::vector<std::vector<uint32_t> > producers(passCount);
+    for (const auto &dep: m_plan.dependencies) {
+        if (dep.type != PassDependency::Type::WriteAfterRead) {
+            producers[dep.consumer].push_back(dep.producer);
+        }
+    }
+
+    // Roots: writes visible outside the graph (present target, imported resources) and explicit side effects
+    std::vector<bool> live(passCount, false);
+    std::vector<uint32_t> stack;
+    for (uint32_t i = 0; i < passCount; ++i) {
+        bool root = !m_passCulling || m_passes[i]->HasSideEffects();
+        for (const auto &output: m_passes[i]->GetOutputs()) {
+            root = root || IsExternalResource(output.resource);
+        }
+
+        if (root && !dropped(i)) {
+            live[i] = true;
+            stack.push_back(i);
+        }
+    }
+
+    while (!stack.empty()) {
+        uint32_t pass = stack.back();
+        stack.pop_back();
+
+        for (uint32_t producer: producers[pass]) {
+            if (!live[producer] && !dropped(producer)) {
+                live[producer] = true;
+                stack.push_back(producer);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < passCount; ++i) {
+        m_plan.culled[i] = !live[i];
+    }
+
+    std::erase_if(m_plan.dependencies, [&](const PassDependency &dep) {
+        return m_plan.culled[dep.producer] || m_plan.culled[dep.consumer];
+    });
+}
+
+void RenderGraph::TopologicalSort() {
+    m_plan.passes.clear();
+
+    if (m_passes.empty()) {
+        return;
+    }
+
+    // Build adjacency list and in-degree count
+    std::vector<std::vector<uint32_t> > adjacencyList(m_passes.size());
+    std::vector<int> inDegree(m_passes.size(), 0);
+
+    // Build graph
+    for (const auto &dep: m_plan.dependencies) {
+        adjacencyList[dep.producer].push_back(dep.consumer);
+        inDegree[dep.consumer]++;
+    }
+
+    // Kahn's algorithm for topological sort. Ready passes go in the order they became ready, unless the
+    // strategy scores another ready pass lower. Scores are kept in a min-heap: scheduling a pass only
+    // rescores the ready passes sharing a resource with it, their older heap entries are skipped when popped.
+    constexpr uint32_t None = UINT32_MAX;
+
+    struct ReadyEntry {
+        float score;
+        uint32_t readyOrder;
+        uint32_t pass;
+        uint32_t version;
+    };
+    auto later = [](const ReadyEntry &a, const ReadyEntry &b) {
+        return a.score != b.score ? a.score > b.score : a.readyOrder > b.readyOrder;
+    };
+    std::priority_queue<ReadyEntry, std::vector<ReadyEntry>, decltype(later)> ready(later);
+
+    const bool scored = m_plan.scheduleStrategy != ScheduleStrategy::DeclarationOrder;
+    ScheduleState state;
+    if (scored) {
+        InitScheduleState(state);
+    }
+
+    std::vector<uint32_t> readyOrder(m_passes.size(), None);
+    std::vector<uint32_t> version(m_passes.size(), 0); // Bumped when a pass is rescored or scheduled
+    std::vector<uint32_t> scoredAt(m_passes.size(), None); // Sort index of the last rescore
+    std::vector<bool> scheduled(m_passes.size(), false);
+    uint32_t readyCount = 0;
+
+    auto pushReady = [&](uint32_t pass) {
+        float score = scored ? ScoreReadyPass(state, pass) : 0.0f;
+        ready.push({score, readyOrder[pass], pass, ++version[pass]});
+    };
+
+    // Add all nodes with no incoming edges, culled passes are left out of the plan
+    uint32_t livePassCount = 0;
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        if (m_plan.culled[i]) {
+            continue;
+        }
+
+        livePassCount++;
+        if (inDegree[i] == 0) {
+            readyOrder[i] = readyCount++;
+            pushReady(i);
+        }
+    }
+
+    uint32_t index = 0;
+    while (!ready.empty()) {
+        ReadyEntry entry = ready.top();
+        ready.pop();
+        if (scheduled[entry.pass] || entry.version != version[entry.pass]) {
+            continue;
+        }
+
+        uint32_t current = entry.pass;
+        scheduled[current] = true;
+        if (scored) {
+            ApplyScheduledPass(state, current);
+        }
+
+        // Add to sorted list
+        CompiledPass compiled;
+        compiled.pass = m_passes[current].get();
+        compiled.index = index++;
+        compiled.declarationIndex = current;
+        m_plan.passes.push_back(compiled);
+
+        // Reduce in-degree for neighbors
+        for (uint32_t neighbor: adjacencyList[current]) {
+            inDegree[neighbor]--;
+            if (inDegree[neighbor] == 0) {
+                readyOrder[neighbor] = readyCount++;
+                scoredAt[neighbor] = compiled.index;
+                pushReady(neighbor);
+            }
+        }
+
+        if (!scored) {
+            continue;
+        }
+
+        // A score depends on the states of the pass's resources and on how recently their producers were
+        // scheduled, so only passes sharing a resource with the last LatencyWindow scheduled passes change
+        const size_t windowStart = m_plan.passes.size() - std::min<size_t>(m_plan.passes.size(),
+                                                                          ScheduleState::LatencyWindow);
+        for (size_t i = windowStart; i < m_plan.passes.size(); ++i) {
+            for (const auto &use: state.uses[m_plan.passes[i].declarationIndex]) {
+                for (uint32_t user: state.users[use.resource]) {
+                    if (readyOrder[user] != None && !scheduled[user] && scoredAt[user] != compiled.index) {
+                        scoredAt[user] = compiled.index;
+                        pushReady(user);
+                    }
+                }
+            }
+        }
+    }
+
+    // Check for cycles
+    if (m_plan.passes.size() != livePassCount) {
+        throw std::runtime_error("RenderGraph contains circular dependencies!");
+    }
+}
+
+void RenderGraph::InitScheduleState(ScheduleState &state) const {
+    const uint32_t resourceCount = static_cast<uint32_t>(m_resources.size());
+    constexpr uint32_t None = UINT32_MAX;
+
+    state.uses.assign(m_passes.size(), {});
+    state.users.assign(resourceCount, {});
+    state.resourceState.assign(resourceCount, None);
+    state.producerPosition.assign(resourceCount, None);
+    state.remainingUses.assign(resourceCount, 0);
+    state.transientBytes.assign(resourceCount, 0);
+    state.allocated.assign(resourceCount, false);
+    state.largestTransient = 1;
+    state.position = 0;
+
+    const bool scoresMemory = m_plan.scheduleStrategy == ScheduleStrategy::MinimizeMemory ||
+                              m_plan.scheduleStrategy == ScheduleStrategy::Balanced;
+
+    for (uint32_t i = 0; i < resourceCount; ++i) {
+        if (m_resources[i].isExternal) {
+            state.resourceState[i] = m_resources[i].currentStateFlag;
+        }
+    }
+
+    for (uint32_t i = 0; i < m_passes.size(); ++i) {
+        if (m_plan.culled[i]) {
+            continue;
+        }
+
+        auto &uses = state.uses[i];
+        auto addUse = [&](const RenderPassResource &desc, bool write) {
+            for (auto &use: uses) {
+                if (use.resource == desc.resource) {
+                    use.stateFlag = desc.stateFlag;
+                    use.write = use.write || write;
+                    return;
+                }
+            }
+            uses.push_back({desc.resource, desc.stateFlag, write});
+            state.users[desc.resource].push_back(i);
+            state.remainingUses[desc.resource]++;
+        };
+
+        for (const auto &input: m_passes[i]->GetInputs()) {
+            addUse(input, false);
+        }
+
+        for (const auto &output: m_passes[i]->GetOutputs()) {
+            addUse(output, true);
+
+            // Transients start in the state of their first declared output
+            if (!IsExternalResource(output.resource) && state.resourceState[output.resource] == None) {
+                state.resourceState[output.resource] = output.stateFlag;
+                if (scoresMemory) {
+                    state.transientBytes[output.resource] = GetAllocationInfo(output).size;
+                    state.largestTransient = std::max(state.largestTransient, state.transientBytes[output.resource]);
+                }
+            }
+        }
+    }
+}
+
+float RenderGraph::ScoreReadyPass(const ScheduleState &state, uint32_t pass) const {
+    constexpr uint32_t None = UINT32_MAX;
+    constexpr uint32_t LatencyWindow = ScheduleState::LatencyWindow;
+
+    uint32_t transitions = 0;
+    uint32_t latency = 0;
+    int64_t memory = 0;
+
+    for (const auto &use: state.uses[pass]) {
+        if (state.resourceState[use.resource] != use.stateFlag) {
+            transitions++;
+
+            uint32_t producer = state.producerPosition[use.resource];
+            if (producer != None && state.position - producer < LatencyWindow) {
+                latency += LatencyWindow - (state.position - producer);
+            }
+        }
+
+        uint64_t bytes = state.transientBytes[use.resource];
+        if (!state.allocated[use.resource]) {
+            memory += static_cast<int64_t>(bytes);
+        }
+        if (state.remainingUses[use.resource] == 1) {
+            memory -= static_cast<int64_t>(bytes);
+        }
+    }
+
+    float memoryScore = static_cast<float>(memory) / static_cast<float>(state.largestTransient);
+
+    switch (m_plan.scheduleStrategy) {
+        case ScheduleStrategy::MinimizeTransitions:
+            return static_cast<float>(transitions);
+        case ScheduleStrategy::HideBarrierLatency:
+            return static_cast<float>(latency);
+        case ScheduleStrategy::MinimizeMemory:
+            return memoryScore;
+        case ScheduleStrategy::Balanced:
+            return static_cast<float>(transitions) + 0.5f * static_cast<float>(latency) + memoryScore;
+        default:
+            return 0.0f;
+    }
+}
+
+void RenderGraph::ApplyScheduledPass(ScheduleState &state, uint32_t pass) const {
+    for (const auto &use: state.uses[pass]) {
+        state.resourceState[use.resource] = use.stateFlag;
+        state.allocated[use.resource] = true;
+        state.remainingUses[use.resource]--;
+        if (use.write) {
+            state.producerPosition[use.resource] = state.position;
+        }
+    }
+
+    state.position++;
+}
+
+std::vector<RenderGraph::ScheduleReport> RenderGraph::CompareScheduleStrategies() {
+    InvalidatePlan();
+
+    const ScheduleStrategy selected = m_scheduleStrategy;
+    const Statistics statistics = m_statistics;
+
+    std::vector<ScheduleReport> reports;
+    for (uint32_t i = 0; i < (uint32_t) ScheduleStrategy::Count; ++i) {
+        m_scheduleStrategy = (ScheduleStrategy) i;
+        InvalidatePlan();
+        Compile();
+
+        reports.push_back({m_scheduleStrategy, m_plan.plannedTransitionCount, m_plan.peakTransientBytes});
+    }
+
+    // Comparing is not a frame, keep the statistics of the last one
+    m_scheduleStrategy = selected;
+    InvalidatePlan();
+    m_statistics = statistics;
+
+    return reports;
+}
+
+void RenderGraph::BuildQueueBatches() {
+    m_plan.batches.clear();
+    m_plan.joinWaits.clear();
+
+    constexpr uint32_t None = UINT32_MAX;
+
+    std::vector<uint32_t> compiledIndex(m_passes.size());
+    for (const auto &compiled: m_plan.passes) {
+        compiledIndex[compiled.declarationIndex] = compiled.index;
+    }
+
+    // Passes each pass must run after. Besides dependencies, a resource used in a different state
+    // than its previous use needs ordering too, otherwise two queues could transition it at once.
+    std::vector<std::vector<uint32_t> > predecessors(m_plan.passes.size());
+    for (const auto &dep: m_plan.dependencies) {
+        predecessors[compiledIndex[dep.consumer]].push_back(compiledIndex[dep.producer]);
+    }
+
+    std::vector<uint32_t> lastUser(m_resources.size(), None);
+    std::vector<uint32_t> lastState(m_resources.size(), 0);
+    for (auto &compiled: m_plan.passes) {
+        compiled.queue = GetPassQueue(*compiled.pass);
+
+        auto use = [&](const RenderPassResource &desc) {
+            uint32_t state = GetQueueState(compiled.queue, desc);
+            uint32_t previous = lastUser[desc.resource];
+            if (previous != None && previous != compiled.index && lastState[desc.resource] != state) {
+                predecessors[compiled.index].push_back(previous);
+            }
+            lastUser[desc.resource] = compiled.index;
+            lastState[desc.resource] = state;
+        };
+
+        for (const auto &input: compiled.pass->GetInputs()) {
+            use(input);
+        }
+        for (const auto &output: compiled.pass->GetOutputs()) {
+            use(output);
+        }
+    }
+
+    std::array<uint32_t, QueueCount> openBatch;
+    openBatch.fill(None);
+
+    // Latest batch of each queue (column) that a queue (row) has waited for. Waits are cumulative,
+    // waiting for a batch also covers every earlier batch on its queue.
+    std::array<std::array<uint32_t, QueueCount>, QueueCount> waited;
+    for (auto &row: waited) {
+        row.fill(None);
+    }
+
+    auto alreadyWaited = [&](uint32_t queue, uint32_t batch) {
+        uint32_t latest = waited[queue][(uint32_t) m_plan.batches[batch].queue];
+        return latest != None && latest >= batch;
+    };
+
+    for (auto &compiled: m_plan.passes) {
+        uint32_t queue = (uint32_t) compiled.queue;
+
+        // Only edges that cross queues need a fence, and only the latest batch per queue
+        std::array<uint32_t, QueueCount> needed;
+        needed.fill(None);
+        for (uint32_t predecessor: predecessors[compiled.index]) {
+            uint32_t batch = m_plan.passes[predecessor].batch;
+            uint32_t producerQueue = (uint32_t) m_plan.batches[batch].queue;
+            if (producerQueue == queue || alreadyWaited(queue, batch)) {
+                continue;
+            }
+            if (needed[producerQueue] == None || needed[producerQueue] < batch) {
+                needed[producerQueue] = batch;
+            }
+        }
+
+        std::vector<uint32_t> waits;
+        for (uint32_t batch: needed) {
+            if (batch != None) {
+                waits.push_back(batch);
+            }
+        }
+
+        // A wait applies to a whole submission, so work after a cross-queue edge starts a new batch
+        if (!waits.empty() || openBatch[queue] == None) {
+            openBatch[queue] = static_cast<uint32_t>(m_plan.batches.size());
+            QueueBatch batch;
+            batch.queue = compiled.queue;
+            batch.waits = waits;
+            m_plan.batches.push_back(batch);
+        }
+
+        for (uint32_t wait: waits) {
+            uint32_t producerQueue = (uint32_t) m_plan.batches[wait].queue;
+            waited[queue][producerQueue] = wait;
+            m_plan.batches[wait].signal = true;
+
+            // Later work on the producer queue must not delay the signal
+            if (openBatch[producerQueue] == wait) {
+                openBatch[producerQueue] = None;
+            }
+        }
+
+        compiled.batch = openBatch[queue];
+        compiled.batchPosition = static_cast<uint32_t>(m_plan.batches[compiled.batch].passes.size());
+        m_plan.batches[compiled.batch].passes.push_back(compiled.index);
+    }
+
+    // The frame ends on graphics, which waits for the last batch of every other queue so the
+    // caller's frame fence covers all of the graph's work
+    constexpr uint32_t graphics = (uint32_t) QueueType::Graphics;
+    std::vector<uint32_t> join;
+    for (uint32_t queue = 0; queue < QueueCount; ++queue) {
+        if (queue == graphics) {
+            continue;
+        }
+
+        for (uint32_t batch = static_cast<uint32_t>(m_plan.batches.size()); batch-- > 0;) {
+            if ((uint32_t) m_plan.batches[batch].queue == queue) {
+                if (!alreadyWaited(graphics, batch)) {
+                    m_plan.batches[batch].signal = true;
+                    join.push_back(batch);
+                }
+                break;
+            }
+        }
+    }
+
+    // The present transition is recorded in the last batch, so it has to be a graphics one
+    if (m_plan.batches.empty() || m_plan.batches.back().queue != QueueType::Graphics) {
+        QueueBatch batch;
+        batch.queue = QueueType::Graphics;
+        batch.waits = join;
+        m_plan.batches.push_back(batch);
+    } else {
+        m_plan.joinWaits = join;
+    }
+}
+
+void RenderGraph::BuildRecordGroups() {
+    m_plan.groups.clear();
+
+    const uint32_t threadCount = m_threadPool ? m_threadPool->GetThreadCount() : 1;
+
+    for (uint32_t batchIndex = 0; batchIndex < m_plan.batches.size(); ++batchIndex) {
+        QueueBatch &batch = m_plan.batches[batchIndex];
+        const uint32_t passCount = static_cast<uint32_t>(batch.passes.size());
+
+        // Contiguous ranges of near equal pass count, an empty batch still gets a list to submit
+        uint32_t groupCount = std::max(1u, std::min(threadCount, passCount));
+        batch.firstGroup = static_cast<uint32_t>(m_plan.groups.size());
+        batch.groupCount = groupCount;
+
+        for (uint32_t i = 0; i < groupCount; ++i) {
+            RecordGroup group;
+            group.batch = batchIndex;
+            group.begin = passCount * i / groupCount;
+            group.end = passCount * (i + 1) / groupCount;
+
+            for (uint32_t j = group.begin; j < group.end; ++j) {
+                m_plan.passes[batch.passes[j]].group = static_cast<uint32_t>(m_plan.groups.size());
+            }
+
+            m_plan.groups.push_back(group);
+        }
+    }
+}
+
+void RenderGraph::CollectTransients() {
+    m_plan.transients.clear();
+    m_plan.heaps.clear();
+    std::vector<bool> seen(m_resources.size(), false);
+
+    for (const auto &compiled: m_plan.passes) {
+        const auto &outputs = compiled.pass->GetOutputs();
+        for (uint32_t i = 0; i < outputs.size(); ++i) {
+            uint32_t resource = outputs[i].resource;
+            if (IsExternalResource(resource) || seen[resource]) {
+                continue;
+            }
+            seen[resource] = true;
+
+            TransientDeclaration transient;
+            transient.resource = resource;
+            transient.declarationIndex = compiled.declarationIndex;
+            transient.outputIndex = i;
+            m_plan.transients.push_back(transient);
+        }
+    }
+
+    // Transients only culled or disabled passes write are never allocated, their readers get null resources
+    m_plan.unwrittenReads.clear();
+    for (const auto &compiled: m_plan.passes) {
+        for (const auto &input: compiled.pass->GetInputs()) {
+            if (!IsExternalResource(input.resource) && !seen[input.resource]) {
+                m_plan.unwrittenReads.push_back({compiled.declarationIndex, input.resource});
+            }
+        }
+    }
+}
+
+void RenderGraph::BuildBarrierPlan() {
+    for (auto &compiled: m_plan.passes) {
+        compiled.barriers.clear();
+        compiled.aliasActivations.clear();
+        compiled.splitBegins.clear();
+        compiled.unorderedAccesses.clear();
+
+        // Read-write declarations are in both lists, so one use per resource collects both
+        auto addUnorderedAccess = [&](const RenderPassResource &resource, bool write) {
+            if (!resource.IsUnorderedAccess()) {
+                return;
+            }
+
+            auto use = std::find_if(compiled.unorderedAccesses.begin(), compiled.unorderedAccesses.end(),
+                                    [&](const UnorderedAccessUse &use) { return use.resource == resource.resource; });
+            if (use == compiled.unorderedAccesses.end()) {
+                use = compiled.unorderedAccesses.insert(use, {resource.resource});
+            }
+            use->write = use->write || write;
+            use->nonOverlapping = use->nonOverlapping && resource.nonOverlapping;
+        };
+
+        for (const auto &input: compiled.pass->GetInputs()) {
+            compiled.barriers.push_back({input.resource, GetQueueState(compiled.queue, input), input.range});
+            addUnorderedAccess(input, false);
+        }
+
+        for (const auto &output: compiled.pass->GetOutputs()) {
+            compiled.barriers.push_back({output.resource, GetQueueState(compiled.queue, output), output.range});
+            addUnorderedAccess(output, true);
+        }
+    }
+
+    for (auto &group: m_plan.groups) {
+        group.handoffs.clear();
+    }
+
+    std::vector<uint32_t> transientIndex(m_resources.size(), UINT32_MAX);
+    for (uint32_t i = 0; i < m_plan.transients.size(); ++i) {
+        m_plan.transients[i].queueStartState = UINT32_MAX;
+        transientIndex[m_plan.transients[i].resource] = i;
+    }
+
+    // Resources used by subresource range hold several states at once, they are never split
+    std::vector<bool> ranged(m_resources.size(), false);
+    for (const auto &compiled: m_plan.passes) {
+        for (const auto &request: compiled.barriers) {
+            if (!request.range.IsWhole()) {
+                ranged[request.resource] = true;
+            }
+        }
+    }
+
+    // A transition between two uses can begin right after the first one when passes in between
+    // leave the resource alone. The state a pass leaves a resource in is its last request for it.
+    constexpr uint32_t None = UINT32_MAX;
+    m_plan.plannedTransitionCount = 0;
+    std::vector<uint32_t> lastPass(m_resources.size(), None);
+    std::vector<uint32_t> lastState(m_resources.size(), 0);
+    std::vector<uint32_t> passState(m_resources.size(), None);
+
+    // Compute and copy lists cannot record transitions from graphics only states. The producer's batch
+    // makes them before it signals, which the consumer waits for because the states differ.
+    auto checkQueueState = [&](uint32_t passIndex, const BarrierRequest &request, uint32_t state) {
+        const CompiledPass &compiled = m_plan.passes[passIndex];
+        if (compiled.queue == QueueType::Graphics) {
+            return;
+        }
+
+        const uint32_t resource = request.resource;
+        const bool texture = m_resources[resource].type == RenderPassResource::Type::Texture;
+        if (!IsQueueState(compiled.queue, texture, state)) {
+            throw std::runtime_error("RenderPass '" + std::string(compiled.pass->GetName()) + "' uses '" +
+                                     GetResourceName(resource) + "' in a state its queue cannot transition to");
+        }
+
+        const uint32_t previous = lastPass[resource];
+        if (previous == None) {
+            if (transientIndex[resource] != UINT32_MAX) {
+                m_plan.transients[transientIndex[resource]].queueStartState = state;
+            }
+            return;
+        }
+        if (lastState[resource] == state || IsQueueState(compiled.queue, texture, lastState[resource])) {
+            return;
+        }
+
+        const CompiledPass &producer = m_plan.passes[previous];
+        if (!IsQueueState(producer.queue, texture, lastState[resource]) ||
+            !IsQueueState(producer.queue, texture, state)) {
+            throw std::runtime_error("RenderPass '" + std::string(compiled.pass->GetName()) + "' inherits '" +
+                                     GetResourceName(resource) + "' in a state its queue cannot transition from");
+        }
+
+        const QueueBatch &batch = m_plan.batches[producer.batch];
+        m_plan.groups[batch.firstGroup + batch.groupCount - 1].handoffs.push_back({resource, state, request.range});
+        m_plan.plannedTransitionCount++;
+        lastState[resource] = state;
+    };
+
+    for (uint32_t passIndex = 0; passIndex < m_plan.passes.size(); ++passIndex) {
+        const auto &barriers = m_plan.passes[passIndex].barriers;
+
+        for (const auto &request: barriers) {
+            if (!ranged[request.resource]) {
+                passState[request.resource] = request.stateFlag;
+            }
+        }
+
+        for (const auto &request: barriers) {
+            uint32_t resource = request.resource;
+            if (ranged[resource]) {
+                checkQueueState(passIndex, request, request.stateFlag);
+                if (lastPass[resource] != None && lastState[resource] != request.stateFlag) {
+                    m_plan.plannedTransitionCount++;
+                }
+                lastPass[resource] = passIndex;
+                lastState[resource] = request.stateFlag;
+                continue;
+            }
+
+            uint32_t state = passState[resource];
+            if (state == None) {
+                continue; // Already handled for this pass
+            }
+            passState[resource] = None;
+            checkQueueState(passIndex, request, state);
+
+            uint32_t previous = lastPass[resource];
+            if (previous != None && lastState[resource] != state) {
+                m_plan.plannedTransitionCount++;
+            }
+
+            // A split transition must begin and end in the same command list
+            if (previous != None && lastState[resource] != state &&
+                m_plan.passes[previous].group == m_plan.passes[passIndex].group) {
+                const auto &batchPasses = m_plan.batches[m_plan.passes[passIndex].batch].passes;
+                uint32_t next = batchPasses[m_plan.passes[previous].batchPosition + 1];
+                if (next < passIndex) {
+                    m_plan.passes[next].splitBegins.push_back({resource, lastState[resource], state, passIndex});
+                }
+            }
+
+            lastPass[resource] = passIndex;
+            lastState[resource] = state;
+        }
+    }
+}
+
+void RenderGraph::AllocateResources() {
+    auto &currentFrame = m_frameResources[m_currentFrameIndex];
+    if (currentFrame.resources.size() < m_resources.size()) {
+        currentFrame.resources.resize(m_resources.size());
+    }
+
+    AllocateHeaps();
+
+    const TransientResourcePool::Statistics poolBefore = m_pool.GetStatistics();
+    uint64_t completedFenceValue = m_commandQueue->GetCompletedFenceValue();
+
+    // Placed resources are created once per frame slot, committed ones are borrowed from the pool
+    for (const auto &transient: m_plan.transients) {
+        const RenderPassResource desc = GetTransientDesc(transient);
+        if (transient.aliased) {
+            GetOrCreatePlacedResource(transient.resource, desc, currentFrame.heaps[transient.heap],
+                                      transient.heapOffset);
+        } else {
+            // Transients first used off graphics take only entries already in the state that use expects
+            uint32_t stateFlag = transient.queueStartState != UINT32_MAX ? transient.queueStartState
+                                                                           : TransientResourcePool::AnyState;
+            AcquirePooledResource(transient.resource, desc, completedFenceValue, stateFlag);
+        }
+    }
+
+    const TransientResourcePool::Statistics &poolAfter = m_pool.GetStatistics();
+    m_statistics.poolHits = static_cast<uint32_t>(poolAfter.hits - poolBefore.hits);
+    m_statistics.poolMisses = static_cast<uint32_t>(poolAfter.misses - poolBefore.misses);
+}
+
+void RenderGraph::ReleasePooledResources(uint64_t fenceValue) {
+    // The frame slot keeps only placed resources, pooled ones go back with the fence of this frame
+    for (auto &resource: m_frameResources[m_currentFrameIndex].resources) {
+        if (resource.poolEntry != TransientResourcePool::InvalidEntry) {
+            m_pool.Release(resource.poolEntry, resource.currentStateFlag, fenceValue);
+            resource = TransientResource{};
+        }
+    }
+}
+
+void RenderGraph::AllocateHeaps() {
+    auto &currentFrame = m_frameResources[m_currentFrameIndex];
+
+    // Heaps that no longer match the plan are released together with the resources placed in them.
+    // This frame slot's GPU work has completed, so it is safe to destroy them.
+    for (uint32_t i = 0; i < currentFrame.heaps.size(); ++i) {
+        Heap *heap = currentFrame.heaps[i];
+        if (!heap) {
+            continue;
+        }
+
+        bool matches = i < m_plan.heaps.size() &&
+                       heap->resourceClass == m_plan.heaps[i].resourceClass &&
+                       heap->size == m_plan.heaps[i].size;
+        if (!matches) {
+            ReleaseHeap(currentFrame, i);
+        }
+    }
+
+    currentFrame.heaps.resize(m_plan.heaps.size(), nullptr);
+
+    for (uint32_t i = 0; i < m_plan.heaps.size(); ++i) {
+        if (!currentFrame.heaps[i]) {
+            HeapCreateInfo heapCI{
+                .size = m_plan.heaps[i].size,
+                .resourceClass = m_plan.heaps[i].resourceClass,
+                .debugName = "RenderGraph Transient Heap"
+            };
+            currentFrame.heaps[i] = m_device->CreateHeap(heapCI);
+        }
+    }
+}
+
+void RenderGraph::ReleaseHeap(FrameTransientResources &frame, uint32_t heapIndex) {
+    Heap *heap = frame.heaps[heapIndex];
+
+    for (auto &resource: frame.resources) {
+        if (resource.heap == heap) {
+            DestroyTransient(resource);
+        }
+    }
+
+    m_device->DestroyHeap(heap);
+    frame.heaps[heapIndex] = nullptr;
+}
+
+void RenderGraph::ResolveResources() {
+    m_resolvedTextures.assign(m_resources.size(), nullptr);
+    m_resolvedBuffers.assign(m_resources.size(), nullptr);
+
+    for (uint32_t i = 0; i < m_resources.size(); ++i) {
+        const auto &entry = m_resources[i];
+        if (entry.isExternal) {
+            m_resolvedTextures[i] = entry.externalTexture;
+            m_resolvedBuffers[i] = entry.externalBuffer;
+        }
+    }
+
+    for (const auto &transient: m_plan.transients) {
+        const auto &resource = m_frameResources[m_currentFrameIndex].resources[transient.resource];
+        m_resolvedTextures[transient.resource] = resource.texture;
+        m_resolvedBuffers[transient.resource] = resource.buffer;
+    }
+}
+
+TextureCreateInfo RenderGraph::BuildTextureCreateInfo(const RenderPassResource &desc) {
+    TextureCreateInfo textureCI{
+        .width = desc.width,
+        .height = desc.height,
+        .depth = 1,
+        .mipLevels = static_cast<uint16_t>(desc.mipLevels),
+        .arraySize = 1,
+        .format = TextureFormat::Undefined,
+        .usage = (TextureUsage) desc.stateFlag
+    };
+
+    // Map format
+    switch (desc.format) {
+        case RenderPassResource::Format::RGBA8:
+            textureCI.format = TextureFormat::RGBA8_UNORM;
+            break;
+        case RenderPassResource::Format::RGBA16F:
+            textureCI.format = TextureFormat::RGBA16_FLOAT;
+            break;
+        case RenderPassResource::Format::RGBA32F:
+            textureCI.format = TextureFormat::RGBA32_FLOAT;
+            break;
+        case RenderPassResource::Format::Depth32:
+            textureCI.format = TextureFormat::Depth32;
+            break;
+        case RenderPassResource::Format::R32:
+            textureCI.format = TextureFormat::R32_FLOAT;
+            break;
+        default:
+            throw std::runtime_error("RenderGraph: texture format has no device format");
+    }
+
+    return textureCI;
+}
+
+BufferCreateInfo RenderGraph::BuildBufferCreateInfo(const RenderPassResource &desc) {
+    BufferCreateInfo bufferInfo{};
+    bufferInfo.size = desc.size;
+    bufferInfo.stride = sizeof(uint32_t);
+    bufferInfo.usage = BufferUsage::Storage;
+    bufferInfo.memoryType = MemoryType::GPU;
+
+    return bufferInfo;
+}
+
+RenderPassResource RenderGraph::GetTransientDesc(const TransientDeclaration &transient) const {
+    RenderPassResource desc = m_passes[transient.declarationIndex]->GetOutputs()[transient.outputIndex];
+
+    // Scaled textures are allocated once at the largest render scale and rendered into in part
+    float scale = desc.scaled ? m_maxRenderScale : 1.0f;
+    if (desc.downscalable) {
+        scale *= m_plan.resolutionScale;
+    }
+    if (scale != 1.0f) {
+        desc.width = std::max(static_cast<uint32_t>(std::ceil(static_cast<float>(desc.width) * scale)), 1u);
+        desc.height = std::max(static_cast<uint32_t>(std::ceil(static_cast<float>(desc.height) * scale)), 1u);
+    }
+    return desc;
+}
+
+ResourceAllocationInfo RenderGraph::GetAllocationInfo(const RenderPassResource &desc) const {
+    if (desc.type == RenderPassResource::Type::Texture) {
+        return m_device->GetTextureAllocationInfo(BuildTextureCreateInfo(desc));
+    }
+    return m_device->GetBufferAllocationInfo(BuildBufferCreateInfo(desc));
+}
+
+void RenderGraph::CalculateResourceLifetimes() {
+    std::vector<TransientDeclaration *> transients(m_resources.size(), nullptr);
+    for (auto &transient: m_plan.transients) {
+        transient.firstUse = UINT32_MAX;
+        transient.lastUse = 0;
+        transients[transient.resource] = &transient;
+    }
+
+    // Calculate first and last use for each resource
+    for (const auto &compiled: m_plan.passes) {
+        uint32_t passIndex = compiled.index;
+
+        auto extend = [&](uint32_t resource) {
+            TransientDeclaration *transient = transients[resource];
+            if (transient) {
+                transient->firstUse = std::min(transient->firstUse, passIndex);
+                transient->lastUse = std::max(transient->lastUse, passIndex);
+            }
+        };
+
+        for (const auto &input: compiled.pass->GetInputs()) {
+            extend(input.resource);
+        }
+
+        for (const auto &output: compiled.pass->GetOutputs()) {
+            extend(output.resource);
+        }
+    }
+}
+
+void RenderGraph::BuildAttachmentPlan() {
+    std::vector<const TransientDeclaration *> transients(m_resources.size(), nullptr);
+    for (const auto &transient: m_plan.transients) {
+        transients[transient.resource] = &transient;
+    }
+
+    for (auto &compiled: m_plan.passes) {
+        compiled.attachments.clear();
+        if (compiled.queue != QueueType::Graphics) {
+            continue;
+        }
+
+        const auto &outputs = compiled.pass->GetOutputs();
+
+        // The callback binds its targets itself, ops it declared would never be applied
+        if (compiled.pass->HasManualAttachments()) {
+            for (const auto &output: outputs) {
+                if (output.loadOp != AttachmentLoadOp::Load || output.storeOp != AttachmentStoreOp::Store) {
+                    throw std::runtime_error("RenderPass '" + std::string(compiled.pass->GetName()) +
+                                             "' sets load/store ops but binds its own attachments");
+                }
+            }
+            continue;
+        }
+
+        uint32_t colorCount = 0;
+        uint32_t depthCount = 0;
+        bool ranged = false;
+
+        for (uint32_t outputIndex = 0; outputIndex < outputs.size(); ++outputIndex) {
+            const auto &output = outputs[outputIndex];
+            TextureUsage state = (TextureUsage) output.stateFlag;
+            if (output.type != RenderPassResource::Type::Texture ||
+                (state != TextureUsage::RenderTarget && state != TextureUsage::DepthStencil)) {
+                continue;
+            }
+
+            // Views of a single mip or slice are bound by the pass itself
+            if (!output.range.IsWhole()) {
+                if (output.loadOp != AttachmentLoadOp::Load || output.storeOp != AttachmentStoreOp::Store) {
+                    throw std::runtime_error("RenderPass '" + std::string(compiled.pass->GetName()) +
+                                             "' sets load/store ops on a subresource range");
+                }
+                ranged = true;
+                continue;
+            }
+
+            AttachmentBinding binding{
+                .resource = output.resource,
+                .outputIndex = outputIndex,
+                .loadOp = output.loadOp,
+                .storeOp = output.storeOp,
+                .depthStencil = state == TextureUsage::DepthStencil,
+            };
+
+            // A transient holds nothing before its first use and nothing reads it after its last
+            const TransientDeclaration *transient = transients[output.resource];
+            if (transient) {
+                binding.scaled = m_passes[transient->declarationIndex]->GetOutputs()[transient->outputIndex].scaled;
+            }
+            if (transient && output.resource != m_presentTarget) {
+                if (binding.loadOp == AttachmentLoadOp::Load && transient->firstUse == compiled.index) {
+                    binding.loadOp = AttachmentLoadOp::DontCare;
+                }
+                if (transient->lastUse == compiled.index) {
+                    binding.storeOp = AttachmentStoreOp::Discard;
+                }
+            }
+
+            (binding.depthStencil ? depthCount : colorCount)++;
+            compiled.attachments.push_back(binding);
+        }
+
+        if (colorCount > MaxColorAttachments || depthCount > 1) {
+            throw std::runtime_error("RenderPass '" + std::string(compiled.pass->GetName()) +
+                                     "' writes more render targets than can be bound at once");
+        }
+
+        if (ranged) {
+            compiled.attachments.clear();
+        }
+    }
+}
+
+void RenderGraph::EstimatePeakTransientMemory() {
+    // Bytes alive at each pass if every transient got its own allocation. Aliasing can get close
+    // to this peak but never below it, so a schedule that lowers it gives aliasing more room.
+    std::vector<int64_t> delta(m_plan.passes.size() + 1, 0);
+    for (auto &transient: m_plan.transients) {
+        const RenderPassResource desc = GetTransientDesc(transient);
+        ResourceAllocationInfo allocation = GetAllocationInfo(desc);
+        transient.allocationSize = allocation.size;
+        transient.alignment = allocation.alignment;
+
+        if (transient.firstUse > transient.lastUse) {
+            continue;
+        }
+
+        int64_t size = static_cast<int64_t>(allocation.size);
+        delta[transient.firstUse] += size;
+        delta[transient.lastUse + 1] -= size;
+    }
+
+    int64_t alive = 0;
+    int64_t peak = 0;
+    uint32_t peakPass = 0;
+    for (uint32_t pass = 0; pass < m_plan.passes.size(); ++pass) {
+        alive += delta[pass];
+        if (alive > peak) {
+            peak = alive;
+            peakPass = pass;
+        }
+    }
+
+    m_plan.peakTransientBytes = static_cast<uint64_t>(peak);
+    m_plan.peakTransientPass = peakPass;
+}
+
+void RenderGraph::AliasResources() {
+    struct Placement {
+        uint32_t transient;
+        uint64_t offset;
+        uint64_t end;
+    };
+
+    // Heap memory split into disjoint ranges, each keyed by offset with the transient placed there last
+    struct Segment {
+        uint64_t end;
+        uint32_t transient;
+    };
+
+    struct HeapState {
+        std::map<uint64_t, uint64_t> freeRanges{{0, UINT64_MAX}}; // Offset to end, free at the current pass
+        std::multimap<uint32_t, Placement> expiries; // Live resources by last use
+        std::map<uint64_t, Segment> segments;
+    };
+
+    // Passes on another queue can overlap any graphics pass, so lifetimes in compiled order do not
+    // hold for resources they touch. Those stay committed.
+    std::vector<bool> usedAsync(m_resources.size(), false);
+    for (const auto &compiled: m_plan.passes) {
+        if (compiled.queue == QueueType::Graphics) {
+            continue;
+        }
+        for (const auto &input: compiled.pass->GetInputs()) {
+            usedAsync[input.resource] = true;
+        }
+        for (const auto &output: compiled.pass->GetOutputs()) {
+            usedAsync[output.resource] = true;
+        }
+    }
+
+    // Allocation requirements per transient, sizes were queried by EstimatePeakTransientMemory
+    std::vector<ResourceAllocationInfo> allocations(m_plan.transients.size());
+    std::vector<HeapResourceClass> classes(m_plan.transients.size());
+    for (uint32_t i = 0; i < m_plan.transients.size(); ++i) {
+        const auto &transient = m_plan.transients[i];
+        const auto &desc = m_passes[transient.declarationIndex]->GetOutputs()[transient.outputIndex];
+        allocations[i] = {transient.allocationSize, transient.alignment};
+        classes[i] = GetHeapResourceClass(desc);
+    }
+
+    // Sweep passes in order of first use, larger resources first within a pass. Resources whose last
+    // use lies before the current first use give their memory back to the free ranges, so placement
+    // only sees resources alive at the same time.
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < m_plan.transients.size(); ++i) {
+        if (!usedAsync[m_plan.transients[i].resource]) {
+            order.push_back(i);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        const auto &ta = m_plan.transients[a];
+        const auto &tb = m_plan.transients[b];
+        if (ta.firstUse != tb.firstUse) {
+            return ta.firstUse < tb.firstUse;
+        }
+        return allocations[a].size > allocations[b].size;
+    });
+
+    // One heap per resource class; resources of different classes can never share memory
+    std::vector<HeapState> heaps;
+
+    // A resource sharing memory with any other resource takes ownership with an aliasing barrier
+    // at its first use. This also covers the previous frame on this slot, which used the same heap.
+    std::vector<bool> sharesMemory(m_plan.transients.size(), false);
+
+    for (uint32_t index: order) {
+        auto &transient = m_plan.transients[index];
+        const ResourceAllocationInfo &allocation = allocations[index];
+
+        uint32_t heapIndex = 0;
+        while (heapIndex < m_plan.heaps.size() && m_plan.heaps[heapIndex].resourceClass != classes[index]) {
+            heapIndex++;
+        }
+        if (heapIndex == m_plan.heaps.size()) {
+            m_plan.heaps.push_back({classes[index], 0});
+            heaps.emplace_back();
+        }
+        HeapState &heap = heaps[heapIndex];
+
+        // Memory of resources that died before this one is free again, merged with its neighbours
+        while (!heap.expiries.empty() && heap.expiries.begin()->first < transient.firstUse) {
+            const Placement expired = heap.expiries.begin()->second;
+            heap.expiries.erase(heap.expiries.begin());
+
+            uint64_t begin = expired.offset;
+            uint64_t end = expired.end;
+            auto next = heap.freeRanges.lower_bound(begin);
+            if (next != heap.freeRanges.end() && next->first == end) {
+                end = next->second;
+                next = heap.freeRanges.erase(next);
+            }
+            if (next != heap.freeRanges.begin()) {
+                auto previous = std::prev(next);
+                if (previous->second == begin) {
+                    begin = previous->first;
+                    heap.freeRanges.erase(previous);
+                }
+            }
+            heap.freeRanges.emplace(begin, end);
+        }
+
+        // First fit: lowest aligned offset in a free range. The last range is unbounded.
+        auto range = heap.freeRanges.begin();
+        uint64_t offset = AlignUp(range->first, allocation.alignment);
+        while (offset + allocation.size > range->second) {
+            ++range;
+            offset = AlignUp(range->first, allocation.alignment);
+        }
+        const Placement placement{index, offset, offset + allocation.size};
+
+        const uint64_t rangeBegin = range->first;
+        const uint64_t rangeEnd = range->second;
+        heap.freeRanges.erase(range);
+        if (rangeBegin < offset) {
+            heap.freeRanges.emplace(rangeBegin, offset);
+        }
+        if (placement.end < rangeEnd) {
+            heap.freeRanges.emplace(placement.end, rangeEnd);
+        }
+        heap.expiries.emplace(transient.lastUse, placement);
+
+        // Every resource placed in this range before shares memory with this one. Earlier owners of a
+        // segment were marked when it was taken from them, so only the current owners are marked here.
+        auto segment = heap.segments.lower_bound(offset);
+        if (segment != heap.segments.begin()) {
+            auto previous = std::prev(segment);
+            if (previous->second.end > offset) {
+                segment = previous;
+            }
+        }
+        while (segment != heap.segments.end() && segment->first < placement.end) {
+            const uint64_t segmentOffset = segment->first;
+            const Segment owner = segment->second;
+            sharesMemory[owner.transient] = true;
+            sharesMemory[index] = true;
+
+            segment = heap.segments.erase(segment);
+            // Keep the parts of the segment outside the new placement
+            if (segmentOffset < offset) {
+                heap.segments.emplace(segmentOffset, Segment{offset, owner.transient});
+            }
+            if (owner.end > placement.end) {
+                segment = heap.segments.emplace(placement.end, Segment{owner.end, owner.transient}).first;
+            }
+        }
+        heap.segments.emplace(offset, Segment{placement.end, index});
+
+        transient.aliased = true;
+        transient.heap = heapIndex;
+        transient.heapOffset = offset;
+
+        m_plan.heaps[heapIndex].size = std::max(m_plan.heaps[heapIndex].size, placement.end);
+    }
+
+    for (uint32_t index: order) {
+        if (sharesMemory[index]) {
+            const auto &transient = m_plan.transients[index];
+            m_plan.passes[transient.firstUse].aliasActivations.push_back(transient.resource);
+        }
+    }
+}
+
+void RenderGraph::ResolveBarriers() {
+    m_pendingSplitStates.assign(m_resources.size(), UINT32_MAX);
+    m_uavHazards.assign(m_resources.size(), UavHazard::None);
+
+    m_passBarriers.resize(m_plan.passes.size());
+    m_passDiscards.resize(m_plan.passes.size());
+    m_groupEndBarriers.resize(m_plan.groups.size());
+
+    for (uint32_t i = 0; i < m_plan.passes.size(); ++i) {
+        m_passBarriers[i].clear();
+        m_passDiscards[i].clear();
+    }
+
+    for (uint32_t groupIndex = 0; groupIndex < m_plan.groups.size(); ++groupIndex) {
+        const RecordGroup &group = m_plan.groups[groupIndex];
+        const auto &batchPasses = m_plan.batches[group.batch].passes;
+        m_barrierQueue = m_plan.batches[group.batch].queue;
+
+        for (uint32_t i = group.begin; i < group.end; ++i) {
+            if (m_autoBarriers) {
+                InsertBarriers(batchPasses[i]);
+            }
+        }
+
+        // Normally a no-op, splits always end at a consumer in the same group
+        EndPendingSplitBarriers();
+
+        if (m_autoBarriers) {
+            for (const auto &handoff: group.handoffs) {
+                QueueTransition(handoff.resource, handoff.stateFlag, handoff.range);
+            }
+        }
+
+        // The plan always ends with a graphics batch. Transients first used off graphics go back to
+        // the state that use expects, so the pool hands them out in it next frame.
+        if (groupIndex + 1 == m_plan.groups.size()) {
+            CollapseSubresourceStates();
+
+            for (const auto &transient: m_plan.transients) {
+                if (m_autoBarriers && transient.queueStartState != UINT32_MAX) {
+                    QueueTransition(transient.resource, transient.queueStartState);
+                }
+            }
+        }
+
+        if (groupIndex + 1 == m_plan.groups.size() &&
+            m_presentTarget != RenderGraphTextureHandle::InvalidIndex &&
+            m_resources[m_presentTarget].isExternal &&
+            m_resources[m_presentTarget].type == RenderPassResource::Type::Texture) {
+            TransitionExternalResource(m_presentTarget, (uint32_t) TextureUsage::Present);
+        }
+
+        m_groupEndBarriers[groupIndex].clear();
+        FlushBarriers(m_groupEndBarriers[groupIndex]);
+    }
+
+    m_barrierQueue = QueueType::Graphics;
+}
+
+void RenderGraph::InsertBarriers(uint32_t passIndex) {
+    const auto &compiled = m_plan.passes[passIndex];
+
+    // Aliased resources take over their memory before any transition
+    for (uint32_t resourceIndex: compiled.aliasActivations) {
+        TransientResource *resource = GetCurrentFrameResource(resourceIndex);
+        if (!resource) {
+            continue;
+        }
+
+        m_barrierBatch.push_back(resource->type == TransientResource::Type::Texture
+                                     ? ResourceBarrier::Aliasing(resource->texture)
+                                     : ResourceBarrier::Aliasing(resource->buffer));
+        m_statistics.aliasingBarrierCount++;
+    }
+
+    // Checked before the transitions, which order earlier unordered writes themselves
+    QueueUavBarriers(compiled);
+
+    for (const auto &request: compiled.barriers) {
+        QueueTransition(request.resource, request.stateFlag, request.range);
+    }
+
+    TrackUavWrites(compiled);
+
+    BeginSplitBarriers(compiled);
+
+    // Every barrier the pass needs goes out in one call
+    FlushBarriers(m_passBarriers[passIndex]);
+
+    // Memory handed over by an aliasing barrier holds garbage, render targets and depth must be discarded
+    for (uint32_t resourceIndex: compiled.aliasActivations) {
+        TransientResource *resource = GetCurrentFrameResource(resourceIndex);
+        if (!resource || resource->type != TransientResource::Type::Texture) {
+            continue;
+        }
+
+        TextureUsage state = (TextureUsage) resource->currentStateFlag;
+        if (state != TextureUsage::RenderTarget && state != TextureUsage::DepthStencil) {
+            continue;
+        }
+
+        // A clear or DontCare load of the attachment initializes the memory already
+        bool initialized = std::any_of(compiled.attachments.begin(), compiled.attachments.end(),
+                                       [&](const AttachmentBinding &binding) {
+                                           return binding.resource == resourceIndex &&
+                                                  binding.loadOp != AttachmentLoadOp::Load;
+                                       });
+        if (!initialized) {
+            m_passDiscards[passIndex].push_back(resource->texture);
+        }
+    }
+}
+
+void RenderGraph::TransitionExternalResource(uint32_t resourceIndex, uint32_t newState) {
+    if (IsExternalResource(resourceIndex)) {
+        QueueTransition(resourceIndex, newState);
+    }
+}
+
+uint32_t *RenderGraph::GetTrackedState(uint32_t resourceIndex, Texture **texture, Buffer **buffer,
+                                       std::vector<uint32_t> **subresourceStates) {
+    if (IsExternalResource(resourceIndex)) {
+        auto &resource = m_resources[resourceIndex];
+        *texture = resource.externalTexture;
+        *buffer = resource.externalBuffer;
+        if (subresourceStates) {
+            *subresourceStates = &resource.subresourceStates;
+        }
+        return &resource.currentStateFlag;
+    }
+
+    TransientResource *resource = GetCurrentFrameResource(resourceIndex);
+    if (!resource) {
+        return nullptr;
+    }
+
+    *texture = resource->texture;
+    *buffer = resource->buffer;
+    if (subresourceStates) {
+        *subresourceStates = &resource->subresourceStates;
+    }
+    return &resource->currentStateFlag;
+}
+
+void RenderGraph::BeginSplitBarriers(const CompiledPass &compiled) {
+    if (!m_splitBarriers || !m_device->SupportsSplitBarriers()) {
+        return;
+    }
+
+    for (const auto &split: compiled.splitBegins) {
+        Texture *texture = nullptr;
+        Buffer *buffer = nullptr;
+        std::vector<uint32_t> *subresourceStates = nullptr;
+        uint32_t *currentStateFlag = GetTrackedState(split.resource, &texture, &buffer, &subresourceStates);
+
+        // The planned previous state can differ at runtime, e.g. an external resource registered in another state
+        if (!currentStateFlag || *currentStateFlag != split.stateBefore || !subresourceStates->empty() ||
+            m_pendingSplitStates[split.resource] != UINT32_MAX) {
+            continue;
+        }
+
+        ResourceBarrier barrier;
+        barrier.texture = texture;
+        barrier.buffer = buffer;
+        barrier.stateBefore = split.stateBefore;
+        barrier.stateAfter = split.stateAfter;
+        barrier.split = ResourceBarrier::Split::Begin;
+        m_barrierBatch.push_back(barrier);
+
+        m_pendingSplitStates[split.resource] = split.stateAfter;
+        m_uavHazards[split.resource] = UavHazard::None;
+    }
+}
+
+void RenderGraph::QueueUavBarriers(const CompiledPass &compiled) {
+    for (const auto &use: compiled.unorderedAccesses) {
+        UavHazard &hazard = m_uavHazards[use.resource];
+        if (hazard == UavHazard::None) {
+            continue;
+        }
+
+        // Non-overlapping uses after non-overlapping writes can run concurrently
+        if (hazard == UavHazard::NonOverlappingWrite && use.nonOverlapping) {
+            m_statistics.skippedUavBarrierCount++;
+            continue;
+        }
+
+        Texture *texture = nullptr;
+        Buffer *buffer = nullptr;
+        if (!GetTrackedState(use.resource, &texture, &buffer)) {
+            continue;
+        }
+
+        m_barrierBatch.push_back(texture ? ResourceBarrier::UAV(texture) : ResourceBarrier::UAV(buffer));
+        hazard = UavHazard::None;
+    }
+}
+
+void RenderGraph::TrackUavWrites(const CompiledPass &compiled) {
+    for (const auto &use: compiled.unorderedAccesses) {
+        if (!use.write) {
+            continue;
+        }
+
+        // A skipped barrier leaves the earlier writes pending, so the hazard stays non-overlapping
+        // only while every pending write is
+        UavHazard &hazard = m_uavHazards[use.resource];
+        hazard = use.nonOverlapping && hazard != UavHazard::Write ? UavHazard::NonOverlappingWrite : UavHazard::Write;
+    }
+}
+
+void RenderGraph::QueueTransition(uint32_t resourceIndex, uint32_t newStateFlag, const SubresourceRange &range) {
+    Texture *texture = nullptr;
+    Buffer *buffer = nullptr;
+    std::vector<uint32_t> *subresourceStates = nullptr;
+    uint32_t *currentStateFlag = GetTrackedState(resourceIndex, &texture, &buffer, &subresourceStates);
+    if (!currentStateFlag) {
+        return;
+    }
+
+    // Complete a transition begun earlier, then continue from its target state
+    uint32_t &pendingState = m_pendingSplitStates[resourceIndex];
+    if (pendingState != UINT32_MAX) {
+        ResourceBarrier barrier;
+        barrier.texture = texture;
+        barrier.buffer = buffer;
+        barrier.stateBefore = *currentStateFlag;
+        barrier.stateAfter = pendingState;
+        barrier.split = ResourceBarrier::Split::End;
+        m_barrierBatch.push_back(barrier);
+
+        *currentStateFlag = pendingState;
+        pendingState = UINT32_MAX;
+    }
+
+    // Buffers have a single subresource
+    uint32_t mipLevels = texture ? std::max(texture->mipLevels, 1u) : 1;
+    uint32_t arraySize = texture ? std::max(texture->arraySize, 1u) : 1;
+    auto rangeEnd = [](uint32_t base, uint32_t count, uint32_t size) {
+        return count >= size - std::min(base, size) ? size : base + count;
+    };
+
+    uint32_t mipBegin = std::min(range.baseMip, mipLevels);
+    uint32_t mipEnd = rangeEnd(range.baseMip, range.mipCount, mipLevels);
+    uint32_t sliceBegin = std::min(range.baseSlice, arraySize);
+    uint32_t sliceEnd = rangeEnd(range.baseSlice, range.sliceCount, arraySize);
+    bool whole = mipBegin == 0 && mipEnd == mipLevels && sliceBegin == 0 && sliceEnd == arraySize;
+
+    if (subresourceStates->empty()) {
+        if (*currentStateFlag == newStateFlag) {
+            return;
+        }
+
+        if (whole) {
+            QueueBarrier(resourceIndex, texture, buffer, *currentStateFlag, newStateFlag);
+            *currentStateFlag = newStateFlag;
+            m_uavHazards[resourceIndex] = UavHazard::None; // The transition orders earlier unordered writes
+            return;
+        }
+
+        subresourceStates->assign(mipLevels * arraySize, *currentStateFlag);
+    }
+
+    // Only the subresources the pass uses are transitioned, the rest keep their state
+    for (uint32_t slice = sliceBegin; slice < sliceEnd; ++slice) {
+        for (uint32_t mip = mipBegin; mip < mipEnd; ++mip) {
+            uint32_t subresource = mip + slice * mipLevels;
+            uint32_t &state = (*subresourceStates)[subresource];
+            if (state != newStateFlag) {
+                QueueBarrier(resourceIndex, texture, buffer, state, newStateFlag, subresource);
+                state = newStateFlag;
+            }
+        }
+    }
+
+    *currentStateFlag = newStateFlag;
+
+    // Back to a single tracked state once every subresource agrees
+    if (std::all_of(subresourceStates->begin(), subresourceStates->end(),
+                    [&](uint32_t state) { return state == newStateFlag; })) {
+        subresourceStates->clear();
+    }
+}
+
+void RenderGraph::QueueBarrier(uint32_t resource, Texture *texture, Buffer *buffer, uint32_t stateBefore,
+                               uint32_t stateAfter, uint32_t subresource) {
+    // The compiler keeps planned states legal, an external registered in a graphics only state is not
+    if (!IsQueueState(m_barrierQueue, texture != nullptr, stateBefore) ||
+        !IsQueueState(m_barrierQueue, texture != nullptr, stateAfter)) {
+        throw std::runtime_error("RenderGraph: '" + GetResourceName(resource) +
+                                 "' needs a transition its queue cannot record, use it on graphics first");
+    }
+
+    if (m_batchWholeBarriers.size() < m_resources.size()) {
+        m_batchWholeBarriers.resize(m_resources.size(), UINT32_MAX);
+        m_batchSubresourceCounts.resize(m_resources.size(), 0);
+    }
+
+    // A resource requested in several states by one batch gets a single transition per subresource,
+    // to the last state
+    uint32_t &whole = m_batchWholeBarriers[resource];
+    uint32_t &subresourceCount = m_batchSubresourceCounts[resource];
+    if (whole == UINT32_MAX && subresourceCount == 0) {
+        m_batchResources.push_back(resource);
+    }
+
+    if (subresource == ResourceBarrier::AllSubresources) {
+        if (whole != UINT32_MAX) {
+            m_barrierBatch[whole].stateAfter = stateAfter;
+            return;
+        }
+
+        if (subresourceCount == 0) {
+            whole = static_cast<uint32_t>(m_barrierBatch.size());
+            ResourceBarrier barrier;
+            barrier.texture = texture;
+            barrier.buffer = buffer;
+            barrier.stateBefore = stateBefore;
+            barrier.stateAfter = stateAfter;
+            m_barrierBatch.push_back(barrier);
+            return;
+        }
+
+        // Some subresources were already transitioned in this batch, every one continues to the new state
+        const uint32_t total = std::max(texture->mipLevels, 1u) * std::max(texture->arraySize, 1u);
+        for (uint32_t i = 0; i < total; ++i) {
+            QueueSubresourceBarrier(resource, texture, stateBefore, stateAfter, i);
+        }
+        return;
+    }
+
+    // Split the whole-resource transition so the subresource can continue from it
+    if (whole != UINT32_MAX) {
+        const ResourceBarrier barrier = m_barrierBatch[whole];
+        const uint32_t total = std::max(texture->mipLevels, 1u) * std::max(texture->arraySize, 1u);
+
+        m_barrierBatch[whole].subresource = 0;
+        m_batchSubresourceBarriers[(uint64_t) resource << 32] = whole;
+        for (uint32_t i = 1; i < total; ++i) {
+            m_batchSubresourceBarriers[(uint64_t) resource << 32 | i] = static_cast<uint32_t>(m_barrierBatch.size());
+            m_barrierBatch.push_back(barrier);
+            m_barrierBatch.back().subresource = i;
+        }
+        subresourceCount = total;
+        whole = UINT32_MAX;
+    }
+
+    QueueSubresourceBarrier(resource, texture, stateBefore, stateAfter, subresource);
+}
+
+void RenderGraph::QueueSubresourceBarrier(uint32_t resource, Texture *texture, uint32_t stateBefore,
+                                          uint32_t stateAfter, uint32_t subresource) {
+    auto [entry, inserted] = m_batchSubresourceBarriers.try_emplace((uint64_t) resource << 32 | subresource,
+                                                                    static_cast<uint32_t>(m_barrierBatch.size()));
+    if (!inserted) {
+        m_barrierBatch[entry->second].stateAfter = stateAfter;
+        return;
+    }
+
+    ResourceBarrier barrier;
+    barrier.texture = texture;
+    barrier.stateBefore = stateBefore;
+    barrier.stateAfter = stateAfter;
+    barrier.subresource = subresource;
+    m_barrierBatch.push_back(barrier);
+    m_batchSubresourceCounts[resource]++;
+}
+
+void RenderGraph::CollapseBatchedSubresources() {
+    // Every subresource moving between the same two states is one whole-resource transition. The
+    // others are folded back to their starting state so FlushBarriers drops them.
+    for (uint32_t resource: m_batchResources) {
+        const uint32_t count = m_batchSubresourceCounts[resource];
+        m_batchWholeBarriers[resource] = UINT32_MAX;
+        m_batchSubresourceCounts[resource] = 0;
+        if (count < 2) {
+            continue;
+        }
+
+        auto first = m_batchSubresourceBarriers.find((uint64_t) resource << 32);
+        if (first == m_batchSubresourceBarriers.end()) {
+            continue;
+        }
+
+        ResourceBarrier &barrier = m_barrierBatch[first->second];
+        if (count != std::max(barrier.texture->mipLevels, 1u) * std::max(barrier.texture->arraySize, 1u)) {
+            continue;
+        }
+
+        bool uniform = true;
+        for (uint32_t i = 1; i < count && uniform; ++i) {
+            const ResourceBarrier &other = m_barrierBatch[m_batchSubresourceBarriers.at((uint64_t) resource << 32 | i)];
+            uniform = other.stateBefore == barrier.stateBefore && other.stateAfter == barrier.stateAfter;
+        }
+        if (!uniform) {
+            continue;
+        }
+
+        barrier.subresource = ResourceBarrier::AllSubresources;
+        for (uint32_t i = 1; i < count; ++i) {
+            ResourceBarrier &other = m_barrierBatch[m_batchSubresourceBarriers.at((uint64_t) resource << 32 | i)];
+            other.stateAfter = other.stateBefore;
+        }
+    }
+
+    m_batchResources.clear();
+    if (!m_batchSubresourceBarriers.empty()) {
+        m_batchSubresourceBarriers.clear();
+    }
+}
+
+void RenderGraph::CollapseSubresourceStates() {
+    // Pooled and external resources carry a single state between frames, so mixed subresource states
+    // end the frame in the state that was requested last
+    for (uint32_t i = 0; i < m_resources.size(); ++i) {
+        Texture *texture = nullptr;
+        Buffer *buffer = nullptr;
+        std::vector<uint32_t> *subresourceStates = nullptr;
+        uint32_t *currentStateFlag = GetTrackedState(i, &texture, &buffer, &subresourceStates);
+        if (currentStateFlag && !subresourceStates->empty()) {
+            QueueTransition(i, *currentStateFlag);
+        }
+    }
+}
+
+void RenderGraph::EndPendingSplitBarriers() {
+    for (uint32_t i = 0; i < m_pendingSplitStates.size(); ++i) {
+        if (m_pendingSplitStates[i] != UINT32_MAX) {
+            QueueTransition(i, m_pendingSplitStates[i]);
+        }
+    }
+}
+
+void RenderGraph::FlushBarriers(std::vector<ResourceBarrier> &barriers) {
+    CollapseBatchedSubresources();
+
+    // Drop transitions that were folded back to their starting state
+    std::erase_if(m_barrierBatch, [](const ResourceBarrier &barrier) {
+        return barrier.type == ResourceBarrier::Type::Transition && barrier.split == ResourceBarrier::Split::None &&
+               barrier.stateBefore == barrier.stateAfter;
+    });
+
+    if (m_barrierBatch.empty()) {
+        return;
+    }
+
+    for (const auto &barrier: m_barrierBatch) {
+        if (barrier.type == ResourceBarrier::Type::UAV) {
+            m_statistics.uavBarrierCount++;
+        }
+
+        if (barrier.type != ResourceBarrier::Type::Transition) {
+            continue;
+        }
+
+        if (barrier.subresource != ResourceBarrier::AllSubresources) {
+            m_statistics.subresourceBarrierCount++;
+        }
+
+        if (barrier.split == ResourceBarrier::Split::Begin) {
+            m_statistics.splitBarrierCount++;
+        } else if (barrier.split == ResourceBarrier::Split::None) {
+            m_statistics.fullBarrierCount++;
+        }
+    }
+
+    barriers.insert(barriers.end(), m_barrierBatch.begin(), m_barrierBatch.end());
+
+    m_statistics.barrierCount += static_cast<uint32_t>(m_barrierBatch.size());
+    m_statistics.barrierBatchCount++;
+
+    m_barrierBatch.clear();
+}
+
+QueueType RenderGraph::GetPassQueue(const RenderPass &pass) const {
+    return m_queues[(uint32_t) pass.GetQueue()].queue ? pass.GetQueue() : QueueType::Graphics;
+}
+
+uint32_t RenderGraph::GetQueueState(QueueType queue, const RenderPassResource &desc) {
+    if (queue != QueueType::Graphics && desc.type == RenderPassResource::Type::Texture &&
+        (TextureUsage) desc.stateFlag == TextureUsage::ShaderResource) {
+        return (uint32_t) TextureUsage::NonPixelShaderResource;
+    }
+    return desc.stateFlag;
+}
+
+CommandList *RenderGraph::AcquireCommandList(QueueType type, uint32_t listIndex) {
+    QueueContext &context = m_queues[(uint32_t) type];
+    auto &commandLists = context.commandLists[m_currentFrameIndex];
+
+    while (commandLists.size() <= listIndex) {
+        // Lists may be recorded at the same time, each needs its own allocator
+        auto commandList = std::unique_ptr<CommandList>(m_device->CreateCommandList(type));
+        context.queue->AssignCommandList(commandList.get(), m_currentFrameIndex,
+                                         static_cast<uint32_t>(commandLists.size()));
+        commandLists.push_back(std::move(commandList));
+    }
+
+    return commandLists[listIndex].get();
+}
+
+void RenderGraph::RecordPassGroup(uint32_t groupIndex) {
+    // Runs on worker threads: only reads the plan and the barriers resolved for this frame
+    const RecordGroup &group = m_plan.groups[groupIndex];
+    const QueueBatch &batch = m_plan.batches[group.batch];
+    CommandList *commandList = m_deferredRecording
+                                   ? static_cast<CommandList *>(m_groupStreams[groupIndex].get())
+                                   : m_groupCommandLists[groupIndex];
+
+    // Copy queues cannot bind descriptor heaps
+    commandList->Begin(batch.queue == QueueType::Transfer ? nullptr : m_device->GetBindlessManager());
+
+    TimestampFrame &timestamps = m_timestampFrames[m_currentFrameIndex];
+    bool nativeRenderPasses = m_nativeRenderPasses && m_deviceRenderPasses;
+
+    for (uint32_t i = group.begin; i < group.end; ++i) {
+        uint32_t passIndex = batch.passes[i];
+        const auto &compiledPass = m_plan.passes[passIndex];
+
+        // GPU time covers the pass' barriers, they are part of what it costs
+        uint32_t query = m_timestamps ? m_passQueries[passIndex] : InvalidQuery;
+        if (query != InvalidQuery) {
+            commandList->WriteTimestamp(timestamps.queryHeap, query);
+        }
+
+        const auto &barriers = m_passBarriers[passIndex];
+        if (!barriers.empty()) {
+            commandList->ResourceBarriers(barriers.data(), static_cast<uint32_t>(barriers.size()));
+        }
+
+        // Memory handed over by an aliasing barrier holds garbage
+        for (Texture *texture: m_passDiscards[passIndex]) {
+            commandList->DiscardTexture(texture);
+        }
+
+        BeginAttachments(compiledPass, commandList, nativeRenderPasses);
+
+        if (m_passTimings) {
+            auto start = std::chrono::high_resolution_clock::now();
+            ExecutePass(compiledPass, commandList);
+            m_passCpuTimes[passIndex] = std::chrono::duration<float, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+        } else {
+            ExecutePass(compiledPass, commandList);
+        }
+
+        EndAttachments(compiledPass, commandList, nativeRenderPasses);
+
+        if (query != InvalidQuery) {
+            commandList->WriteTimestamp(timestamps.queryHeap, query + 1);
+        }
+    }
+
+    const auto &endBarriers = m_groupEndBarriers[groupIndex];
+    if (!endBarriers.empty()) {
+        commandList->ResourceBarriers(endBarriers.data(), static_cast<uint32_t>(endBarriers.size()));
+    }
+
+    // Queries of a group are contiguous, one resolve copies them all
+    if (m_timestamps && m_groupQueryRanges[groupIndex * 2 + 1] > 0) {
+        uint32_t first = m_groupQueryRanges[groupIndex * 2];
+        commandList->ResolveQueries(timestamps.queryHeap, first, m_groupQueryRanges[groupIndex * 2 + 1],
+                                    timestamps.readback, first * sizeof(uint64_t));
+    }
+
+    commandList->End();
+}
+
+void RenderGraph::TranslatePassGroups() {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // Streams were recorded in full, each translates into its own list like recording did
+    const uint32_t groupCount = static_cast<uint32_t>(m_plan.groups.size());
+    m_groupTranslations.resize(groupCount);
+    auto translate = [this](uint32_t groupIndex) {
+        m_groupTranslations[groupIndex] = m_groupStreams[groupIndex]->GetStream().Translate(
+            m_groupCommandLists[groupIndex], true);
+    };
+    if (m_threadPool && groupCount > 1) {
+        m_threadPool->Dispatch(groupCount, translate);
+    } else {
+        for (uint32_t i = 0; i < groupCount; ++i) {
+            translate(i);
+        }
+    }
+
+    m_statistics.translateTime = std::chrono::duration<float, std::milli>(
+        std::chrono::high_resolution_clock::now() - startTime).count();
+    m_statistics.commandStreamBytes = 0;
+    m_statistics.commandStreamCommands = 0;
+    m_statistics.filteredStateCount = 0;
+    for (uint32_t i = 0; i < groupCount; ++i) {
+        m_statistics.commandStreamBytes += m_groupStreams[i]->GetStream().GetSize();
+        m_statistics.commandStreamCommands += m_groupStreams[i]->GetStream().GetCommandCount();
+        m_statistics.filteredStateCount += m_groupTranslations[i].filtered;
+    }
+}
+
+void RenderGraph::SubmitBatch(uint32_t batchIndex) {
+    const QueueBatch &batch = m_plan.batches[batchIndex];
+    QueueContext &context = m_queues[(uint32_t) batch.queue];
+
+    for (uint32_t wait: batch.waits) {
+        const QueueContext &producer = m_queues[(uint32_t) m_plan.batches[wait].queue];
+        context.queue->Wait(producer.fence.get(), m_batchSignalValues[wait]);
+        m_statistics.crossQueueWaitCount++;
+    }
+
+    // All groups of the batch go out in one submission, in pass order
+    context.queue->Execute(&m_groupCommandLists[batch.firstGroup], batch.groupCount);
+    m_statistics.commandListCount += batch.groupCount;
+
+    if (batch.signal) {
+        m_batchSignalValues[batchIndex] = ++context.fenceValue;
+        context.fence->Signal(context.queue, context.fenceValue);
+    }
+}
+
+bool RenderGraph::ReadBackTimestamps() {
+    TimestampFrame &frame = m_timestampFrames[m_currentFrameIndex];
+    if (!frame.pending) {
+        return false;
+    }
+    frame.pending = false;
+
+    const auto *ticks = static_cast<const uint64_t *>(frame.readback->Map());
+    if (!ticks) {
+        return false;
+    }
+
+    float frameTime = 0.0f;
+
+    for (const auto &timed: frame.passes) {
+        uint64_t begin = ticks[timed.query];
+        uint64_t end = ticks[timed.query + 1];
+        uint64_t frequency = m_queues[(uint32_t) timed.queue].queue->GetTimestampFrequency();
+        if (end < begin || frequency == 0) {
+            continue;
+        }
+
+        float gpuTime = static_cast<float>(static_cast<double>(end - begin) * 1000.0 / static_cast<double>(frequency));
+        frameTime += gpuTime;
+
+        // Samples of a plan that has been replaced since only count towards the frame time
+        if (!m_passTimings || frame.planGeneration != m_passTimingGeneration) {
+            continue;
+        }
+
+        PassTiming &timing = m_statistics.passTimings[timed.pass];
+        timing.gpuTime = gpuTime;
+        timing.gpuAverage = timing.gpuSamples == 0
+                                ? gpuTime
+                                : timing.gpuAverage + (gpuTime - timing.gpuAverage) * TimingSmoothing;
+        timing.gpuSamples++;
+    }
+
+    frame.readback->Unmap();
+
+    m_statistics.gpuFrameTime = frameTime;
+    return true;
+}
+
+void RenderGraph::PrepareTimestamps() {
+    TimestampFrame &frame = m_timestampFrames[m_currentFrameIndex];
+
+    m_passQueries.assign(m_plan.passes.size(), InvalidQuery);
+    m_passCpuTimes.assign(m_plan.passes.size(), 0.0f);
+    m_groupQueryRanges.assign(m_plan.groups.size() * 2, 0);
+
+    // Copy queues have no timestamp support in the shared query heap, their passes are only timed on the CPU
+    uint32_t queryCount = 0;
+    uint32_t timedCount = 0;
+    for (uint32_t groupIndex = 0; groupIndex < m_plan.groups.size(); ++groupIndex) {
+        const RecordGroup &group = m_plan.groups[groupIndex];
+        const QueueBatch &batch = m_plan.batches[group.batch];
+
+        m_groupQueryRanges[groupIndex * 2] = queryCount;
+        if (batch.queue == QueueType::Transfer) {
+            continue;
+        }
+
+        for (uint32_t i = group.begin; i < group.end; ++i) {
+            uint32_t passIndex = batch.passes[i];
+            m_passQueries[passIndex] = queryCount;
+            queryCount += 2;
+            timedCount++;
+        }
+
+        m_groupQueryRanges[groupIndex * 2 + 1] = queryCount - m_groupQueryRanges[groupIndex * 2];
+    }
+
+    // This slot's previous frame has completed, so its heap and readback buffer can be replaced
+    if (frame.capacity < queryCount) {
+        ReleaseTimestampFrame(frame);
+
+        frame.capacity = std::max(queryCount, 64u);
+        frame.queryHeap = m_device->CreateQueryHeap({
+            .type = QueryType::Timestamp,
+            .count = frame.capacity,
+            .debugName = "RenderGraph Timestamps"
+        });
+        frame.readback = m_device->CreateBuffer({
+            .size = frame.capacity * sizeof(uint64_t),
+            .stride = sizeof(uint64_t),
+            .usage = BufferUsage::CopyDest,
+            .memoryType = MemoryType::Readback,
+            .debugName = "RenderGraph Timestamp Readback"
+        });
+    }
+
+    // Results are read back frames later, when the plan may have changed
+    frame.planGeneration = m_plan.generation;
+    frame.passes.resize(timedCount);
+    uint32_t timed = 0;
+    for (uint32_t passIndex = 0; passIndex < m_plan.passes.size(); ++passIndex) {
+        if (m_passQueries[passIndex] == InvalidQuery) {
+            continue;
+        }
 
-    sprintf_s(msg, "Transient Resources: %u\n", m_statistics.transientResourceCount);
-    printf(msg);
+        auto &entry = frame.passes[timed++];
+        entry.pass = passIndex;
+        entry.queue = m_plan.passes[passIndex].queue;
+        entry.query = m_passQueries[passIndex];
+    }
+
+    frame.pending = timedCount > 0;
+}
+
+void RenderGraph::RebuildPassTimings() {
+    // Passes that stay in the plan keep their averages, passes that left it are dropped
+    std::unordered_map<std::string_view, PassTiming *> previous;
+    for (auto &timing: m_statistics.passTimings) {
+        previous.emplace(timing.name, &timing);
+    }
+
+    std::vector<PassTiming> timings(m_plan.passes.size());
+    for (uint32_t passIndex = 0; passIndex < m_plan.passes.size(); ++passIndex) {
+        const auto &compiled = m_plan.passes[passIndex];
+        PassTiming &timing = timings[passIndex];
+
+        auto it = previous.find(compiled.pass->GetName());
+        if (it != previous.end()) {
+            timing = std::move(*it->second);
+            previous.erase(it);
+        } else {
+            timing.name = compiled.pass->GetName();
+        }
+        timing.queue = compiled.queue;
+    }
+
+    m_statistics.passTimings = std::move(timings);
+    m_passTimingGeneration = m_plan.generation;
+}
+
+const RenderGraph::PassTiming *RenderGraph::Statistics::FindPassTiming(std::string_view name) const {
+    auto it = std::find_if(passTimings.begin(), passTimings.end(), [&](const PassTiming &timing) {
+        return timing.name == name;
+    });
+    return it != passTimings.end() ? &*it : nullptr;
+}
+
+void RenderGraph::UpdatePassTimings() {
+    for (uint32_t passIndex = 0; passIndex < m_plan.passes.size(); ++passIndex) {
+        float cpuTime = m_passCpuTimes[passIndex];
+
+        PassTiming &timing = m_statistics.passTimings[passIndex];
+        timing.cpuTime = cpuTime;
+        timing.cpuAverage = timing.cpuSamples == 0
+                                ? cpuTime
+                                : timing.cpuAverage + (cpuTime - timing.cpuAverage) * TimingSmoothing;
+        timing.cpuSamples++;
+    }
+}
+
+void RenderGraph::ReleaseTimestampFrame(TimestampFrame &frame) {
+    if (frame.queryHeap) {
+        m_device->DestroyQueryHeap(frame.queryHeap);
+    }
+    if (frame.readback) {
+        m_device->DestroyBuffer(frame.readback);
+    }
+
+    frame = TimestampFrame{};
+}
+
+void RenderGraph::ExecutePass(const CompiledPass &compiledPass, CommandList *commandList) {
+    if (m_captureRecorder) {
+        CaptureCommandList captureList(commandList);
+        RenderPassContext context = BuildPassContext(&captureList);
+
+        compiledPass.pass->Execute(context);
+        m_captureRecorder->RecordPass(compiledPass.declarationIndex, captureList.GetStream());
+        return;
+    }
+
+    RenderPassContext context = BuildPassContext(commandList);
+
+    compiledPass.pass->Execute(context);
+}
+
+void RenderGraph::BeginCapture() {
+    m_captureRequested = false;
+    m_captureRecorder = std::make_unique<RenderGraphCaptureRecorder>();
+    RenderGraphCapture &capture = m_captureRecorder->GetCapture();
+
+    // Resolved resources first, so commands on them reference the resource and not this frame's object
+    for (uint32_t i = 0; i < m_resources.size(); ++i) {
+        const ResourceEntry &entry = m_resources[i];
+        bool isTexture = entry.type == RenderPassResource::Type::Texture;
+        m_captureRecorder->BindResource(i, isTexture
+                                               ? static_cast<const void *>(m_resolvedTextures[i])
+                                               : static_cast<const void *>(m_resolvedBuffers[i]));
+
+        RenderGraphCapture::Resource resource{
+            .name = entry.name,
+            .type = entry.type,
+            .isExternal = entry.isExternal,
+            .stateFlag = entry.currentStateFlag,
+        };
+        if (entry.isExternal && isTexture && entry.externalTexture) {
+            resource.object = m_captureRecorder->AddObject(entry.externalTexture);
+        } else if (entry.isExternal && !isTexture && entry.externalBuffer) {
+            resource.object = m_captureRecorder->AddObject(entry.externalBuffer);
+        }
+        capture.resources.push_back(std::move(resource));
+    }
+
+    // Every declared pass, so a replay culls and schedules exactly what this frame did
+    for (const auto &pass: m_passes) {
+        capture.passes.push_back({
+            .name = std::string(pass->GetName()),
+            .queue = pass->GetQueue(),
+            .enabled = pass->IsEnabled(),
+            .hasSideEffects = pass->HasSideEffects(),
+            .optional = pass->IsOptional(),
+            .manualAttachments = pass->HasManualAttachments(),
+            .inputs = {pass->GetInputs().begin(), pass->GetInputs().end()},
+            .outputs = {pass->GetOutputs().begin(), pass->GetOutputs().end()},
+        });
+    }
+
+    capture.presentTarget = m_presentTarget;
+}
+
+void RenderGraph::BeginAttachments(const CompiledPass &compiledPass, CommandList *commandList,
+                                   bool nativeRenderPass) {
+    if (compiledPass.attachments.empty()) {
+        return;
+    }
+
+    const auto &outputs = compiledPass.pass->GetOutputs();
+
+    if (nativeRenderPass) {
+        std::array<RenderPassAttachment, MaxColorAttachments> colors;
+        RenderPassAttachment depth;
+        RenderPassBeginInfo info{.colorAttachments = colors.data()};
+
+        for (const auto &binding: compiledPass.attachments) {
+            RenderPassAttachment &attachment = binding.depthStencil ? depth : colors[info.colorCount++];
+            attachment.texture = m_resolvedTextures[binding.resource];
+            attachment.loadOp = binding.loadOp;
+            attachment.storeOp = binding.storeOp;
+            attachment.clearValue = outputs[binding.outputIndex].clearValue;
+            if (binding.depthStencil) {
+                info.depthStencil = &depth;
+            }
+        }
+
+        commandList->BeginRenderPass(info);
+        SetScaledRenderArea(compiledPass, commandList);
+        return;
+    }
+
+    // Without render passes the load ops become clears and discards before binding the targets
+    std::array<Texture *, MaxColorAttachments> colors{};
+    uint32_t colorCount = 0;
+    Texture *depth = nullptr;
+
+    for (const auto &binding: compiledPass.attachments) {
+        Texture *texture = m_resolvedTextures[binding.resource];
+        const ClearValue &clearValue = outputs[binding.outputIndex].clearValue;
+
+        if (binding.loadOp == AttachmentLoadOp::Clear) {
+            if (binding.depthStencil) {
+                commandList->ClearDepthStencil(texture, clearValue.depth, clearValue.stencil);
+            } else {
+                commandList->ClearRenderTarget(texture, clearValue.color);
+            }
+        } else if (binding.loadOp == AttachmentLoadOp::DontCare) {
+            commandList->DiscardTexture(texture);
+        }
+
+        if (binding.depthStencil) {
+            depth = texture;
+        } else {
+            colors[colorCount++] = texture;
+        }
+    }
+
+    commandList->SetRenderTargets(colors.data(), colorCount, depth);
+    SetScaledRenderArea(compiledPass, commandList);
+}
+
+void RenderGraph::SetScaledRenderArea(const CompiledPass &compiledPass, CommandList *commandList) {
+    auto scaled = std::find_if(compiledPass.attachments.begin(), compiledPass.attachments.end(),
+                               [](const AttachmentBinding &binding) { return binding.scaled; });
+    if (scaled == compiledPass.attachments.end()) {
+        return;
+    }
+
+    // Scaled attachments bound together are declared at the same size, any of them gives the area
+    RenderPassContext context = BuildPassContext(commandList);
+    RenderGraphTextureHandle handle{.index = scaled->resource};
+    commandList->SetViewport(context.GetRenderViewport(handle));
+    commandList->SetScissor(context.GetRenderArea(handle));
+}
+
+void RenderGraph::EndAttachments(const CompiledPass &compiledPass, CommandList *commandList, bool nativeRenderPass) {
+    if (compiledPass.attachments.empty()) {
+        return;
+    }
+
+    if (nativeRenderPass) {
+        commandList->EndRenderPass();
+        return;
+    }
+
+    for (const auto &binding: compiledPass.attachments) {
+        if (binding.storeOp == AttachmentStoreOp::Discard) {
+            commandList->DiscardTexture(m_resolvedTextures[binding.resource]);
+        }
+    }
+}
+
+RenderPassContext RenderGraph::BuildPassContext(CommandList *commandList) {
+    RenderPassContext context;
+    context.commandList = commandList;
+    context.frameIndex = m_currentFrameIndex;
+    context.deltaTime = 0.016f; // Would get from timer
+    context.renderScale = m_maxRenderScale > 0.0f ? m_renderScale / m_maxRenderScale : 1.0f;
+
+    // Resources are resolved once per frame, passes index them by handle
+    context.textures = m_resolvedTextures.data();
+    context.buffers = m_resolvedBuffers.data();
+    context.resourceCount = static_cast<uint32_t>(m_resolvedTextures.size());
+
+    return context;
+}
+
+RenderGraphTextureHandle RenderGraph::RegisterExternalTexture(std::string_view name, Texture *texture,
+                                                              TextureUsage initialState) {
+    uint32_t index = DeclareResource(name, RenderPassResource::Type::Texture);
+
+    auto &resource = m_resources[index];
+    resource.isExternal = true;
+    resource.externalTexture = texture;
+    resource.initialStateFlag = (uint32_t) initialState;
+    resource.currentStateFlag = (uint32_t) initialState;
+    resource.subresourceStates.clear();
+
+    return RenderGraphTextureHandle{.index = index};
+}
+
+RenderGraphBufferHandle RenderGraph::RegisterExternalBuffer(std::string_view name, Buffer *buffer,
+                                                            BufferUsage initialState) {
+    uint32_t index = DeclareResource(name, RenderPassResource::Type::Buffer);
+
+    auto &resource = m_resources[index];
+    resource.isExternal = true;
+    resource.externalBuffer = buffer;
+    resource.initialStateFlag = (uint32_t) initialState;
+    resource.currentStateFlag = (uint32_t) initialState;
+
+    return RenderGraphBufferHandle{.index = index};
+}
+
+RenderGraphHistoryHandle RenderGraph::DeclareHistoryTexture(std::string_view name, const HistoryTextureDesc &desc) {
+    if (desc.versions < 2) {
+        throw std::runtime_error("History texture '" + std::string(name) + "' needs at least two versions");
+    }
+
+    WaitForCompile();
+
+    uint32_t index;
+    auto it = m_historyLookup.find(name);
+    if (it != m_historyLookup.end()) {
+        index = it->second;
+    } else {
+        index = static_cast<uint32_t>(m_histories.size());
+        m_histories.emplace_back();
+        m_historyLookup.emplace(name, index);
+    }
+
+    HistoryResource &history = m_histories[index];
+
+    // A second declaration in the same frame must not rotate again
+    if (history.declaredFrame == m_frameNumber) {
+        return RenderGraphHistoryHandle{.index = index};
+    }
+
+    // Every age has its own resource entry, so the handles and the plan hash stay the same each frame
+    while (history.resources.size() < desc.versions) {
+        std::string entryName(name);
+        if (!history.resources.empty()) {
+            entryName += "[-" + std::to_string(history.resources.size()) + "]";
+        }
+
+        uint32_t resource = DeclareResource(entryName, RenderPassResource::Type::Texture);
+        m_resources[resource].isExternal = true;
+        history.resources.push_back(resource);
+    }
+
+    if (history.poolEntries.empty() || !(history.desc == desc)) {
+        ReleaseHistory(history, m_lastFenceValue);
+        history.desc = desc;
+        AllocateHistory(history);
+    } else {
+        history.current = (history.current + 1) % desc.versions;
+    }
+
+    history.declaredFrame = m_frameNumber;
+    BindHistory(history);
+
+    return RenderGraphHistoryHandle{.index = index};
+}
+
+RenderGraphTextureHandle RenderGraph::GetHistoryVersion(RenderGraphHistoryHandle history, uint32_t age) const {
+    const HistoryResource &resource = m_histories[history.index];
+    if (age >= resource.desc.versions) {
+        throw std::runtime_error("History texture keeps fewer versions than requested");
+    }
+    return RenderGraphTextureHandle{.index = resource.resources[age]};
+}
+
+bool RenderGraph::IsHistoryValid(RenderGraphHistoryHandle history, uint32_t age) const {
+    const HistoryResource &resource = m_histories[history.index];
+    if (age >= resource.written.size()) {
+        return false;
+    }
+
+    uint32_t versions = resource.desc.versions;
+    return resource.written[(resource.current + versions - age) % versions];
+}
+
+void RenderGraph::ReleaseHistoryTexture(RenderGraphHistoryHandle history) {
+    WaitForCompile();
+    ReleaseHistory(m_histories[history.index], m_lastFenceValue);
+}
+
+void RenderGraph::AllocateHistory(HistoryResource &history) {
+    RenderPassResource desc{
+        .type = RenderPassResource::Type::Texture,
+        .stateFlag = static_cast<uint32_t>(history.desc.usage),
+        .width = history.desc.width,
+        .height = history.desc.height,
+        .mipLevels = history.desc.mipLevels,
+        .format = history.desc.format,
+    };
+    TextureCreateInfo createInfo = BuildTextureCreateInfo(desc);
+    uint64_t completedFenceValue = m_commandQueue->GetCompletedFenceValue();
+
+    for (uint32_t version = 0; version < history.desc.versions; ++version) {
+        uint32_t entry = m_pool.AcquireTexture(createInfo, completedFenceValue);
+        history.poolEntries.push_back(entry);
+        history.states.push_back(m_pool.GetStateFlag(entry));
+    }
+
+    history.written.assign(history.desc.versions, false);
+    history.current = 0;
+}
 
-    sprintf_s(msg, "Memory Used: %.2f MB\n",
-              m_statistics.transientMemoryUsed / (1024.0f * 1024.0f));
-    printf(msg);
+void RenderGraph::ReleaseHistory(HistoryResource &history, uint64_t fenceValue) {
+    // The last frame that used the versions may still be in flight, the pool waits for its fence
+    for (uint32_t version = 0; version < history.poolEntries.size(); ++version) {
+        m_pool.Release(history.poolEntries[version], history.states[version], fenceValue);
+    }
+
+    history.poolEntries.clear();
+    history.states.clear();
+    history.written.clear();
+    history.declaredFrame = UINT64_MAX;
+    BindHistory(history);
+}
+
+void RenderGraph::BindHistory(HistoryResource &history) {
+    const uint32_t versions = static_cast<uint32_t>(history.poolEntries.size());
+    for (uint32_t age = 0; age < history.resources.size(); ++age) {
+        ResourceEntry &entry = m_resources[history.resources[age]];
+        entry.subresourceStates.clear();
+
+        // Ages beyond the version count are left over from a larger descriptor
+        if (age >= versions) {
+            entry.externalTexture = nullptr;
+            continue;
+        }
+
+        uint32_t version = (history.current + versions - age) % versions;
+        entry.externalTexture = m_pool.GetTexture(history.poolEntries[version]);
+        entry.initialStateFlag = history.states[version];
+        entry.currentStateFlag = history.states[version];
+    }
+}
+
+void RenderGraph::StoreHistoryStates() {
+    // Barriers are resolved, so each entry holds the state its version ends the frame in
+    for (auto &history: m_histories) {
+        if (history.declaredFrame != m_frameNumber || history.poolEntries.empty()) {
+            continue;
+        }
+
+        const uint32_t versions = history.desc.versions;
+        for (uint32_t age = 0; age < versions; ++age) {
+            uint32_t version = (history.current + versions - age) % versions;
+            history.states[version] = m_resources[history.resources[age]].currentStateFlag;
+        }
+        history.written[history.current] = true;
+    }
+}
+
+void RenderGraph::SetPresentTarget(RenderGraphTextureHandle handle) {
+    WaitForCompile();
+
+    if (m_presentTarget != RenderGraphTextureHandle::InvalidIndex) {
+        m_resources[m_presentTarget].isPresentTarget = false;
+    }
+
+    m_presentTarget = handle.index;
+
+    if (handle.IsValid()) {
+        m_resources[handle.index].isPresentTarget = true;
+    }
+}
+
+void RenderGraph::AcquirePooledResource(uint32_t resourceIndex, const RenderPassResource &desc,
+                                        uint64_t completedFenceValue, uint32_t stateFlag) {
+    TransientResource &resource = m_frameResources[m_currentFrameIndex].resources[resourceIndex];
+    DestroyTransient(resource);
+
+    resource = TransientResource{};
+    resource.type = desc.type == RenderPassResource::Type::Texture
+                        ? TransientResource::Type::Texture
+                        : TransientResource::Type::Buffer;
+    resource.initialStateFlag = desc.stateFlag;
+
+    if (resource.type == TransientResource::Type::Texture) {
+        resource.textureInfo = BuildTextureCreateInfo(desc);
+        resource.poolEntry = m_pool.AcquireTexture(resource.textureInfo, completedFenceValue, stateFlag);
+        resource.texture = m_pool.GetTexture(resource.poolEntry);
+    } else {
+        resource.bufferInfo = BuildBufferCreateInfo(desc);
+        resource.poolEntry = m_pool.AcquireBuffer(resource.bufferInfo, completedFenceValue, stateFlag);
+        resource.buffer = m_pool.GetBuffer(resource.poolEntry);
+    }
+
+    // Continue from the state the previous user left the pooled resource in
+    resource.currentStateFlag = m_pool.GetStateFlag(resource.poolEntry);
+    resource.allocationSize = m_pool.GetAllocationSize(resource.poolEntry);
+}
+
+RenderGraph::TransientResource *RenderGraph::GetOrCreatePlacedResource(uint32_t resourceIndex,
+                                                                       const RenderPassResource &desc,
+                                                                       Heap *heap, uint64_t heapOffset) {
+    auto &currentFrame = m_frameResources[m_currentFrameIndex];
+    TransientResource &existing = currentFrame.resources[resourceIndex];
+    const bool isTexture = desc.type == RenderPassResource::Type::Texture;
+    const TextureCreateInfo textureInfo = isTexture ? BuildTextureCreateInfo(desc) : TextureCreateInfo{};
+    const BufferCreateInfo bufferInfo = isTexture ? BufferCreateInfo{} : BuildBufferCreateInfo(desc);
+
+    if (existing.IsAllocated()) {
+        bool matches = existing.type == TransientResource::Type::Texture
+                           ? isTexture && SameCreateInfo(existing.textureInfo, textureInfo)
+                           : !isTexture && SameCreateInfo(existing.bufferInfo, bufferInfo);
+        matches = matches && existing.heap == heap && existing.heapOffset == heapOffset;
+        if (matches) {
+            return &existing;
+        }
+
+        // Descriptor changed (e.g. resize). This frame slot's GPU work has completed, so it is safe to recreate.
+        DestroyTransient(existing);
+    }
+
+    // Create new placed resource for this frame slot
+    TransientResource resource;
+    resource.type = isTexture ? TransientResource::Type::Texture : TransientResource::Type::Buffer;
+    resource.initialStateFlag = desc.stateFlag;
+    resource.currentStateFlag = desc.stateFlag;
+    resource.heap = heap;
+    resource.heapOffset = heapOffset;
+    resource.allocationSize = GetAllocationInfo(desc).size;
+
+    if (resource.type == TransientResource::Type::Texture) {
+        resource.texture = m_device->CreatePlacedTexture(textureInfo, heap, heapOffset);
+        resource.textureInfo = textureInfo;
+    } else {
+        resource.buffer = m_device->CreatePlacedBuffer(bufferInfo, heap, heapOffset);
+        resource.bufferInfo = bufferInfo;
+    }
+
+    existing = resource;
+    return &existing;
+}
+
+RenderGraph::TransientResource *RenderGraph::GetCurrentFrameResource(uint32_t resourceIndex) {
+    auto &currentFrame = m_frameResources[m_currentFrameIndex];
+    if (resourceIndex >= currentFrame.resources.size()) {
+        return nullptr;
+    }
+
+    TransientResource &resource = currentFrame.resources[resourceIndex];
+    if (!resource.IsAllocated()) {
+        return nullptr;
+    }
+
+    return &resource;
+}
+
+void RenderGraph::DestroyTransient(TransientResource &resource) {
+    // Pooled resources are owned by the pool
+    if (resource.poolEntry != TransientResourcePool::InvalidEntry) {
+        resource = TransientResource{};
+        return;
+    }
+
+    if (resource.texture) {
+        m_device->DestroyTexture(resource.texture);
+        resource.texture = nullptr;
+    }
+    if (resource.buffer) {
+        m_device->DestroyBuffer(resource.buffer);
+        resource.buffer = nullptr;
+    }
+}
+
+void RenderGraph::UpdateStatistics() {
+    m_statistics.passCount = static_cast<uint32_t>(m_plan.passes.size());
+    m_statistics.disabledPassCount = static_cast<uint32_t>(
+        std::count_if(m_passes.begin(), m_passes.end(), [](const RenderPassPtr &pass) { return !pass->IsEnabled(); }));
+    m_statistics.culledPassCount = static_cast<uint32_t>(m_passes.size() - m_plan.passes.size()) -
+                                   m_statistics.disabledPassCount;
+    m_statistics.unwrittenReadCount = static_cast<uint32_t>(m_plan.unwrittenReads.size());
+    m_statistics.plannedTransitionCount = m_plan.plannedTransitionCount;
+    m_statistics.peakTransientBytes = m_plan.peakTransientBytes;
+    m_statistics.transientBudgetBytes = m_plan.budgetBytes;
+    m_statistics.undegradedPeakBytes = m_plan.undegradedPeakBytes;
+    m_statistics.appliedDegradations = m_plan.degradations;
+    m_statistics.overBudget = m_plan.budgetBytes != 0 && m_plan.peakTransientBytes > m_plan.budgetBytes;
+
+    m_statistics.asyncPassCount = 0;
+    m_statistics.renderPassCount = 0;
+    m_statistics.attachmentClearCount = 0;
+    m_statistics.attachmentLoadsSkipped = 0;
+    m_statistics.attachmentStoresDiscarded = 0;
+    for (const auto &compiled: m_plan.passes) {
+        if (compiled.queue != QueueType::Graphics) {
+            m_statistics.asyncPassCount++;
+        }
+
+        if (compiled.attachments.empty()) {
+            continue;
+        }
+
+        m_statistics.renderPassCount++;
+        for (const auto &binding: compiled.attachments) {
+            const auto &output = compiled.pass->GetOutputs()[binding.outputIndex];
+            if (binding.loadOp == AttachmentLoadOp::Clear) {
+                m_statistics.attachmentClearCount++;
+            } else if (binding.loadOp != output.loadOp) {
+                m_statistics.attachmentLoadsSkipped++;
+            }
+            if (binding.storeOp == AttachmentStoreOp::Discard) {
+                m_statistics.attachmentStoresDiscarded++;
+            }
+        }
+    }
+
+    const auto &currentFrame = m_frameResources[m_currentFrameIndex];
+
+    uint32_t transientCount = 0;
+    uint64_t memoryUsed = 0;
+    uint64_t memoryUnaliased = 0;
+    for (const auto &resource: currentFrame.resources) {
+        if (!resource.IsAllocated()) {
+            continue;
+        }
+
+        transientCount++;
+        memoryUnaliased += resource.allocationSize;
+
+        // Placed resources are accounted for by their heap
+        if (!resource.heap) {
+            memoryUsed += resource.allocationSize;
+        }
+    }
+
+    uint32_t heapCount = 0;
+    for (const Heap *heap: currentFrame.heaps) {
+        if (heap) {
+            heapCount++;
+            memoryUsed += heap->size;
+        }
+    }
+
+    m_statistics.transientResourceCount = transientCount;
+    m_statistics.transientMemoryUsed = memoryUsed;
+    m_statistics.transientMemoryUnaliased = memoryUnaliased;
+    m_statistics.transientHeapCount = heapCount;
+    m_statistics.poolResourceCount = m_pool.GetStatistics().resourceCount;
+    m_statistics.poolResidentBytes = m_pool.GetStatistics().residentBytes;
+
+    m_statistics.historyTextureCount = 0;
+    m_statistics.historyMemoryBytes = 0;
+    for (const auto &history: m_histories) {
+        for (uint32_t entry: history.poolEntries) {
+            m_statistics.historyTextureCount++;
+            m_statistics.historyMemoryBytes += m_pool.GetAllocationSize(entry);
+        }
+    }
+
+    const FrameArena &arena = GetFrameArena();
+    m_statistics.frameArenaBytes = arena.GetBytesUsed();
+    m_statistics.frameArenaBlocks = arena.GetBlockCount();
+}
+
+void RenderGraph::BuildMemoryReport(uint64_t fenceValue) {
+    MemoryReport &report = m_memoryReport;
+    report.fenceValue = fenceValue;
+    report.frameIndex = m_currentFrameIndex;
+    report.peakPass = m_plan.peakTransientPass;
+    report.peakBytes = m_plan.peakTransientBytes;
+    report.memoryUsed = m_statistics.transientMemoryUsed;
+    report.memoryUnaliased = m_statistics.transientMemoryUnaliased;
+    report.budgetBytes = m_plan.budgetBytes;
+    report.appliedDegradations = m_plan.degradations;
+
+    report.passes.resize(m_plan.passes.size());
+    for (const auto &compiled: m_plan.passes) {
+        MemoryReport::Pass &pass = report.passes[compiled.index];
+        pass.name = compiled.pass->GetName();
+        pass.queue = compiled.queue;
+    }
 
-    sprintf_s(msg, "Compile Time: %.2f ms\n", m_statistics.compileTime);
-    printf(msg);
+    // Same sweep as EstimatePeakTransientMemory, kept per pass
+    std::vector<int64_t> delta(m_plan.passes.size() + 1, 0);
+    report.transients.resize(m_plan.transients.size());
+    for (uint32_t i = 0; i < m_plan.transients.size(); ++i) {
+        const TransientDeclaration &transient = m_plan.transients[i];
+        const RenderPassResource desc = GetTransientDesc(transient);
+
+        MemoryReport::Transient &entry = report.transients[i];
+        entry.name = GetResourceName(transient.resource);
+        entry.type = desc.type;
+        entry.format = desc.format;
+        entry.width = desc.width;
+        entry.height = desc.height;
+        entry.mipLevels = desc.mipLevels;
+        entry.bufferSize = desc.size;
+        entry.allocationSize = transient.allocationSize;
+        entry.alignment = transient.alignment;
+        entry.firstUse = transient.firstUse;
+        entry.lastUse = transient.lastUse;
+        entry.aliased = transient.aliased;
+        entry.heap = transient.heap;
+        entry.heapOffset = transient.heapOffset;
+
+        if (transient.firstUse <= transient.lastUse) {
+            delta[transient.firstUse] += static_cast<int64_t>(transient.allocationSize);
+            delta[transient.lastUse + 1] -= static_cast<int64_t>(transient.allocationSize);
+        }
+    }
+
+    int64_t alive = 0;
+    for (uint32_t pass = 0; pass < report.passes.size(); ++pass) {
+        alive += delta[pass];
+        report.passes[pass].aliveBytes = static_cast<uint64_t>(alive);
+    }
+
+    report.heaps.resize(m_plan.heaps.size());
+    for (uint32_t i = 0; i < m_plan.heaps.size(); ++i) {
+        report.heaps[i] = {m_plan.heaps[i].resourceClass, m_plan.heaps[i].size};
+    }
+}
+
+void RenderGraph::LogRenderGraph() {
+    printf("\n===== RenderGraph =====\n");
+
+    printf("Passes: %u (%u culled, %u disabled)\n", m_statistics.passCount, m_statistics.culledPassCount,
+           m_statistics.disabledPassCount);
+
+    printf("Dependencies: %zu\n", m_plan.dependencies.size());
+
+    printf("Transient Resources: %u\n", m_statistics.transientResourceCount);
+
+    printf("Memory Used: %.2f MB (%.2f MB without aliasing)\n",
+           m_statistics.transientMemoryUsed / (1024.0f * 1024.0f),
+           m_statistics.transientMemoryUnaliased / (1024.0f * 1024.0f));
+
+    printf("Transient Pool: %u hits, %u misses, %u resources, %.2f MB resident\n",
+           m_statistics.poolHits, m_statistics.poolMisses, m_statistics.poolResourceCount,
+           m_statistics.poolResidentBytes / (1024.0f * 1024.0f));
+
+    static const char *strategyNames[(uint32_t) ScheduleStrategy::Count] = {
+        "DeclarationOrder", "MinimizeTransitions", "HideBarrierLatency", "MinimizeMemory", "Balanced"
+    };
+    printf("Schedule: %s, %u planned transitions, %.2f MB peak transient\n",
+           strategyNames[(uint32_t) m_plan.scheduleStrategy], m_statistics.plannedTransitionCount,
+           m_statistics.peakTransientBytes / (1024.0f * 1024.0f));
+
+    if (m_statistics.transientBudgetBytes != 0) {
+        static const char *policyNames[(uint32_t) DegradationPolicy::Count] = {
+            "Reschedule", "ReduceResolution", "DropOptionalPasses"
+        };
+        printf("Memory Budget: %.2f MB, %.2f MB peak before degradation%s\n",
+               m_statistics.transientBudgetBytes / (1024.0f * 1024.0f),
+               m_statistics.undegradedPeakBytes / (1024.0f * 1024.0f),
+               m_statistics.overBudget ? ", still over budget" : "");
+        for (uint32_t i = 0; i < (uint32_t) DegradationPolicy::Count; ++i) {
+            if (m_statistics.appliedDegradations & (1u << i)) {
+                printf("  Applied: %s\n", policyNames[i]);
+            }
+        }
+    }
+
+    printf("Compile Time: %.2f ms (%s)\n", m_statistics.compileTime,
+           m_statistics.planCacheHit ? "cached plan" : "recompiled");
+
+    printf("Command Lists: %u (%u cross-queue waits, %u async passes), recorded in %.2f ms\n",
+           m_statistics.commandListCount, m_statistics.crossQueueWaitCount, m_statistics.asyncPassCount,
+           m_statistics.recordTime);
+    if (m_deferredRecording) {
+        printf("Command Streams: %u commands, %.2f KB, translated in %.2f ms (%u state changes filtered)\n",
+               m_statistics.commandStreamCommands, m_statistics.commandStreamBytes / 1024.0f,
+               m_statistics.translateTime, m_statistics.filteredStateCount);
+    }
+
+    static const char *queueNames[QueueCount] = {"Graphics", "Compute", "Transfer"};
 
     printf("\nPass Execution Order:\n");
-    for (const auto &compiled: m_compiledPasses) {
-        sprintf_s(msg, "  %u: %s%s\n",
-                  compiled.index,
-                  compiled.pass->GetName().c_str(),
-                  compiled.pass->IsEnabled() ? "" : " (disabled)");
-        printf(msg);
+    for (const auto &compiled: m_plan.passes) {
+        printf("  %u: %.*s [%s, batch %u, group %u]\n",
+               compiled.index,
+               (int) compiled.pass->GetName().size(), compiled.pass->GetName().data(),
+               queueNames[(uint32_t) compiled.queue],
+               compiled.batch,
+               compiled.group);
+    }
+
+    if (!m_plan.unwrittenReads.empty()) {
+        printf("\nReads Without A Writer (null resources):\n");
+        for (const auto &read: m_plan.unwrittenReads) {
+            std::string_view passName = m_passes[read.pass]->GetName();
+            printf("  %.*s reads %s\n", (int) passName.size(), passName.data(),
+                   GetResourceName(read.resource).c_str());
+        }
     }
 
     printf("\nResource Lifetimes:\n");
-    for (const auto &[name, resource]: m_frameResources[m_currentFrameIndex].resources) {
-        sprintf_s(msg, "  %s: [%u, %u]\n",
-                  name.c_str(), resource.firstUse, resource.lastUse);
-        printf(msg);
+    for (const auto &transient: m_plan.transients) {
+        if (transient.aliased) {
+            printf("  %s: [%u, %u] heap %u @ %llu (%llu bytes)\n",
+                   GetResourceName(transient.resource).c_str(), transient.firstUse, transient.lastUse,
+                   transient.heap, (unsigned long long) transient.heapOffset,
+                   (unsigned long long) transient.allocationSize);
+        } else {
+            printf("  %s: [%u, %u]\n",
+                   GetResourceName(transient.resource).c_str(), transient.firstUse, transient.lastUse);
+        }
+    }
+
+    if (m_passTimings) {
+        printf("\nPass Timings (avg CPU / avg GPU):\n");
+        for (const auto &timing: m_statistics.passTimings) {
+            printf("  %s [%s]: %.3f ms / %.3f ms\n", timing.name.c_str(), queueNames[(uint32_t) timing.queue],
+                   timing.cpuAverage, timing.gpuAverage);
+        }
     }
 
     printf("========================\n\n");
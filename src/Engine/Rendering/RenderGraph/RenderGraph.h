@@ -5,17 +5,32 @@
 #ifndef GPU_PARTICLE_SIM_RENDERGRAPH_H
 #define GPU_PARTICLE_SIM_RENDERGRAPH_H
 
+#include <array>
+#include <future>
 #include <memory>
 #include <vector>
 #include <unordered_map>
 #include <string>
+#include <string_view>
 #include <cstdint>
 
 #include "Rendering/RHI/Device.h"
 #include "RenderPass.h"
+#include "RenderGraphHandle.h"
+#include "TransientResourcePool.h"
+#include "FrameArena.h"
+#include "RenderScaleController.h"
 #include "Rendering/RHI/Buffer.h"
 #include "Rendering/RHI/Texture.h"
 #include "Rendering/RHI/CommandList.h"
+#include "Rendering/RHI/CommandStream.h"
+#include "Rendering/RHI/Fence.h"
+#include "Rendering/RHI/Heap.h"
+#include "Rendering/RHI/QueryHeap.h"
+
+class ThreadPool;
+struct RenderGraphCapture;
+class RenderGraphCaptureRecorder;
 
 /// <summary>
 /// RenderGraph manages the execution of render passes.
@@ -24,11 +39,49 @@
 /// - Schedules passes in dependency order
 /// - Allocates and manages transient resources (per-frame)
 /// - Inserts resource barriers automatically
+/// - Binds render targets of graphics passes and applies their load/store ops
 /// - Optimizes resource lifetimes
 /// - Manages command list execution internally
+/// - Schedules passes across graphics, compute and transfer queues
+/// - Records pass groups in parallel when given a thread pool
 /// </summary>
 class RenderGraph {
 public:
+    /// <summary>
+    /// How the compiler orders passes that are ready at the same time
+    /// </summary>
+    enum class ScheduleStrategy {
+        DeclarationOrder, // First ready first, in declaration order
+        MinimizeTransitions, // Prefer passes that use resources in their current state
+        HideBarrierLatency, // Keep consumers that need a transition away from their producer
+        MinimizeMemory, // Prefer passes that release transient memory over ones that allocate it
+        Balanced, // Weighted mix of the above
+        Count
+    };
+
+    /// <summary>
+    /// What the compiler may give up, in registration order, when the peak of transient memory
+    /// exceeds the memory budget
+    /// </summary>
+    enum class DegradationPolicy {
+        Reschedule, // Order passes with ScheduleStrategy::MinimizeMemory
+        ReduceResolution, // Allocate downscalable transients at the degraded resolution scale
+        DropOptionalPasses, // Drop passes built with RenderPassBuilder::Optional
+        Count
+    };
+
+    /// <summary>
+    /// Estimated cost of a schedule: state transitions and the peak of transient bytes alive at once
+    /// </summary>
+    struct ScheduleReport {
+        ScheduleStrategy strategy;
+        uint32_t transitionCount = 0;
+        uint64_t peakTransientBytes = 0;
+    };
+
+    /// <summary>
+    /// commandQueue must be a graphics queue. The caller signals its frame fence on it after Execute.
+    /// </summary>
     explicit RenderGraph(Device *device, CommandQueue *commandQueue, uint32_t frameCount = 2);
 
     ~RenderGraph();
@@ -37,14 +90,21 @@ public:
     /// Add a render pass to the graph.
     /// Passes are executed in the order determined by dependencies.
     /// </summary>
-    void AddPass(std::unique_ptr<RenderPass> pass);
+    void AddPass(RenderPassPtr pass);
 
     /// <summary>
-    /// Remove all passes from the graph.
+    /// Remove all passes from the graph and reset the current frame slot's arena.
     /// Called at the start of each frame setup.
     /// </summary>
     void Clear();
 
+    /// <summary>
+    /// Linear allocator of the current frame slot. RenderPassBuilder allocates passes, names and
+    /// declarations here; pass callbacks can keep per-frame data here too and capture a pointer to it.
+    /// Everything is released at once by Clear() in the same frame slot.
+    /// </summary>
+    FrameArena &GetFrameArena() { return *m_frameArenas[m_currentFrameIndex]; }
+
     /// <summary>
     /// Compile and execute the render graph for the current frame.
     /// This performs:
@@ -54,12 +114,31 @@ public:
     /// 4. Barrier insertion
     /// 5. Pass execution
     ///
-    /// Returns the command list that was recorded (for submission to queue)
+    /// Steps 1, 2 and the barrier plan are skipped when the declared passes hash to the
+    /// same structure as one of the last two compiles; the cached plan is reused instead.
+    /// A compile started by CompileAsync is waited for and used if the declaration still matches.
+    ///
+    /// Barriers are resolved on the calling thread first. Passes are then recorded into one
+    /// command list per record group, in parallel when a thread pool is set, and each queue
+    /// batch is submitted as one call with fence waits only where a dependency crosses queues. The last submission is on the
+    /// graphics queue and waits for all other queues.
+    /// fenceValue is the value the caller signals on the graphics queue after Execute returns;
+    /// pooled transients used this frame become reusable once the queue reaches it.
     /// </summary>
-    CommandList *Execute();
+    void Execute(uint64_t fenceValue);
 
     /// <summary>
-    /// Advance to next frame. Must be called after GPU has finished previous frame.
+    /// Start compiling the declared passes on a worker thread and return, so compilation overlaps
+    /// whatever the caller does before Execute. The plan being replaced is kept: if the declaration
+    /// changes after this call, Execute reuses that plan when it matches, or compiles again on the
+    /// calling thread. Changing the graph (declaring, clearing, settings) waits for the compile first.
+    /// Does nothing when a cached plan already matches the declaration.
+    /// </summary>
+    void CompileAsync();
+
+    /// <summary>
+    /// Advance to next frame. Must be called after GPU has finished the frame previously
+    /// recorded in the new frame slot.
     /// </summary>
     void NextFrame();
 
@@ -69,47 +148,384 @@ public:
     /// </summary>
     void Flush();
 
+    /// <summary>
+    /// Register a queue that passes can be scheduled on with RenderPassBuilder::Queue.
+    /// Passes targeting a queue type that is not registered run on the graphics queue.
+    /// Call while the GPU is idle.
+    /// </summary>
+    void SetQueue(QueueType type, CommandQueue *queue);
+
+    /// <summary>
+    /// Split each queue batch into up to one contiguous pass group per pool thread and record the
+    /// groups concurrently. Pass callbacks then run on worker threads and may only record into their
+    /// context's command list and read shared data. Null records everything on the calling thread.
+    /// </summary>
+    void SetThreadPool(ThreadPool *threadPool) {
+        InvalidatePlan();
+        m_threadPool = threadPool;
+    }
+
     /// <summary>
     /// Register an external texture with initial state.
     /// Example: swap chain back buffer
     /// </summary>
-    void RegisterExternalTexture(const std::string &name, Texture *texture,
-                                 TextureUsage initialState = TextureUsage::RenderTarget);
+    RenderGraphTextureHandle RegisterExternalTexture(std::string_view name, Texture *texture,
+                                                     TextureUsage initialState = TextureUsage::RenderTarget);
 
     /// <summary>
     /// Register an external buffer with initial state
     /// </summary>
-    void RegisterExternalBuffer(const std::string &name, Buffer *buffer,
-                                BufferUsage initialState = BufferUsage::Storage);
+    RenderGraphBufferHandle RegisterExternalBuffer(std::string_view name, Buffer *buffer,
+                                                   BufferUsage initialState = BufferUsage::Storage);
+
+    /// <summary>
+    /// Texture whose previous versions stay alive across frames, for temporal effects
+    /// </summary>
+    struct HistoryTextureDesc {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        RenderPassResource::Format format = RenderPassResource::Format::RGBA8;
+        TextureUsage usage = TextureUsage::RenderTarget; // State the writing pass uses
+        uint32_t mipLevels = 1;
+        uint32_t versions = 2; // The current version plus the frames kept before it
+
+        bool operator==(const HistoryTextureDesc &other) const = default;
+    };
+
+    /// <summary>
+    /// Declare a history texture for this frame, once per frame like RegisterExternalTexture.
+    /// The graph owns one texture per version and rotates them each frame: GetHistoryVersion(history, 0)
+    /// is the version written this frame and age 1 is the one written last frame. Every version keeps
+    /// its state between frames, so reading last frame's output costs at most one transition and no copy.
+    /// Textures are only reallocated when the descriptor changes.
+    /// </summary>
+    RenderGraphHistoryHandle DeclareHistoryTexture(std::string_view name, const HistoryTextureDesc &desc);
+
+    /// <summary>
+    /// Handle of the version written `age` frames ago. The handle is the same every frame.
+    /// </summary>
+    RenderGraphTextureHandle GetHistoryVersion(RenderGraphHistoryHandle history, uint32_t age) const;
+
+    /// <summary>
+    /// False while the version at this age has not been written since the textures were allocated,
+    /// e.g. on the first frame or after a resize. Temporal passes should reset instead of reading it.
+    /// </summary>
+    bool IsHistoryValid(RenderGraphHistoryHandle history, uint32_t age) const;
+
+    /// <summary>
+    /// Give the textures of a history back, e.g. when its effect is turned off. The next declaration
+    /// allocates them again.
+    /// </summary>
+    void ReleaseHistoryTexture(RenderGraphHistoryHandle history);
 
     /// <summary>
     /// Mark a texture as the present target (will be transitioned to Present state)
     /// </summary>
-    void SetPresentTarget(const std::string &name);
+    void SetPresentTarget(RenderGraphTextureHandle handle);
+
+    /// <summary>
+    /// Get the handle for a named resource, declaring it on first use.
+    /// Handles stay valid for the lifetime of the graph, so they can be cached by the caller.
+    /// </summary>
+    RenderGraphTextureHandle DeclareTexture(std::string_view name);
+
+    RenderGraphBufferHandle DeclareBuffer(std::string_view name);
+
+    const std::string &GetResourceName(uint32_t resource) const { return m_resources[resource].name; }
 
     void SetAutoBarriers(bool enable) { m_autoBarriers = enable; }
-    void SetResourceAliasing(bool enable) { m_resourceAliasing = enable; }
+
+    /// <summary>
+    /// Drop passes whose outputs never reach the present target, an external resource or a pass
+    /// marked with side effects. Culled passes do not execute and their transients are not allocated.
+    /// </summary>
+    void SetPassCulling(bool enable) {
+        InvalidatePlan();
+        m_passCulling = enable;
+    }
+
+    /// <summary>
+    /// Begin transitions right after a resource's previous use and end them before the consumer.
+    /// Ignored when the device does not support split barriers.
+    /// </summary>
+    void SetSplitBarriers(bool enable) { m_splitBarriers = enable; }
+
+    /// <summary>
+    /// Record graphics passes inside CommandList::BeginRenderPass/EndRenderPass so load and store ops
+    /// map to the hardware. Off, or when the device does not support render passes, clears and
+    /// discards are recorded around the pass instead.
+    /// </summary>
+    void SetNativeRenderPasses(bool enable) { m_nativeRenderPasses = enable; }
+
+    /// <summary>
+    /// Record each group into a packed CommandStream, then translate the streams into the native
+    /// command lists with redundant state changes filtered out. Recording and translation are timed
+    /// apart, so pass cost can be told from driver cost.
+    /// </summary>
+    void SetDeferredRecording(bool enable) { m_deferredRecording = enable; }
+
+    void SetResourceAliasing(bool enable) {
+        InvalidatePlan();
+        m_resourceAliasing = enable;
+    }
+
+    void SetScheduleStrategy(ScheduleStrategy strategy) {
+        InvalidatePlan();
+        m_scheduleStrategy = strategy;
+    }
+
+    /// <summary>
+    /// Share of Device::GetVideoMemoryBudget() the peak of transient memory may take. A compile that
+    /// exceeds it applies the degradation policies in order until the peak fits. 0 disables the check.
+    /// The budget is queried every frame, a cached plan is recompiled when it moves across the plan's peak.
+    /// </summary>
+    void SetMemoryBudget(float budgetFraction) {
+        InvalidatePlan();
+        m_memoryBudgetFraction = budgetFraction;
+    }
+
+    void SetDegradationPolicies(std::vector<DegradationPolicy> policies) {
+        InvalidatePlan();
+        m_degradationPolicies = std::move(policies);
+    }
+
+    /// <summary>
+    /// Factor DegradationPolicy::ReduceResolution applies to the width and height of downscalable transients
+    /// </summary>
+    void SetDegradedResolutionScale(float scale) {
+        InvalidatePlan();
+        m_degradedResolutionScale = scale;
+    }
+
+    /// <summary>
+    /// Largest render scale, the size textures declared with RenderPassBuilder::Scaled are allocated at.
+    /// Changing it reallocates them.
+    /// </summary>
+    void SetMaxRenderScale(float maxScale);
+
+    /// <summary>
+    /// Scale scaled textures are rendered at from the next Execute, clamped to the maximum. Changing it
+    /// neither recompiles nor reallocates. Overwritten every frame while dynamic resolution is enabled.
+    /// </summary>
+    void SetRenderScale(float scale);
+
+    float GetRenderScale() const { return m_renderScale; }
+
+    /// <summary>
+    /// Let a RenderScaleController pick the render scale every frame from the GPU time of the passes.
+    /// Passes are timestamped while it is enabled, and the maximum render scale is taken from the settings.
+    /// </summary>
+    void SetDynamicResolution(bool enable, const RenderScaleSettings &settings = {});
+
+    /// <summary>
+    /// Compile the declared passes with every strategy and report the cost of each.
+    /// Call after declaring passes and before Execute; the next Execute recompiles with the selected strategy.
+    /// </summary>
+    std::vector<ScheduleReport> CompareScheduleStrategies();
+
+    /// <summary>
+    /// Discard the cached compiled plans so the next Execute() recompiles from scratch.
+    /// </summary>
+    void InvalidatePlan();
+
+    /// <summary>
+    /// Measure CPU record time and GPU time of every pass into Statistics::passTimings.
+    /// GPU times come from timestamps written around each pass on the graphics and compute queues
+    /// and are read back when the frame slot comes around again, so they lag a few frames.
+    /// </summary>
+    void SetPassTimings(bool enable) { m_passTimings = enable; }
+
+    /// <summary>
+    /// Timings of one pass. Averages are exponential moving averages over roughly the last
+    /// 1 / TimingSmoothing samples.
+    /// </summary>
+    struct PassTiming {
+        std::string name;
+        QueueType queue = QueueType::Graphics;
+        float cpuTime = 0.0f; // Callback record time of the last frame, ms
+        float gpuTime = 0.0f; // Last resolved GPU time including the pass' barriers, ms
+        float cpuAverage = 0.0f;
+        float gpuAverage = 0.0f;
+        uint64_t cpuSamples = 0;
+        uint64_t gpuSamples = 0; // Stays zero on the transfer queue, it has no timestamps
+    };
+
+    static constexpr float TimingSmoothing = 0.1f;
 
     struct Statistics {
         uint32_t passCount = 0;
+        uint32_t culledPassCount = 0;
+        uint32_t disabledPassCount = 0; // Left out of the plan like culled passes
+        uint32_t unwrittenReadCount = 0; // Reads of transients no planned pass writes, the context returns null
         uint32_t transientResourceCount = 0;
         uint32_t barrierCount = 0;
+        uint32_t barrierBatchCount = 0; // ResourceBarriers calls, at most one per pass
+        uint32_t splitBarrierCount = 0; // Transitions issued as begin/end pairs
+        uint32_t fullBarrierCount = 0; // Transitions issued immediately before the consumer
+        uint32_t subresourceBarrierCount = 0; // Transitions that target a single mip/slice
+        uint32_t uavBarrierCount = 0; // Between dependent unordered accesses of one resource
+        uint32_t skippedUavBarrierCount = 0; // Left out between non-overlapping unordered accesses
         uint64_t transientMemoryUsed = 0;
         float compileTime = 0.0f;
         float executeTime = 0.0f;
+
+        // Compiled plan cache
+        bool planCacheHit = false;
+        uint64_t planCacheHits = 0;
+        uint64_t planCacheMisses = 0;
+        float lastRecompileTime = 0.0f; // Time of the last full compile (cache miss)
+        uint64_t asyncCompiles = 0; // Full compiles run on a worker by CompileAsync
+        uint64_t asyncCompilesDiscarded = 0; // Declaration changed after CompileAsync, compiled again
+        float compileWaitTime = 0.0f; // Time Execute waited for CompileAsync to finish this frame
+
+        // Schedule quality of the current plan
+        uint32_t plannedTransitionCount = 0; // State changes between consecutive uses of a resource
+        uint64_t peakTransientBytes = 0; // Most transient bytes alive at one pass, before aliasing
+
+        // Memory budget, see SetMemoryBudget
+        uint64_t transientBudgetBytes = 0; // 0 without a budget
+        uint64_t undegradedPeakBytes = 0; // Peak before any degradation policy was applied
+        uint32_t appliedDegradations = 0; // Bit (1 << DegradationPolicy) per policy that lowered the peak
+        bool overBudget = false; // Peak still exceeds the budget after every policy
+
+        // Resource aliasing
+        uint32_t transientHeapCount = 0;
+        uint32_t aliasingBarrierCount = 0;
+        uint64_t transientMemoryUnaliased = 0; // Sum of transient allocation sizes without aliasing
+
+        // Transient pool, hits and misses are for the current frame
+        uint32_t poolHits = 0;
+        uint32_t poolMisses = 0;
+        uint32_t poolResourceCount = 0;
+        uint64_t poolResidentBytes = 0;
+
+        // Queue scheduling
+        uint32_t asyncPassCount = 0; // Passes recorded on the compute or transfer queue
+        uint32_t commandListCount = 0; // Command lists submitted across all queues
+        uint32_t crossQueueWaitCount = 0; // GPU fence waits between queues
+        uint32_t recordGroupCount = 0; // Command lists recorded, possibly in parallel
+        float recordTime = 0.0f; // Wall time spent recording command lists
+
+        // Deferred recording, see SetDeferredRecording. recordTime then only covers the streams.
+        float translateTime = 0.0f; // Wall time spent translating streams into native lists
+        uint64_t commandStreamBytes = 0;
+        uint32_t commandStreamCommands = 0;
+        uint32_t filteredStateCount = 0; // Redundant state changes left out by translation
+
+        // Render scale, see SetRenderScale
+        float renderScale = 1.0f;
+        float gpuFrameTime = 0.0f; // Sum of the pass GPU times of the last frame read back, ms
+
+        // Attachments bound by the graph
+        uint32_t renderPassCount = 0; // Passes whose render targets the graph bound
+        uint32_t attachmentClearCount = 0;
+        uint32_t attachmentLoadsSkipped = 0; // Load ops turned into DontCare
+        uint32_t attachmentStoresDiscarded = 0;
+
+        // History textures, all versions
+        uint32_t historyTextureCount = 0;
+        uint64_t historyMemoryBytes = 0;
+
+        // Declaration
+        uint64_t frameArenaBytes = 0; // Declared passes, names and resource declarations this frame
+        uint32_t frameArenaBlocks = 0; // More than one until the arena has grown to the frame's size
+
+        // Per compiled pass, in plan order. Filled when pass timings are enabled.
+        std::vector<PassTiming> passTimings;
+
+        /// <summary>
+        /// Timing of the planned pass with this name, null if it is not in the current plan
+        /// </summary>
+        const PassTiming *FindPassTiming(std::string_view name) const;
+    };
+
+    /// <summary>
+    /// Build a MemoryReport at the end of every Execute. Off by default, the report copies names.
+    /// </summary>
+    void SetMemoryReport(bool enable) { m_memoryReporting = enable; }
+
+    /// <summary>
+    /// Transient memory of the last executed frame. Sizes are the allocation sizes reported by the
+    /// device, so they account for format, mip chain and alignment. Pass indices are execution order.
+    /// </summary>
+    struct MemoryReport {
+        struct Transient {
+            std::string name;
+            RenderPassResource::Type type = RenderPassResource::Type::Texture;
+            RenderPassResource::Format format = RenderPassResource::Format::RGBA8; // Textures only
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t mipLevels = 1;
+            uint64_t bufferSize = 0; // Buffers only, requested size
+            uint64_t allocationSize = 0;
+            uint64_t alignment = 0;
+            uint32_t firstUse = 0;
+            uint32_t lastUse = 0;
+
+            // Aliasing slot, committed transients come from the pool instead
+            bool aliased = false;
+            uint32_t heap = 0; // Index into heaps
+            uint64_t heapOffset = 0;
+        };
+
+        struct Pass {
+            std::string name;
+            QueueType queue = QueueType::Graphics;
+            uint64_t aliveBytes = 0; // Transients alive during the pass, before aliasing
+        };
+
+        struct TransientHeap {
+            HeapResourceClass resourceClass = HeapResourceClass::Buffers;
+            uint64_t size = 0;
+        };
+
+        uint64_t fenceValue = 0; // Identifies the frame, as passed to Execute
+        uint32_t frameIndex = 0;
+        std::vector<Pass> passes;
+        std::vector<Transient> transients;
+        std::vector<TransientHeap> heaps;
+        uint32_t peakPass = 0; // Pass with the most transient bytes alive
+        uint64_t peakBytes = 0;
+        uint64_t memoryUsed = 0; // Same as Statistics::transientMemoryUsed
+        uint64_t memoryUnaliased = 0;
+        uint64_t budgetBytes = 0; // Same as Statistics::transientBudgetBytes
+        uint32_t appliedDegradations = 0;
     };
 
+    const MemoryReport &GetMemoryReport() const { return m_memoryReport; }
+
+    /// <summary>
+    /// Serialize the last MemoryReport as JSON
+    /// </summary>
+    std::string GetMemoryReportJson() const;
+
+    bool SaveMemoryReport(const std::string &filename) const;
+
+    /// <summary>
+    /// Capture the next Execute: resources, passes, external registrations, the commands every pass
+    /// callback records and the contents of the mapped buffers they bind. Pass groups of that frame are
+    /// recorded on the calling thread. Replay it with RenderGraphReplay.
+    /// </summary>
+    void CaptureNextFrame() { m_captureRequested = true; }
+
+    /// <summary>
+    /// Last finished capture, null until a frame was captured
+    /// </summary>
+    const RenderGraphCapture *GetCapture() const { return m_capture.get(); }
+
     const Statistics &GetStatistics() const { return m_statistics; }
     uint32_t GetCurrentFrameIndex() const { return m_currentFrameIndex; }
 
 private:
+    static constexpr uint32_t QueueCount = 3; // Indexed by QueueType
+    static constexpr uint32_t MaxColorAttachments = 8;
+
     /// <summary>
-    /// Transient resource managed by the RenderGraph.
-    /// Created and destroyed automatically based on pass requirements.
+    /// Transient resource bound to a handle for the current frame.
+    /// Committed resources are borrowed from the pool for one frame, placed (aliased)
+    /// resources live in the frame slot's heaps.
     /// </summary>
     struct TransientResource {
-        std::string name;
-
         enum class Type {
             Texture,
             Buffer
@@ -117,132 +533,589 @@ private:
 
         // For textures
         Texture *texture = nullptr;
-        uint32_t width = 0;
-        uint32_t height = 0;
+        TextureCreateInfo textureInfo{};
 
         // For buffers
         Buffer *buffer = nullptr;
-        uint64_t size = 0;
+        BufferCreateInfo bufferInfo{};
 
-        // Lifetime tracking (pass indices)
-        uint32_t firstUse = UINT32_MAX;
-        uint32_t lastUse = 0;
+        // Placement when aliased, null heap for committed resources
+        Heap *heap = nullptr;
+        uint64_t heapOffset = 0;
+        uint64_t allocationSize = 0;
+
+        // Pool entry for committed resources
+        uint32_t poolEntry = TransientResourcePool::InvalidEntry;
 
         uint32_t currentStateFlag = 0;
         uint32_t initialStateFlag = 0;
+        std::vector<uint32_t> subresourceStates; // See ResourceEntry
 
-        // Frame tracking - resource valid for this many frames after last use
-        uint32_t lastUsedFrame = 0;
-        bool canBeDestroyed = false;
+        bool IsAllocated() const { return texture || buffer; }
     };
 
     /// <summary>
-    /// Per-frame resources that need to survive GPU execution
+    /// Per-frame resources that need to survive GPU execution.
+    /// Indexed by resource handle; unallocated slots hold null resources.
     /// </summary>
     struct FrameTransientResources {
-        std::unordered_map<std::string, TransientResource> resources;
+        std::vector<TransientResource> resources;
+        std::vector<Heap *> heaps; // Indexed like CompiledPlan::heaps
         uint32_t frameIndex = 0;
     };
 
     /// <summary>
     /// Dependency between two render passes.
     /// Used for topological sorting and barrier insertion.
+    /// Producer and consumer are declaration indices (into m_passes) so the dependency
+    /// stays valid when the same structure is declared again next frame.
     /// </summary>
     struct PassDependency {
-        RenderPass *producer;
-        RenderPass *consumer;
-        std::string resourceName;
+        enum class Type {
+            ReadAfterWrite,
+            WriteAfterWrite,
+            WriteAfterRead // Ordering only, the consumer does not need the producer's result
+        };
+
+        uint32_t producer;
+        uint32_t consumer;
+        uint32_t resource;
+        Type type;
     };
 
     /// <summary>
-    /// External resource registration with state tracking
+    /// Every name declared on the graph. The index into m_resources is the handle.
+    /// External registration is rebound every frame, state is tracked across frames.
     /// </summary>
-    struct ExternalResource {
-        union {
-            Texture *texture;
-            Buffer *buffer;
-        };
+    struct ResourceEntry {
+        std::string name;
+        RenderPassResource::Type type;
 
-        enum class Type {
-            Texture,
-            Buffer
-        } type;
+        bool isExternal = false;
+        Texture *externalTexture = nullptr;
+        Buffer *externalBuffer = nullptr;
 
-        uint32_t currentStateFlag;
-        uint32_t initialStateFlag; // State at start of graph
+        uint32_t currentStateFlag = 0;
+        uint32_t initialStateFlag = 0; // State at start of graph
         bool isPresentTarget = false;
+
+        // Per subresource (mip + slice * mipLevels) while a ranged use leaves them in different states,
+        // empty when every subresource is in currentStateFlag. currentStateFlag is then the last requested state.
+        std::vector<uint32_t> subresourceStates;
+    };
+
+    /// <summary>
+    /// Versions of a history texture. Each age is an external resource entry that is bound to a
+    /// different version every frame; the versions themselves are borrowed from the pool.
+    /// </summary>
+    struct HistoryResource {
+        HistoryTextureDesc desc;
+        std::vector<uint32_t> resources; // Resource entry per age, 0 is written this frame
+        std::vector<uint32_t> poolEntries; // Per version, empty until allocated
+        std::vector<uint32_t> states; // Per version, carried between frames
+        std::vector<bool> written; // Per version, written since allocation
+        uint32_t current = 0; // Version written this frame
+        uint64_t declaredFrame = UINT64_MAX;
+    };
+
+    /// <summary>
+    /// State a resource must be in before a pass executes
+    /// </summary>
+    struct BarrierRequest {
+        uint32_t resource;
+        uint32_t stateFlag = 0;
+        SubresourceRange range;
+    };
+
+    /// <summary>
+    /// Unordered access of a pass to a resource, merged over the pass' declarations of it
+    /// </summary>
+    struct UnorderedAccessUse {
+        uint32_t resource;
+        bool write = false;
+        bool nonOverlapping = true; // Every declaration is non-overlapping
+    };
+
+    /// <summary>
+    /// Transition that can start at an earlier pass than the one consuming it.
+    /// Recorded on the pass right after the resource's previous use.
+    /// </summary>
+    struct SplitBarrier {
+        uint32_t resource;
+        uint32_t stateBefore = 0;
+        uint32_t stateAfter = 0;
+        uint32_t consumer = 0; // Compiled pass index that ends the transition
+    };
+
+    /// <summary>
+    /// Render target or depth texture the graph binds for a pass, with the ops it resolved.
+    /// The clear value is read from the pass output when recording.
+    /// </summary>
+    struct AttachmentBinding {
+        uint32_t resource;
+        uint32_t outputIndex = 0; // Index into the pass' outputs
+        AttachmentLoadOp loadOp = AttachmentLoadOp::Load;
+        AttachmentStoreOp storeOp = AttachmentStoreOp::Store;
+        bool depthStencil = false;
+        bool scaled = false; // Declared with RenderPassBuilder::Scaled, rendered in part
     };
 
     struct CompiledPass {
         RenderPass *pass = nullptr;
         uint32_t index = 0;
-        std::vector<std::string> inputResourceNames;
-        std::vector<std::string> outputResourceNames;
+        uint32_t declarationIndex = 0; // Index into m_passes
+        QueueType queue = QueueType::Graphics;
+        uint32_t batch = 0; // Index into CompiledPlan::batches
+        uint32_t batchPosition = 0; // Index into QueueBatch::passes
+        uint32_t group = 0; // Index into CompiledPlan::groups
+        std::vector<BarrierRequest> barriers;
+        std::vector<uint32_t> aliasActivations; // Aliased resources that take over their memory at this pass
+        std::vector<SplitBarrier> splitBegins; // Transitions to begin before this pass
+        std::vector<UnorderedAccessUse> unorderedAccesses; // Checked against earlier unordered writes
+        std::vector<AttachmentBinding> attachments; // Empty when the pass binds its own targets
+    };
+
+    /// <summary>
+    /// Input of a planned pass whose only writers were disabled, culled or dropped
+    /// </summary>
+    struct UnwrittenRead {
+        uint32_t pass; // Declaration index
+        uint32_t resource;
+    };
+
+    /// <summary>
+    /// Transient declared by the compiled passes, with its lifetime in compiled pass indices.
+    /// The descriptor is looked up from the declaring pass output so the plan holds no copies.
+    /// </summary>
+    struct TransientDeclaration {
+        uint32_t resource;
+        uint32_t declarationIndex = 0; // Pass that declares the resource
+        uint32_t outputIndex = 0; // Index into that pass' outputs
+        uint32_t firstUse = UINT32_MAX;
+        uint32_t lastUse = 0;
+
+        // Queried from the device once per compile
+        uint64_t allocationSize = 0;
+        uint64_t alignment = 0;
+
+        // State a first use on the compute or transfer queue expects, the frame ends with the
+        // resource back in it. UINT32_MAX when the first use is on graphics.
+        uint32_t queueStartState = UINT32_MAX;
+
+        // Placement assigned by AliasResources
+        bool aliased = false;
+        uint32_t heap = 0; // Index into CompiledPlan::heaps
+        uint64_t heapOffset = 0;
+    };
+
+    /// <summary>
+    /// Heap shared by aliased transients of one resource class
+    /// </summary>
+    struct TransientHeap {
+        HeapResourceClass resourceClass;
+        uint64_t size = 0;
+    };
+
+    /// <summary>
+    /// Compiled passes recorded into one command list and submitted to one queue.
+    /// A new batch starts whenever a pass has to wait for work on another queue.
+    /// </summary>
+    struct QueueBatch {
+        QueueType queue = QueueType::Graphics;
+        std::vector<uint32_t> passes; // Compiled pass indices in execution order
+        std::vector<uint32_t> waits; // Batches on other queues to wait for before this one
+        bool signal = false; // Another queue waits for this batch
+
+        // Record groups of this batch, submitted together in one call
+        uint32_t firstGroup = 0;
+        uint32_t groupCount = 0;
+    };
+
+    /// <summary>
+    /// Contiguous passes of one batch recorded into their own command list.
+    /// Groups are recorded independently and only read state prepared before recording.
+    /// </summary>
+    struct RecordGroup {
+        uint32_t batch = 0;
+        uint32_t begin = 0; // Range of QueueBatch::passes
+        uint32_t end = 0;
+
+        // Transitions a pass on another queue needs but cannot record, made after this group's passes
+        // and so before the batch signals
+        std::vector<BarrierRequest> handoffs;
+    };
+
+    /// <summary>
+    /// Result of graph compilation. Reused across frames for as long as the declared
+    /// pass structure hashes to the same value.
+    /// </summary>
+    struct CompiledPlan {
+        uint64_t structureHash = 0;
+        // Declaration shape the plan was compiled for, compared on a hash hit so a collision cannot reuse it
+        uint32_t passCount = 0;
+        uint32_t resourceCount = 0;
+        std::vector<uint32_t> declarationCounts; // Inputs then outputs of each pass
+        uint64_t generation = 0; // Distinct per compile, tells the plans passTimings were built for apart
+        bool valid = false;
+        std::vector<CompiledPass> passes;
+        std::vector<PassDependency> dependencies;
+        std::vector<bool> culled; // Indexed by declaration index, disabled passes included
+        std::vector<UnwrittenRead> unwrittenReads;
+        std::vector<TransientDeclaration> transients;
+        std::vector<TransientHeap> heaps;
+        std::vector<QueueBatch> batches;
+        std::vector<RecordGroup> groups;
+        std::vector<uint32_t> joinWaits; // Batches the graphics queue waits for after its last batch
+
+        uint32_t plannedTransitionCount = 0;
+        uint64_t peakTransientBytes = 0;
+        uint32_t peakTransientPass = 0;
+
+        // Schedule inputs the degradation policies change, see ApplyMemoryBudget
+        ScheduleStrategy scheduleStrategy = ScheduleStrategy::DeclarationOrder;
+        float resolutionScale = 1.0f; // Applied to downscalable transients
+        bool dropOptionalPasses = false;
+
+        // Memory budget the plan was compiled against
+        uint64_t budgetBytes = 0;
+        uint64_t undegradedPeakBytes = 0;
+        uint32_t degradations = 0; // Bit per DegradationPolicy that lowered the peak
+        uint32_t policiesTried = 0;
+    };
+
+    /// <summary>
+    /// Resource state simulated while ordering passes, used to score the passes that are ready
+    /// </summary>
+    struct ScheduleState {
+        static constexpr uint32_t LatencyWindow = 3; // Passes between producer and consumer that hide a transition
+
+        struct Use {
+            uint32_t resource;
+            uint32_t stateFlag; // Last state the pass requests
+            bool write;
+        };
+
+        std::vector<std::vector<Use> > uses; // Per declaration index, one entry per resource
+        std::vector<std::vector<uint32_t> > users; // Per resource, declaration indices of the passes using it
+        std::vector<uint32_t> resourceState;
+        std::vector<uint32_t> producerPosition; // Schedule position of the last writer
+        std::vector<uint32_t> remainingUses; // Unscheduled passes using the resource
+        std::vector<uint64_t> transientBytes; // Zero for external resources
+        std::vector<bool> allocated;
+        uint64_t largestTransient = 1;
+        uint32_t position = 0;
+    };
+
+    /// <summary>
+    /// Timestamp queries of one frame slot. Each timed pass owns a begin/end pair, every record
+    /// group resolves its range into the readback buffer before closing its command list.
+    /// </summary>
+    struct TimestampFrame {
+        struct TimedPass {
+            uint32_t pass = 0; // Compiled pass index in the plan of planGeneration
+            QueueType queue = QueueType::Graphics;
+            uint32_t query = 0; // Begin query, the end query follows it
+        };
+
+        uint64_t planGeneration = 0;
+        QueryHeap *queryHeap = nullptr;
+        Buffer *readback = nullptr;
+        uint32_t capacity = 0; // Queries
+        std::vector<TimedPass> passes;
+        bool pending = false; // Resolved by a submitted frame and not read back yet
+    };
+
+    /// <summary>
+    /// A queue the graph submits to, with the fence other queues wait on
+    /// </summary>
+    struct QueueContext {
+        CommandQueue *queue = nullptr;
+        std::unique_ptr<Fence> fence;
+        uint64_t fenceValue = 0;
+
+        // Command lists per frame slot, one per batch on this queue. They share the slot's allocator.
+        std::vector<std::vector<std::unique_ptr<CommandList> > > commandLists;
     };
 
     Device *m_device;
-    CommandQueue *m_commandQueue;
+    CommandQueue *m_commandQueue; // Graphics queue, the caller's frame fence lives on it
+
+    std::array<QueueContext, QueueCount> m_queues;
+    ThreadPool *m_threadPool = nullptr;
+
+    // Command list of each record group for the current frame
+    std::vector<CommandList *> m_groupCommandLists;
+    // Deferred recording: stream of each record group, translated into its command list
+    std::vector<std::unique_ptr<DeferredCommandList> > m_groupStreams;
+    std::vector<CommandStream::TranslateResult> m_groupTranslations;
+    std::vector<uint64_t> m_batchSignalValues; // Fence value each signaling batch signaled this frame
 
-    // Per-frame command lists
-    std::vector<std::unique_ptr<CommandList> > m_commandLists;
     uint32_t m_currentFrameIndex = 0;
     uint32_t m_frameCount;
 
-    // Pass management
-    std::vector<std::unique_ptr<RenderPass> > m_passes;
-    std::vector<CompiledPass> m_compiledPasses;
-    std::vector<PassDependency> m_dependencies;
+    // Pass management, passes live in the arena of the slot they were declared in
+    std::vector<std::unique_ptr<FrameArena> > m_frameArenas;
+    std::vector<RenderPassPtr> m_passes;
+    CompiledPlan m_plan;
+    CompiledPlan m_previousPlan; // Replaced by the last compile, reused if its structure is declared again
+
+    // Compile started by CompileAsync, returns its time in ms. While it runs the worker writes m_plan
+    // and reads the declaration; every member function that touches either waits for it first.
+    std::future<float> m_pendingCompile;
+    bool m_asyncPlanUnused = false; // The worker's plan has not been used by Execute yet
+
+    // Resource registry - shared across frames
+    std::vector<ResourceEntry> m_resources;
+    // Transparent so declarations by string_view look up without building a string
+    struct NameHash {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<> > m_resourceLookup;
+
+    std::vector<HistoryResource> m_histories;
+    std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<> > m_historyLookup;
+    uint64_t m_frameNumber = 0; // Advanced by NextFrame
+    uint64_t m_lastFenceValue = 0; // Fence value of the last Execute
+    uint32_t m_presentTarget = RenderGraphTextureHandle::InvalidIndex;
 
     // Resource management - per frame
     std::vector<FrameTransientResources> m_frameResources;
+    TransientResourcePool m_pool;
+
+    // Resources resolved for the current frame, indexed by handle
+    std::vector<Texture *> m_resolvedTextures;
+    std::vector<Buffer *> m_resolvedBuffers;
+
+    // Barriers collected for the next ResourceBarriers call
+    std::vector<ResourceBarrier> m_barrierBatch;
+
+    // Transitions queued by QueueBarrier into the batch, reset by FlushBarriers. Whole-resource
+    // barriers are indexed by resource, per-subresource ones by resource << 32 | subresource.
+    std::vector<uint32_t> m_batchWholeBarriers;
+    std::vector<uint32_t> m_batchSubresourceCounts;
+    std::unordered_map<uint64_t, uint32_t> m_batchSubresourceBarriers;
+    std::vector<uint32_t> m_batchResources; // Resources with an indexed barrier
+
+    // Barriers resolved before recording. Indexed by compiled pass and by record group.
+    std::vector<std::vector<ResourceBarrier> > m_passBarriers;
+    std::vector<std::vector<Texture *> > m_passDiscards;
+    std::vector<std::vector<ResourceBarrier> > m_groupEndBarriers;
+
+    // Target state of split transitions begun but not yet ended, indexed by handle
+    std::vector<uint32_t> m_pendingSplitStates;
 
-    // External resources - shared across frames
-    std::unordered_map<std::string, ExternalResource> m_externalResources;
-    std::string m_presentTarget;
+    // Unordered writes no barrier has ordered yet, indexed by handle
+    enum class UavHazard : uint8_t {
+        None,
+        Write,
+        NonOverlappingWrite, // Every pending write is non-overlapping
+    };
+    std::vector<UavHazard> m_uavHazards;
+
+    // Pass timings. Queries are indexed by compiled pass, InvalidQuery when the pass is not timed on the GPU.
+    static constexpr uint32_t InvalidQuery = UINT32_MAX;
+    std::vector<TimestampFrame> m_timestampFrames;
+    std::vector<uint32_t> m_passQueries;
+    std::vector<uint32_t> m_groupQueryRanges; // First query and count per record group, interleaved
+    std::vector<float> m_passCpuTimes;
+    uint64_t m_planGenerations = 0;
+    uint64_t m_passTimingGeneration = 0; // Plan Statistics::passTimings is indexed by
 
     // Configuration
     bool m_autoBarriers = true;
+    QueueType m_barrierQueue = QueueType::Graphics; // Queue of the group ResolveBarriers is at
+    bool m_splitBarriers = true;
+    bool m_nativeRenderPasses = true;
+    bool m_deviceRenderPasses = false; // Device::SupportsRenderPasses
+    bool m_deferredRecording = false;
     bool m_resourceAliasing = false;
+    bool m_passCulling = true;
+    bool m_passTimings = false;
+    bool m_timestamps = false; // Pass timings or dynamic resolution, set by Execute
+    bool m_memoryReporting = false;
+    ScheduleStrategy m_scheduleStrategy = ScheduleStrategy::DeclarationOrder;
+    float m_memoryBudgetFraction = 0.0f;
+    std::vector<DegradationPolicy> m_degradationPolicies;
+    float m_degradedResolutionScale = 0.5f;
+    float m_maxRenderScale = 1.0f;
+    float m_renderScale = 1.0f;
+    std::unique_ptr<RenderScaleController> m_renderScaleController;
 
     Statistics m_statistics;
+    MemoryReport m_memoryReport;
+
+    // Frame capture, the recorder only exists while the captured frame records
+    bool m_captureRequested = false;
+    std::unique_ptr<RenderGraphCaptureRecorder> m_captureRecorder;
+    std::unique_ptr<RenderGraphCapture> m_capture;
+
+    uint32_t DeclareResource(std::string_view name, RenderPassResource::Type type);
+
+    void Compile();
+
+    float CompilePlan(uint64_t structureHash, uint64_t budgetBytes);
+
+    void BuildSchedule();
+
+    uint64_t GetTransientBudget() const;
+
+    void ApplyMemoryBudget(uint64_t budgetBytes);
+
+    bool IsPlanUsable(const CompiledPlan &plan, uint64_t structureHash, uint64_t budgetBytes) const;
+
+    /// <summary>
+    /// Whether the passes and resources declared now have the counts the plan was compiled for.
+    /// </summary>
+    bool MatchesDeclarationShape(const CompiledPlan &plan) const;
+
+    RenderPassResource GetTransientDesc(const TransientDeclaration &transient) const;
+
+    void WaitForCompile();
+
+    uint64_t ComputeStructureHash() const;
+
+    void RebindPlan();
 
     void BuildDependencyGraph();
 
+    void CullPasses();
+
     void TopologicalSort();
 
+    void InitScheduleState(ScheduleState &state) const;
+
+    float ScoreReadyPass(const ScheduleState &state, uint32_t pass) const;
+
+    void ApplyScheduledPass(ScheduleState &state, uint32_t pass) const;
+
+    void EstimatePeakTransientMemory();
+
+    void CollectTransients();
+
+    void BuildQueueBatches();
+
+    void BuildRecordGroups();
+
+    void BuildBarrierPlan();
+
+    void BuildAttachmentPlan();
+
     void AllocateResources();
 
-    Texture *CreateTransientTexture(const RenderPassResource &desc);
+    void ReleasePooledResources(uint64_t fenceValue);
 
-    Buffer *CreateTransientBuffer(const RenderPassResource &desc);
+    void ResolveResources();
 
-    void CalculateResourceLifetimes();
+    static TextureCreateInfo BuildTextureCreateInfo(const RenderPassResource &desc);
+
+    static BufferCreateInfo BuildBufferCreateInfo(const RenderPassResource &desc);
 
-    void CleanupOldResources();
+    ResourceAllocationInfo GetAllocationInfo(const RenderPassResource &desc) const;
+
+    void AllocateHeaps();
+
+    void ReleaseHeap(FrameTransientResources &frame, uint32_t heapIndex);
+
+    void CalculateResourceLifetimes();
 
     void AliasResources();
 
+    void ResolveBarriers();
+
     void InsertBarriers(uint32_t passIndex);
 
-    void TransitionExternalResource(const std::string &name, uint32_t newState);
+    void TransitionExternalResource(uint32_t resource, uint32_t newState);
+
+    uint32_t *GetTrackedState(uint32_t resource, Texture **texture, Buffer **buffer,
+                              std::vector<uint32_t> **subresourceStates = nullptr);
+
+    void BeginSplitBarriers(const CompiledPass &compiled);
+
+    void QueueUavBarriers(const CompiledPass &compiled);
+
+    void TrackUavWrites(const CompiledPass &compiled);
+
+    void QueueTransition(uint32_t resource, uint32_t newStateFlag, const SubresourceRange &range = {});
+
+    void QueueBarrier(uint32_t resource, Texture *texture, Buffer *buffer, uint32_t stateBefore, uint32_t stateAfter,
+                      uint32_t subresource = ResourceBarrier::AllSubresources);
+
+    void QueueSubresourceBarrier(uint32_t resource, Texture *texture, uint32_t stateBefore, uint32_t stateAfter,
+                                 uint32_t subresource);
+
+    void CollapseBatchedSubresources();
+
+    void CollapseSubresourceStates();
+
+    void EndPendingSplitBarriers();
+
+    void FlushBarriers(std::vector<ResourceBarrier> &barriers);
+
+    QueueType GetPassQueue(const RenderPass &pass) const;
+
+    /// <summary>
+    /// State a use puts the resource in on the pass' queue: shader resource reads off the graphics
+    /// queue become NonPixelShaderResource
+    /// </summary>
+    static uint32_t GetQueueState(QueueType queue, const RenderPassResource &desc);
+
+    CommandList *AcquireCommandList(QueueType type, uint32_t listIndex);
+
+    void RecordPassGroup(uint32_t groupIndex);
+
+    void TranslatePassGroups();
+
+    void SubmitBatch(uint32_t batchIndex);
+
+    void RebuildPassTimings();
+
+    bool ReadBackTimestamps();
+
+    void PrepareTimestamps();
+
+    void UpdatePassTimings();
+
+    void ReleaseTimestampFrame(TimestampFrame &frame);
 
-    void ExecutePass(const CompiledPass &compiledPass);
+    void ExecutePass(const CompiledPass &compiledPass, CommandList *commandList);
 
-    RenderPassContext BuildPassContext(const CompiledPass &compiledPass);
+    void BeginAttachments(const CompiledPass &compiledPass, CommandList *commandList, bool nativeRenderPass);
 
-    TransientResource *GetCurrentFrameResource(const std::string &name);
+    void EndAttachments(const CompiledPass &compiledPass, CommandList *commandList, bool nativeRenderPass);
 
-    TransientResource *GetOrCreateResource(const std::string &name,
-                                           const RenderPassResource &desc);
+    void SetScaledRenderArea(const CompiledPass &compiledPass, CommandList *commandList);
 
-    Texture *GetTexture(const std::string &name);
+    RenderPassContext BuildPassContext(CommandList *commandList);
 
-    Buffer *GetBuffer(const std::string &name);
+    TransientResource *GetCurrentFrameResource(uint32_t resource);
 
-    bool IsExternalResource(const std::string &name) const;
+    void AcquirePooledResource(uint32_t resource, const RenderPassResource &desc, uint64_t completedFenceValue,
+                               uint32_t stateFlag);
+
+    TransientResource *GetOrCreatePlacedResource(uint32_t resource, const RenderPassResource &desc,
+                                                 Heap *heap, uint64_t heapOffset);
+
+    void DestroyTransient(TransientResource &resource);
+
+    bool IsExternalResource(uint32_t resource) const { return m_resources[resource].isExternal; }
+
+    void AllocateHistory(HistoryResource &history);
+
+    void ReleaseHistory(HistoryResource &history, uint64_t fenceValue);
+
+    void BindHistory(HistoryResource &history);
+
+    void StoreHistoryStates();
 
     void UpdateStatistics();
 
+    void BuildMemoryReport(uint64_t fenceValue);
+
+    void BeginCapture();
+
     void LogRenderGraph();
 };
 
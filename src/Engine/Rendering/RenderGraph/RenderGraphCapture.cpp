@@ -0,0 +1,656 @@
+//
+// Created by 2401Lucas on 2025-12-11.
+//
+
+#include "RenderGraphCapture.h"
+#include "RenderGraph.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+    constexpr char CaptureMagic[8] = {'R', 'G', 'C', 'A', 'P', 'T', 'U', 'R'};
+    constexpr uint32_t CaptureVersion = 4;
+
+    // Declarations and command streams are written as they are in memory, the version guards their layout
+    static_assert(std::is_trivially_copyable_v<RenderPassResource>);
+
+    class CaptureWriter {
+    public:
+        explicit CaptureWriter(std::ofstream &stream) : m_stream(stream) {
+        }
+
+        template<typename T>
+        void Value(const T &value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            m_stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        void Array(const std::vector<T> &values) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Value(static_cast<uint64_t>(values.size()));
+            m_stream.write(reinterpret_cast<const char *>(values.data()),
+                           static_cast<std::streamsize>(values.size() * sizeof(T)));
+        }
+
+        void String(const std::string &value) {
+            Value(static_cast<uint64_t>(value.size()));
+            m_stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+    private:
+        std::ofstream &m_stream;
+    };
+
+    class CaptureReader {
+    public:
+        CaptureReader(std::ifstream &stream, const std::string &filename) : m_stream(stream), m_filename(filename) {
+        }
+
+        template<typename T>
+        T Value() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            Read(&value, sizeof(T));
+            return value;
+        }
+
+        template<typename T>
+        std::vector<T> Array() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            std::vector<T> values(Count(sizeof(T)));
+            Read(values.data(), values.size() * sizeof(T));
+            return values;
+        }
+
+        std::string String() {
+            std::string value(Count(1), '\0');
+            Read(value.data(), value.size());
+            return value;
+        }
+
+        [[noreturn]] void Fail(const char *reason) const {
+            throw std::runtime_error("RenderGraphCapture '" + m_filename + "': " + reason);
+        }
+
+        // A corrupt count must not turn into a huge allocation
+        size_t Count(size_t elementSize) {
+            uint64_t count = Value<uint64_t>();
+            if (count > (1ull << 32) / elementSize) {
+                Fail("corrupt element count");
+            }
+            return static_cast<size_t>(count);
+        }
+
+    private:
+        std::ifstream &m_stream;
+        const std::string &m_filename;
+
+        void Read(void *data, size_t size) {
+            if (!m_stream.read(static_cast<char *>(data), static_cast<std::streamsize>(size))) {
+                Fail("unexpected end of file");
+            }
+        }
+    };
+
+    // A reference takes the place of the object pointer in a captured command
+    void *ReferenceObject(uint32_t reference) {
+        return reinterpret_cast<void *>(static_cast<uintptr_t>(reference));
+    }
+
+    uint32_t ObjectReference(const void *object) {
+        return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(object));
+    }
+}
+
+bool RenderGraphCapture::Save(const std::string &filename) const {
+    std::ofstream stream(filename, std::ios::binary);
+    if (!stream) return false;
+
+    CaptureWriter writer(stream);
+    stream.write(CaptureMagic, sizeof(CaptureMagic));
+    writer.Value(CaptureVersion);
+
+    writer.Value(static_cast<uint64_t>(resources.size()));
+    for (const Resource &resource: resources) {
+        writer.String(resource.name);
+        writer.Value(resource.type);
+        writer.Value(resource.isExternal);
+        writer.Value(resource.stateFlag);
+        writer.Value(resource.object);
+    }
+
+    writer.Value(static_cast<uint64_t>(passes.size()));
+    for (const Pass &pass: passes) {
+        writer.String(pass.name);
+        writer.Value(pass.queue);
+        writer.Value(pass.enabled);
+        writer.Value(pass.hasSideEffects);
+        writer.Value(pass.optional);
+        writer.Value(pass.manualAttachments);
+        writer.Array(pass.inputs);
+        writer.Array(pass.outputs);
+        writer.Value(static_cast<uint64_t>(pass.commands.GetSize()));
+        stream.write(reinterpret_cast<const char *>(pass.commands.GetData()),
+                     static_cast<std::streamsize>(pass.commands.GetSize()));
+    }
+
+    writer.Value(static_cast<uint64_t>(objects.size()));
+    for (const Object &object: objects) {
+        writer.Value(object.type);
+        writer.Value(object.width);
+        writer.Value(object.height);
+        writer.Value(object.mipLevels);
+        writer.Value(object.arraySize);
+        writer.Value(object.format);
+        writer.Value(object.usage);
+        writer.Value(object.size);
+        writer.Value(object.bufferUsage);
+        writer.Value(object.memoryType);
+        writer.Array(object.payload);
+    }
+
+    writer.Value(commandCount);
+    writer.Value(pipelineCount);
+    writer.Value(presentTarget);
+
+    return static_cast<bool>(stream);
+}
+
+RenderGraphCapture RenderGraphCapture::Load(const std::string &filename) {
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream) {
+        throw std::runtime_error("RenderGraphCapture: cannot open '" + filename + "'");
+    }
+
+    CaptureReader reader(stream, filename);
+    char magic[sizeof(CaptureMagic)] = {};
+    stream.read(magic, sizeof(magic));
+    if (!stream || std::memcmp(magic, CaptureMagic, sizeof(magic)) != 0) {
+        reader.Fail("not a render graph capture");
+    }
+    if (reader.Value<uint32_t>() != CaptureVersion) {
+        reader.Fail("written by a different capture version");
+    }
+
+    RenderGraphCapture capture;
+
+    capture.resources.resize(reader.Count(sizeof(Resource)));
+    for (Resource &resource: capture.resources) {
+        resource.name = reader.String();
+        resource.type = reader.Value<RenderPassResource::Type>();
+        resource.isExternal = reader.Value<bool>();
+        resource.stateFlag = reader.Value<uint32_t>();
+        resource.object = reader.Value<uint32_t>();
+    }
+
+    capture.passes.resize(reader.Count(sizeof(Pass)));
+    for (Pass &pass: capture.passes) {
+        pass.name = reader.String();
+        pass.queue = reader.Value<QueueType>();
+        pass.enabled = reader.Value<bool>();
+        pass.hasSideEffects = reader.Value<bool>();
+        pass.optional = reader.Value<bool>();
+        pass.manualAttachments = reader.Value<bool>();
+        pass.inputs = reader.Array<RenderPassResource>();
+        pass.outputs = reader.Array<RenderPassResource>();
+        const std::vector<std::byte> commands = reader.Array<std::byte>();
+        if (!pass.commands.Assign(commands.data(), commands.size())) {
+            reader.Fail("corrupt command stream");
+        }
+    }
+
+    capture.objects.resize(reader.Count(sizeof(Object)));
+    for (Object &object: capture.objects) {
+        object.type = reader.Value<RenderPassResource::Type>();
+        object.width = reader.Value<uint32_t>();
+        object.height = reader.Value<uint32_t>();
+        object.mipLevels = reader.Value<uint32_t>();
+        object.arraySize = reader.Value<uint32_t>();
+        object.format = reader.Value<TextureFormat>();
+        object.usage = reader.Value<TextureUsage>();
+        object.size = reader.Value<uint64_t>();
+        object.bufferUsage = reader.Value<uint32_t>();
+        object.memoryType = reader.Value<MemoryType>();
+        object.payload = reader.Array<uint8_t>();
+    }
+
+    capture.commandCount = reader.Value<uint32_t>();
+    capture.pipelineCount = reader.Value<uint32_t>();
+    capture.presentTarget = reader.Value<uint32_t>();
+
+    // Everything a replay indexes with is checked once here
+    const uint32_t resourceCount = static_cast<uint32_t>(capture.resources.size());
+    for (const Resource &resource: capture.resources) {
+        if (resource.object != NoReference && resource.object >= capture.objects.size()) {
+            reader.Fail("external bound to a missing object");
+        }
+    }
+    for (const Pass &pass: capture.passes) {
+        for (const auto *list: {&pass.inputs, &pass.outputs}) {
+            for (const RenderPassResource &resource: *list) {
+                if (resource.resource >= resourceCount) {
+                    reader.Fail("pass declares a missing resource");
+                }
+            }
+        }
+    }
+    if (capture.presentTarget != NoReference && capture.presentTarget >= resourceCount) {
+        reader.Fail("present target is a missing resource");
+    }
+
+    return capture;
+}
+
+RenderGraphCaptureRecorder::RenderGraphCaptureRecorder()
+    : m_capture(std::make_unique<RenderGraphCapture>()) {
+}
+
+void RenderGraphCaptureRecorder::BindResource(uint32_t resource, const void *object) {
+    if (object) {
+        m_references.try_emplace(object, resource);
+    }
+}
+
+uint32_t RenderGraphCaptureRecorder::AddObject(Texture *texture) {
+    RenderGraphCapture::Object object;
+    object.type = RenderPassResource::Type::Texture;
+    object.width = texture->width;
+    object.height = texture->height;
+    object.mipLevels = texture->mipLevels;
+    object.arraySize = texture->arraySize;
+    object.format = texture->format;
+    object.usage = texture->usage;
+
+    m_capture->objects.push_back(std::move(object));
+    m_objectBuffers.push_back(nullptr);
+    return static_cast<uint32_t>(m_capture->objects.size() - 1);
+}
+
+uint32_t RenderGraphCaptureRecorder::AddObject(Buffer *buffer) {
+    RenderGraphCapture::Object object;
+    object.type = RenderPassResource::Type::Buffer;
+    object.size = buffer->GetSize();
+    object.memoryType = buffer->GetMappedPtr() ? MemoryType::Upload : MemoryType::GPU;
+
+    m_capture->objects.push_back(std::move(object));
+    m_objectBuffers.push_back(buffer);
+    return static_cast<uint32_t>(m_capture->objects.size() - 1);
+}
+
+uint32_t RenderGraphCaptureRecorder::Reference(Texture *texture) {
+    if (!texture) {
+        return RenderGraphCapture::NoReference;
+    }
+
+    auto it = m_references.find(texture);
+    if (it != m_references.end()) {
+        return it->second;
+    }
+
+    uint32_t reference = AddObject(texture) | RenderGraphCapture::ObjectBit;
+    m_references.emplace(texture, reference);
+    return reference;
+}
+
+uint32_t RenderGraphCaptureRecorder::Reference(Buffer *buffer, BufferUsage usage) {
+    if (!buffer) {
+        return RenderGraphCapture::NoReference;
+    }
+
+    auto it = m_references.find(buffer);
+    uint32_t reference = it != m_references.end()
+                             ? it->second
+                             : m_references.emplace(buffer, AddObject(buffer) | RenderGraphCapture::ObjectBit).first->second;
+
+    // Stand-ins are created with every usage the frame bound the buffer with
+    if (reference & RenderGraphCapture::ObjectBit) {
+        m_capture->objects[reference & ~RenderGraphCapture::ObjectBit].bufferUsage |= (uint32_t) usage;
+    }
+    return reference;
+}
+
+uint32_t RenderGraphCaptureRecorder::Reference(Pipeline *pipeline) {
+    if (!pipeline) {
+        return RenderGraphCapture::NoReference;
+    }
+
+    auto [it, inserted] = m_pipelines.try_emplace(pipeline, m_capture->pipelineCount);
+    if (inserted) {
+        m_capture->pipelineCount++;
+    }
+    return it->second;
+}
+
+void RenderGraphCaptureRecorder::RecordPass(uint32_t pass, const CommandStream &recorded) {
+    CommandStream &commands = m_capture->passes[pass].commands;
+    commands.Reset();
+    commands.Append(recorded, [this](StreamObject type, void *object, uint32_t bufferUsage) {
+        switch (type) {
+            case StreamObject::Texture:
+                return ReferenceObject(Reference(static_cast<Texture *>(object)));
+            case StreamObject::Buffer:
+                return ReferenceObject(Reference(static_cast<Buffer *>(object), (BufferUsage) bufferUsage));
+            case StreamObject::Pipeline:
+                return ReferenceObject(Reference(static_cast<Pipeline *>(object)));
+            default:
+                return ReferenceObject(RenderGraphCapture::NoReference); // Not recorded, see CaptureCommandList
+        }
+    });
+    m_capture->commandCount += commands.GetCommandCount();
+}
+
+std::unique_ptr<RenderGraphCapture> RenderGraphCaptureRecorder::Finish() {
+    // Constants are written while recording, so the contents are taken once the frame is recorded
+    for (uint32_t i = 0; i < m_objectBuffers.size(); ++i) {
+        Buffer *buffer = m_objectBuffers[i];
+        const void *mapped = buffer ? buffer->GetMappedPtr() : nullptr;
+        if (mapped) {
+            const uint8_t *bytes = static_cast<const uint8_t *>(mapped);
+            m_capture->objects[i].payload.assign(bytes, bytes + buffer->GetSize());
+        }
+    }
+
+    m_references.clear();
+    m_pipelines.clear();
+    m_objectBuffers.clear();
+    return std::move(m_capture);
+}
+
+void CaptureCommandList::SetPipeline(Pipeline *pipeline) {
+    m_target->SetPipeline(pipeline);
+    m_recording.SetPipeline(pipeline);
+}
+
+void CaptureCommandList::SetViewport(const Viewport &viewport) {
+    m_target->SetViewport(viewport);
+    m_recording.SetViewport(viewport);
+}
+
+void CaptureCommandList::SetScissor(const Rect &scissor) {
+    m_target->SetScissor(scissor);
+    m_recording.SetScissor(scissor);
+}
+
+void CaptureCommandList::SetPrimitiveTopology(PrimitiveTopology topology) {
+    m_target->SetPrimitiveTopology(topology);
+    m_recording.SetPrimitiveTopology(topology);
+}
+
+void CaptureCommandList::SetVertexBuffer(Buffer *buffer, uint32_t slot) {
+    m_target->SetVertexBuffer(buffer, slot);
+    m_recording.SetVertexBuffer(buffer, slot);
+}
+
+void CaptureCommandList::SetIndexBuffer(Buffer *buffer) {
+    m_target->SetIndexBuffer(buffer);
+    m_recording.SetIndexBuffer(buffer);
+}
+
+void CaptureCommandList::SetConstantBuffer(Buffer *buffer, uint32_t slot, uint32_t offset) {
+    m_target->SetConstantBuffer(buffer, slot, offset);
+    m_recording.SetConstantBuffer(buffer, slot, offset);
+}
+
+void CaptureCommandList::SetTexture(Texture *texture, uint32_t slot) {
+    m_target->SetTexture(texture, slot);
+    m_recording.SetTexture(texture, slot);
+}
+
+void CaptureCommandList::Draw(uint32_t vertexCount, uint32_t startVertex) {
+    m_target->Draw(vertexCount, startVertex);
+    m_recording.Draw(vertexCount, startVertex);
+}
+
+void CaptureCommandList::DrawIndexed(uint32_t indexCount, uint32_t startIndex) {
+    m_target->DrawIndexed(indexCount, startIndex);
+    m_recording.DrawIndexed(indexCount, startIndex);
+}
+
+void CaptureCommandList::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount) {
+    m_target->DrawInstanced(vertexCount, instanceCount);
+    m_recording.DrawInstanced(vertexCount, instanceCount);
+}
+
+void CaptureCommandList::DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount) {
+    m_target->DrawIndexedInstanced(indexCount, instanceCount);
+    m_recording.DrawIndexedInstanced(indexCount, instanceCount);
+}
+
+void CaptureCommandList::Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) {
+    m_target->Dispatch(groupsX, groupsY, groupsZ);
+    m_recording.Dispatch(groupsX, groupsY, groupsZ);
+}
+
+void CaptureCommandList::ClearRenderTarget(Texture *texture, const float color[4]) {
+    m_target->ClearRenderTarget(texture, color);
+    m_recording.ClearRenderTarget(texture, color);
+}
+
+void CaptureCommandList::ClearDepthStencil(Texture *texture, float depth, uint8_t stencil) {
+    m_target->ClearDepthStencil(texture, depth, stencil);
+    m_recording.ClearDepthStencil(texture, depth, stencil);
+}
+
+void CaptureCommandList::CopyBuffer(Buffer *src, Buffer *dst, uint64_t size) {
+    m_target->CopyBuffer(src, dst, size);
+    m_recording.CopyBuffer(src, dst, size);
+}
+
+void CaptureCommandList::CopyTexture(Texture *src, Texture *dst) {
+    m_target->CopyTexture(src, dst);
+    m_recording.CopyTexture(src, dst);
+}
+
+void CaptureCommandList::CopyBufferToTexture(Buffer *src, Texture *dst) {
+    m_target->CopyBufferToTexture(src, dst);
+    m_recording.CopyBufferToTexture(src, dst);
+}
+
+void CaptureCommandList::ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) {
+    m_target->ResourceBarriers(barriers, count);
+    m_recording.ResourceBarriers(barriers, count);
+}
+
+void CaptureCommandList::TransitionTexture(Texture *texture, TextureUsage oldState, TextureUsage newState) {
+    m_target->TransitionTexture(texture, oldState, newState);
+    m_recording.TransitionTexture(texture, oldState, newState);
+}
+
+void CaptureCommandList::TransitionBuffer(Buffer *buffer, BufferUsage oldState, BufferUsage newState) {
+    m_target->TransitionBuffer(buffer, oldState, newState);
+    m_recording.TransitionBuffer(buffer, oldState, newState);
+}
+
+void CaptureCommandList::DiscardTexture(Texture *texture) {
+    m_target->DiscardTexture(texture);
+    m_recording.DiscardTexture(texture);
+}
+
+void CaptureCommandList::SetRenderTarget(Texture *renderTarget, Texture *depthStencil) {
+    m_target->SetRenderTarget(renderTarget, depthStencil);
+    m_recording.SetRenderTarget(renderTarget, depthStencil);
+}
+
+void CaptureCommandList::SetRenderTargets(Texture **renderTargets, uint32_t count, Texture *depthStencil) {
+    m_target->SetRenderTargets(renderTargets, count, depthStencil);
+    m_recording.SetRenderTargets(renderTargets, count, depthStencil);
+}
+
+void CaptureCommandList::BeginRenderPass(const RenderPassBeginInfo &info) {
+    m_target->BeginRenderPass(info);
+    m_recording.BeginRenderPass(info);
+}
+
+void CaptureCommandList::EndRenderPass() {
+    m_target->EndRenderPass();
+    m_recording.EndRenderPass();
+}
+
+RenderGraphReplay::RenderGraphReplay(Device *device, const RenderGraphCapture &capture)
+    : m_device(device), m_capture(capture) {
+    m_textures.resize(capture.objects.size(), nullptr);
+    m_buffers.resize(capture.objects.size(), nullptr);
+
+    bool uploaded = false;
+    for (uint32_t i = 0; i < capture.objects.size(); ++i) {
+        const RenderGraphCapture::Object &object = capture.objects[i];
+
+        if (object.type == RenderPassResource::Type::Texture) {
+            TextureCreateInfo desc{
+                .width = std::max(object.width, 1u),
+                .height = std::max(object.height, 1u),
+                .mipLevels = static_cast<uint16_t>(object.mipLevels),
+                .arraySize = object.arraySize,
+                .format = object.format,
+                .usage = object.usage,
+                .debugName = "Replay Texture",
+            };
+            m_textures[i] = device->CreateTexture(desc);
+            continue;
+        }
+
+        BufferCreateInfo desc{
+            .size = std::max<uint64_t>(object.size, 1),
+            .stride = 0,
+            .usage = object.bufferUsage ? (BufferUsage) object.bufferUsage : BufferUsage::Storage,
+            .memoryType = object.memoryType,
+            .debugName = "Replay Buffer",
+        };
+        Buffer *buffer = device->CreateBuffer(desc);
+        m_buffers[i] = buffer;
+
+        if (object.payload.empty()) {
+            continue;
+        }
+
+        // Upload buffers stay mapped like the ones they stand in for, anything else goes through the device
+        size_t size = std::min<size_t>(object.payload.size(), buffer->GetSize());
+        void *mapped = object.memoryType == MemoryType::Upload ? buffer->Map() : nullptr;
+        if (mapped) {
+            std::memcpy(mapped, object.payload.data(), size);
+        } else {
+            device->UploadBufferData(buffer, object.payload.data(), size);
+            uploaded = true;
+        }
+    }
+
+    if (uploaded) {
+        device->FlushUploads();
+    }
+}
+
+RenderGraphReplay::~RenderGraphReplay() {
+    for (Texture *texture: m_textures) {
+        if (texture) {
+            m_device->DestroyTexture(texture);
+        }
+    }
+    for (Buffer *buffer: m_buffers) {
+        if (buffer) {
+            m_device->DestroyBuffer(buffer);
+        }
+    }
+}
+
+void RenderGraphReplay::Declare(RenderGraph &graph) {
+    m_handles.resize(m_capture.resources.size());
+    m_passStreams.resize(m_capture.passes.size());
+    for (uint32_t i = 0; i < m_capture.resources.size(); ++i) {
+        const RenderGraphCapture::Resource &resource = m_capture.resources[i];
+        bool isTexture = resource.type == RenderPassResource::Type::Texture;
+
+        if (resource.isExternal && resource.object != RenderGraphCapture::NoReference) {
+            m_handles[i] = isTexture
+                               ? graph.RegisterExternalTexture(resource.name, m_textures[resource.object],
+                                                               (TextureUsage) resource.stateFlag).index
+                               : graph.RegisterExternalBuffer(resource.name, m_buffers[resource.object],
+                                                              (BufferUsage) resource.stateFlag).index;
+        } else {
+            m_handles[i] = isTexture ? graph.DeclareTexture(resource.name).index : graph.DeclareBuffer(resource.name).index;
+        }
+    }
+
+    if (m_capture.presentTarget != RenderGraphCapture::NoReference) {
+        graph.SetPresentTarget(RenderGraphTextureHandle{.index = m_handles[m_capture.presentTarget]});
+    }
+
+    FrameArena &arena = graph.GetFrameArena();
+    for (uint32_t passIndex = 0; passIndex < m_capture.passes.size(); ++passIndex) {
+        const RenderGraphCapture::Pass &captured = m_capture.passes[passIndex];
+
+        RenderPassPtr pass(arena.New<RenderPass>(captured.name, &arena));
+        for (RenderPassResource input: captured.inputs) {
+            input.resource = m_handles[input.resource];
+            pass->AddInput(input);
+        }
+        for (RenderPassResource output: captured.outputs) {
+            output.resource = m_handles[output.resource];
+            pass->AddOutput(output);
+        }
+
+        pass->SetEnabled(captured.enabled);
+        pass->SetQueue(captured.queue);
+        pass->SetHasSideEffects(captured.hasSideEffects);
+        pass->SetOptional(captured.optional);
+        pass->SetManualAttachments(captured.manualAttachments);
+        pass->SetExecuteFunc([this, passIndex](RenderPassContext &context) {
+            Replay(passIndex, context);
+        });
+
+        graph.AddPass(std::move(pass));
+    }
+}
+
+Texture *RenderGraphReplay::GetTexture(const RenderPassContext &context, uint32_t reference) const {
+    if (reference == RenderGraphCapture::NoReference) {
+        return nullptr;
+    }
+    if (reference & RenderGraphCapture::ObjectBit) {
+        uint32_t object = reference & ~RenderGraphCapture::ObjectBit;
+        return object < m_textures.size() ? m_textures[object] : nullptr;
+    }
+    return reference < m_handles.size() ? context.GetTexture({.index = m_handles[reference]}) : nullptr;
+}
+
+Buffer *RenderGraphReplay::GetBuffer(const RenderPassContext &context, uint32_t reference) const {
+    if (reference == RenderGraphCapture::NoReference) {
+        return nullptr;
+    }
+    if (reference & RenderGraphCapture::ObjectBit) {
+        uint32_t object = reference & ~RenderGraphCapture::ObjectBit;
+        return object < m_buffers.size() ? m_buffers[object] : nullptr;
+    }
+    return reference < m_handles.size() ? context.GetBuffer({.index = m_handles[reference]}) : nullptr;
+}
+
+Pipeline *RenderGraphReplay::GetPipeline(uint32_t reference) const {
+    return reference < m_pipelines.size() ? m_pipelines[reference] : nullptr;
+}
+
+void RenderGraphReplay::Replay(uint32_t passIndex, RenderPassContext &context) const {
+    // Runs on record workers like any pass callback. A pass records once per frame, so its stream is only
+    // touched by the worker recording it.
+    CommandStream &stream = m_passStreams[passIndex];
+    stream.Reset();
+    stream.Append(m_capture.passes[passIndex].commands, [&](StreamObject type, void *object, uint32_t) -> void * {
+        const uint32_t reference = ObjectReference(object);
+        switch (type) {
+            case StreamObject::Texture:
+                return GetTexture(context, reference);
+            case StreamObject::Buffer:
+                return GetBuffer(context, reference);
+            case StreamObject::Pipeline:
+                return GetPipeline(reference); // Skipped by Translate when the caller has none
+            default:
+                return nullptr;
+        }
+    });
+
+    const CommandStream::TranslateResult result = stream.Translate(context.commandList, false);
+    m_replayedCommands.fetch_add(result.commands + result.filtered, std::memory_order_relaxed);
+    m_replayedBarriers.fetch_add(result.barriers, std::memory_order_relaxed);
+}
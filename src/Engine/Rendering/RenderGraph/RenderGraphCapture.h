@@ -0,0 +1,276 @@
+//
+// Created by 2401Lucas on 2025-12-11.
+//
+
+#ifndef GPU_PARTICLE_SIM_RENDERGRAPHCAPTURE_H
+#define GPU_PARTICLE_SIM_RENDERGRAPHCAPTURE_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+#include "RenderPass.h"
+#include "Rendering/RHI/Buffer.h"
+#include "Rendering/RHI/CommandList.h"
+#include "Rendering/RHI/CommandStream.h"
+#include "Rendering/RHI/Device.h"
+#include "Rendering/RHI/Texture.h"
+
+class RenderGraph;
+
+/// <summary>
+/// One frame of a RenderGraph: every declared resource and pass, the external registrations and the
+/// commands each pass callback recorded. Barriers, attachments and everything else the graph records
+/// itself are not part of it, a replay compiles them again. See RenderGraph::CaptureNextFrame.
+/// </summary>
+struct RenderGraphCapture {
+    static constexpr uint32_t NoReference = UINT32_MAX;
+
+    // References in the command streams, stored in place of the object pointers: a resource index, or
+    // an object index with ObjectBit set for textures and buffers the graph does not know about (vertex
+    // buffers, constants, ...). Pipelines are referenced by index.
+    static constexpr uint32_t ObjectBit = 1u << 31;
+
+    /// <summary>
+    /// Texture or buffer a replay creates a stand-in for
+    /// </summary>
+    struct Object {
+        RenderPassResource::Type type = RenderPassResource::Type::Texture;
+
+        // For textures
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipLevels = 1;
+        uint32_t arraySize = 1;
+        TextureFormat format = TextureFormat::Undefined;
+        TextureUsage usage = TextureUsage::ShaderResource;
+
+        // For buffers
+        uint64_t size = 0;
+        uint32_t bufferUsage = 0; // BufferUsage bits of every binding seen
+        MemoryType memoryType = MemoryType::GPU;
+        std::vector<uint8_t> payload; // Contents of a mapped buffer once the frame was recorded
+    };
+
+    /// <summary>
+    /// Resource declared on the graph, in handle order
+    /// </summary>
+    struct Resource {
+        std::string name;
+        RenderPassResource::Type type = RenderPassResource::Type::Texture;
+        bool isExternal = false;
+        uint32_t stateFlag = 0; // State of an external at the start of the frame
+        uint32_t object = NoReference; // Texture or buffer an external was registered with
+    };
+
+    struct Pass {
+        std::string name;
+        QueueType queue = QueueType::Graphics;
+        bool enabled = true;
+        bool hasSideEffects = false;
+        bool optional = false;
+        bool manualAttachments = false;
+        std::vector<RenderPassResource> inputs;
+        std::vector<RenderPassResource> outputs;
+
+        // What the callback recorded, empty when the pass was culled or recorded nothing
+        CommandStream commands;
+    };
+
+    std::vector<Resource> resources;
+    std::vector<Pass> passes; // Declaration order
+    std::vector<Object> objects;
+    uint32_t commandCount = 0;
+    uint32_t pipelineCount = 0; // Pipelines cannot be serialized, a replay may supply its own
+    uint32_t presentTarget = NoReference;
+
+    /// <summary>
+    /// Write the capture to a binary file. Only readable by a build with the same capture version.
+    /// </summary>
+    bool Save(const std::string &filename) const;
+
+    /// <summary>
+    /// Read a capture written by Save, throws when the file is missing or not a capture of this version
+    /// </summary>
+    static RenderGraphCapture Load(const std::string &filename);
+};
+
+/// <summary>
+/// Fills a RenderGraphCapture while a frame records. The graph binds every resolved resource first so
+/// commands on it reference the resource rather than the texture or buffer it resolved to this frame.
+/// </summary>
+class RenderGraphCaptureRecorder {
+public:
+    RenderGraphCaptureRecorder();
+
+    RenderGraphCapture &GetCapture() { return *m_capture; }
+
+    void BindResource(uint32_t resource, const void *object);
+
+    uint32_t AddObject(Texture *texture);
+
+    uint32_t AddObject(Buffer *buffer);
+
+    uint32_t Reference(Texture *texture);
+
+    uint32_t Reference(Buffer *buffer, BufferUsage usage);
+
+    uint32_t Reference(Pipeline *pipeline);
+
+    /// <summary>
+    /// Keep the commands a pass callback recorded, with their objects swapped for references
+    /// </summary>
+    void RecordPass(uint32_t pass, const CommandStream &recorded);
+
+    /// <summary>
+    /// Copy the contents of mapped buffers and hand the capture over
+    /// </summary>
+    std::unique_ptr<RenderGraphCapture> Finish();
+
+private:
+    std::unique_ptr<RenderGraphCapture> m_capture;
+    std::unordered_map<const void *, uint32_t> m_references;
+    std::unordered_map<const Pipeline *, uint32_t> m_pipelines;
+    std::vector<Buffer *> m_objectBuffers; // Per object, null for textures
+};
+
+/// <summary>
+/// Forwards a pass callback's commands to the real command list and records them into a
+/// DeferredCommandList. Queries are forwarded only, their heaps belong to the graph.
+/// </summary>
+class CaptureCommandList final : public CommandList {
+public:
+    explicit CaptureCommandList(CommandList *target) : m_target(target) {
+        m_recording.Begin();
+    }
+
+    const CommandStream &GetStream() const { return m_recording.GetStream(); }
+
+    void Begin(BindlessDescriptorManager *bindlessManager) override { m_target->Begin(bindlessManager); }
+
+    void End() override { m_target->End(); }
+
+    void SetPipeline(Pipeline *pipeline) override;
+
+    void SetViewport(const Viewport &viewport) override;
+
+    void SetScissor(const Rect &scissor) override;
+
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+
+    void SetVertexBuffer(Buffer *buffer, uint32_t slot) override;
+
+    void SetIndexBuffer(Buffer *buffer) override;
+
+    void SetConstantBuffer(Buffer *buffer, uint32_t slot, uint32_t offset) override;
+
+    void SetTexture(Texture *texture, uint32_t slot) override;
+
+    void Draw(uint32_t vertexCount, uint32_t startVertex) override;
+
+    void DrawIndexed(uint32_t indexCount, uint32_t startIndex) override;
+
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount) override;
+
+    void DrawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount) override;
+
+    void Dispatch(uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ) override;
+
+    void ClearRenderTarget(Texture *texture, const float color[4]) override;
+
+    void ClearDepthStencil(Texture *texture, float depth, uint8_t stencil) override;
+
+    void CopyBuffer(Buffer *src, Buffer *dst, uint64_t size) override;
+
+    void CopyTexture(Texture *src, Texture *dst) override;
+
+    void CopyBufferToTexture(Buffer *src, Texture *dst) override;
+
+    void ResourceBarriers(const ResourceBarrier *barriers, uint32_t count) override;
+
+    void TransitionTexture(Texture *texture, TextureUsage oldState, TextureUsage newState) override;
+
+    void TransitionBuffer(Buffer *buffer, BufferUsage oldState, BufferUsage newState) override;
+
+    void DiscardTexture(Texture *texture) override;
+
+    void WriteTimestamp(QueryHeap *queryHeap, uint32_t index) override { m_target->WriteTimestamp(queryHeap, index); }
+
+    void ResolveQueries(QueryHeap *queryHeap, uint32_t first, uint32_t count,
+                        Buffer *destination, uint64_t offset) override {
+        m_target->ResolveQueries(queryHeap, first, count, destination, offset);
+    }
+
+    void SetRenderTarget(Texture *renderTarget, Texture *depthStencil) override;
+
+    void SetRenderTargets(Texture **renderTargets, uint32_t count, Texture *depthStencil) override;
+
+    void BeginRenderPass(const RenderPassBeginInfo &info) override;
+
+    void EndRenderPass() override;
+
+private:
+    CommandList *m_target;
+    DeferredCommandList m_recording;
+};
+
+/// <summary>
+/// Rebuilds a captured frame on any device: stand-ins are created for every captured texture and buffer,
+/// mapped buffer contents are uploaded once, and each Declare adds the captured passes with callbacks
+/// that issue the captured commands again. Transients are allocated by the graph as usual.
+/// </summary>
+class RenderGraphReplay {
+public:
+    RenderGraphReplay(Device *device, const RenderGraphCapture &capture);
+
+    ~RenderGraphReplay();
+
+    RenderGraphReplay(const RenderGraphReplay &) = delete;
+
+    RenderGraphReplay &operator=(const RenderGraphReplay &) = delete;
+
+    /// <summary>
+    /// Pipelines bound by SetPipeline, indexed like the capture's. Without them SetPipeline is skipped.
+    /// </summary>
+    void SetPipelines(std::vector<Pipeline *> pipelines) { m_pipelines = std::move(pipelines); }
+
+    /// <summary>
+    /// Register the externals, set the present target and add the passes, once per frame like a renderer
+    /// declares its frame. The replay must outlive the frame's Execute.
+    /// </summary>
+    void Declare(RenderGraph &graph);
+
+    /// <summary>
+    /// Captured commands issued again since construction, one per command of every pass that executed
+    /// </summary>
+    uint64_t GetReplayedCommandCount() const { return m_replayedCommands.load(std::memory_order_relaxed); }
+
+    /// <summary>
+    /// Barriers among the replayed commands, the graph's own barriers are not included
+    /// </summary>
+    uint64_t GetReplayedBarrierCount() const { return m_replayedBarriers.load(std::memory_order_relaxed); }
+
+private:
+    Device *m_device;
+    const RenderGraphCapture &m_capture;
+    std::vector<Texture *> m_textures; // Per object, null for buffers
+    std::vector<Buffer *> m_buffers; // Per object, null for textures
+    std::vector<uint32_t> m_handles; // Graph handle index per captured resource
+    std::vector<Pipeline *> m_pipelines;
+    mutable std::vector<CommandStream> m_passStreams; // Per pass, its commands with this frame's objects
+    mutable std::atomic<uint64_t> m_replayedCommands{0}; // Added to by the record workers
+    mutable std::atomic<uint64_t> m_replayedBarriers{0};
+
+    Texture *GetTexture(const RenderPassContext &context, uint32_t reference) const;
+
+    Buffer *GetBuffer(const RenderPassContext &context, uint32_t reference) const;
+
+    Pipeline *GetPipeline(uint32_t reference) const;
+
+    void Replay(uint32_t pass, RenderPassContext &context) const;
+};
+
+#endif //GPU_PARTICLE_SIM_RENDERGRAPHCAPTURE_H
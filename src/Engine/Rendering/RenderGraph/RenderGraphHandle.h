@@ -0,0 +1,39 @@
+//
+// Created by 2401Lucas on 2025-11-20.
+//
+
+#ifndef GPU_PARTICLE_SIM_RENDERGRAPHHANDLE_H
+#define GPU_PARTICLE_SIM_RENDERGRAPHHANDLE_H
+
+#include <cstdint>
+
+// Type-safe virtual resource handle. Index into the RenderGraph's flat resource arrays,
+// stable for the lifetime of the graph once a name has been declared.
+template<typename T>
+struct RenderGraphHandle {
+    static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+    uint32_t index = InvalidIndex;
+
+    bool IsValid() const { return index != InvalidIndex; }
+
+    bool operator==(const RenderGraphHandle &other) const {
+        return index == other.index;
+    }
+};
+
+// Specific resource types
+struct RenderGraphTextureTag {
+};
+
+struct RenderGraphBufferTag {
+};
+
+struct RenderGraphHistoryTag {
+};
+
+using RenderGraphTextureHandle = RenderGraphHandle<RenderGraphTextureTag>;
+using RenderGraphBufferHandle = RenderGraphHandle<RenderGraphBufferTag>;
+using RenderGraphHistoryHandle = RenderGraphHandle<RenderGraphHistoryTag>; // Set of texture versions, see DeclareHistoryTexture
+
+#endif //GPU_PARTICLE_SIM_RENDERGRAPHHANDLE_H
@@ -0,0 +1,147 @@
+//
+// Created by 2401Lucas on 2025-12-04.
+//
+
+#include "RenderGraph.h"
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace {
+    const char *FormatName(RenderPassResource::Format format) {
+        switch (format) {
+            case RenderPassResource::Format::RGBA8:
+                return "RGBA8";
+            case RenderPassResource::Format::RGBA16F:
+                return "RGBA16F";
+            case RenderPassResource::Format::RGBA32F:
+                return "RGBA32F";
+            case RenderPassResource::Format::Depth32:
+                return "Depth32";
+            case RenderPassResource::Format::R32:
+                return "R32";
+        }
+        return "Unknown";
+    }
+
+    const char *QueueName(QueueType queue) {
+        switch (queue) {
+            case QueueType::Graphics:
+                return "Graphics";
+            case QueueType::Compute:
+                return "Compute";
+            case QueueType::Transfer:
+                return "Transfer";
+        }
+        return "Unknown";
+    }
+
+    const char *HeapClassName(HeapResourceClass resourceClass) {
+        switch (resourceClass) {
+            case HeapResourceClass::Buffers:
+                return "Buffers";
+            case HeapResourceClass::Textures:
+                return "Textures";
+            case HeapResourceClass::RenderTargets:
+                return "RenderTargets";
+        }
+        return "Unknown";
+    }
+
+    const char *DegradationName(RenderGraph::DegradationPolicy policy) {
+        switch (policy) {
+            case RenderGraph::DegradationPolicy::Reschedule:
+                return "Reschedule";
+            case RenderGraph::DegradationPolicy::ReduceResolution:
+                return "ReduceResolution";
+            case RenderGraph::DegradationPolicy::DropOptionalPasses:
+                return "DropOptionalPasses";
+            default:
+                break;
+        }
+        return "Unknown";
+    }
+}
+
+std::string RenderGraph::GetMemoryReportJson() const {
+    const MemoryReport &report = m_memoryReport;
+
+    nlohmann::json j;
+    j["fenceValue"] = report.fenceValue;
+    j["frameIndex"] = report.frameIndex;
+    j["memoryUsed"] = report.memoryUsed;
+    j["memoryUnaliased"] = report.memoryUnaliased;
+    j["peak"] = {
+        {"pass", report.peakPass},
+        {"name", report.peakPass < report.passes.size() ? report.passes[report.peakPass].name : ""},
+        {"bytes", report.peakBytes}
+    };
+
+    if (report.budgetBytes != 0) {
+        nlohmann::json degradations = nlohmann::json::array();
+        for (uint32_t i = 0; i < (uint32_t) DegradationPolicy::Count; ++i) {
+            if (report.appliedDegradations & (1u << i)) {
+                degradations.push_back(DegradationName((DegradationPolicy) i));
+            }
+        }
+        j["budget"] = {
+            {"bytes", report.budgetBytes},
+            {"degradations", degradations}
+        };
+    }
+
+    nlohmann::json passes = nlohmann::json::array();
+    for (const auto &pass: report.passes) {
+        passes.push_back({
+            {"name", pass.name},
+            {"queue", QueueName(pass.queue)},
+            {"aliveBytes", pass.aliveBytes}
+        });
+    }
+    j["passes"] = passes;
+
+    nlohmann::json transients = nlohmann::json::array();
+    for (const auto &transient: report.transients) {
+        nlohmann::json transientJson;
+        transientJson["name"] = transient.name;
+        if (transient.type == RenderPassResource::Type::Texture) {
+            transientJson["type"] = "Texture";
+            transientJson["format"] = FormatName(transient.format);
+            transientJson["width"] = transient.width;
+            transientJson["height"] = transient.height;
+            transientJson["mipLevels"] = transient.mipLevels;
+        } else {
+            transientJson["type"] = "Buffer";
+            transientJson["bufferSize"] = transient.bufferSize;
+        }
+        transientJson["allocationSize"] = transient.allocationSize;
+        transientJson["alignment"] = transient.alignment;
+        transientJson["firstUse"] = transient.firstUse;
+        transientJson["lastUse"] = transient.lastUse;
+        transientJson["aliased"] = transient.aliased;
+        if (transient.aliased) {
+            transientJson["heap"] = transient.heap;
+            transientJson["heapOffset"] = transient.heapOffset;
+        }
+        transients.push_back(transientJson);
+    }
+    j["transients"] = transients;
+
+    nlohmann::json heaps = nlohmann::json::array();
+    for (const auto &heap: report.heaps) {
+        heaps.push_back({
+            {"resourceClass", HeapClassName(heap.resourceClass)},
+            {"size", heap.size}
+        });
+    }
+    j["heaps"] = heaps;
+
+    return j.dump(2);
+}
+
+bool RenderGraph::SaveMemoryReport(const std::string &filename) const {
+    std::ofstream ofs(filename);
+    if (!ofs) return false;
+
+    ofs << GetMemoryReportJson();
+    return true;
+}
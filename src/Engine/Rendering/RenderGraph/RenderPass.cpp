@@ -3,41 +3,48 @@
 //
 
 #include "RenderPass.h"
+#include "RenderGraph.h"
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
-// TODO: Implement this
-Texture *RenderPassContext::GetTexture(const std::string &name) const {
-    // Search in input textures
-    for (auto *texture: inputTextures) {
-        return texture;
+Texture *RenderPassContext::GetTexture(RenderGraphTextureHandle handle) const {
+    if (!textures || handle.index >= resourceCount) {
+        return nullptr;
     }
+    return textures[handle.index];
+}
 
-    // Search in output textures
-    for (auto *texture: outputTextures) {
-        return texture;
+Buffer *RenderPassContext::GetBuffer(RenderGraphBufferHandle handle) const {
+    if (!buffers || handle.index >= resourceCount) {
+        return nullptr;
     }
-
-    return nullptr;
+    return buffers[handle.index];
 }
 
-// TODO: Implement this
-Buffer *RenderPassContext::GetBuffer(const std::string &name) const {
-    // Similar implementation as GetTexture
-    for (auto *buffer: inputBuffers) {
-        return buffer;
+Rect RenderPassContext::GetRenderArea(RenderGraphTextureHandle handle) const {
+    Texture *texture = GetTexture(handle);
+    if (!texture) {
+        return {};
     }
 
-    for (auto *buffer: outputBuffers) {
-        return buffer;
-    }
+    // Rounded up so the edge pixels of the scaled image are always covered
+    auto scale = [&](uint32_t size) {
+        return static_cast<int32_t>(std::max(std::ceil(static_cast<float>(size) * renderScale), 1.0f));
+    };
+    return {0, 0, scale(texture->width), scale(texture->height)};
+}
 
-    return nullptr;
+Viewport RenderPassContext::GetRenderViewport(RenderGraphTextureHandle handle) const {
+    Rect area = GetRenderArea(handle);
+    return {0.0f, 0.0f, static_cast<float>(area.right), static_cast<float>(area.bottom), 0.0f, 1.0f};
 }
 
-RenderPass::RenderPass(const std::string &name)
-    : m_name(name)
-      , m_enabled(true) {
+RenderPass::RenderPass(std::string_view name, std::pmr::memory_resource *memory)
+    : m_name(name, memory)
+      , m_enabled(true)
+      , m_inputs(memory)
+      , m_outputs(memory) {
 }
 
 RenderPass::~RenderPass() {
@@ -63,21 +70,23 @@ void RenderPass::Execute(RenderPassContext &context) {
     }
 
     if (!m_executeFunc) {
-        throw std::runtime_error("RenderPass '" + m_name + "' has no execute function");
+        throw std::runtime_error("RenderPass '" + std::string(m_name) + "' has no execute function");
     }
 
     m_executeFunc(context);
 }
 
-RenderPassBuilder::RenderPassBuilder(const std::string &name)
-    : m_pass(std::make_unique<RenderPass>(name)) {
+RenderPassBuilder::RenderPassBuilder(RenderGraph &graph, std::string_view name)
+    : m_graph(graph) {
+    FrameArena &arena = graph.GetFrameArena();
+    m_pass.reset(arena.New<RenderPass>(name, &arena));
 }
 
-RenderPassBuilder &RenderPassBuilder::ReadTexture(const std::string &name,
+RenderPassBuilder &RenderPassBuilder::ReadTexture(RenderGraphTextureHandle handle,
                                                   TextureUsage state,
                                                   PipelineStage stage) {
     RenderPassResource resource{
-        .name = name,
+        .resource = handle.index,
         .type = RenderPassResource::Type::Texture,
         .access = RenderPassResource::Access::Read,
         .stateFlag = static_cast<uint32_t>(state),
@@ -85,16 +94,29 @@ RenderPassBuilder &RenderPassBuilder::ReadTexture(const std::string &name,
     };
 
     m_pass->AddInput(resource);
+    m_lastInInputs = true;
+    m_lastInOutputs = false;
     return *this;
 }
 
-RenderPassBuilder &RenderPassBuilder::WriteTexture(const std::string &name,
+RenderPassBuilder &RenderPassBuilder::ReadTexture(std::string_view name,
+                                                  TextureUsage state,
+                                                  PipelineStage stage,
+                                                  RenderGraphTextureHandle *outHandle) {
+    RenderGraphTextureHandle handle = m_graph.DeclareTexture(name);
+    if (outHandle) {
+        *outHandle = handle;
+    }
+    return ReadTexture(handle, state, stage);
+}
+
+RenderPassBuilder &RenderPassBuilder::WriteTexture(RenderGraphTextureHandle handle,
                                                    uint32_t width, uint32_t height,
                                                    RenderPassResource::Format format,
                                                    TextureUsage state,
                                                    PipelineStage stage) {
     RenderPassResource resource{
-        .name = name,
+        .resource = handle.index,
         .type = RenderPassResource::Type::Texture,
         .access = RenderPassResource::Access::Write,
         .stateFlag = static_cast<uint32_t>(state),
@@ -105,14 +127,30 @@ RenderPassBuilder &RenderPassBuilder::WriteTexture(const std::string &name,
     };
 
     m_pass->AddOutput(resource);
+    m_lastInInputs = false;
+    m_lastInOutputs = true;
     return *this;
 }
 
-RenderPassBuilder &RenderPassBuilder::ReadWriteTexture(const std::string &name, uint32_t width, uint32_t height,
+RenderPassBuilder &RenderPassBuilder::WriteTexture(std::string_view name,
+                                                   uint32_t width, uint32_t height,
+                                                   RenderPassResource::Format format,
+                                                   TextureUsage state,
+                                                   PipelineStage stage,
+                                                   RenderGraphTextureHandle *outHandle) {
+    RenderGraphTextureHandle handle = m_graph.DeclareTexture(name);
+    if (outHandle) {
+        *outHandle = handle;
+    }
+    return WriteTexture(handle, width, height, format, state, stage);
+}
+
+RenderPassBuilder &RenderPassBuilder::ReadWriteTexture(RenderGraphTextureHandle handle,
+                                                       uint32_t width, uint32_t height,
                                                        RenderPassResource::Format format, TextureUsage state,
                                                        PipelineStage stage) {
     RenderPassResource resource{
-        .name = name,
+        .resource = handle.index,
         .type = RenderPassResource::Type::Texture,
         .access = RenderPassResource::Access::ReadWrite,
         .stateFlag = static_cast<uint32_t>(state),
@@ -123,13 +161,26 @@ RenderPassBuilder &RenderPassBuilder::ReadWriteTexture(const std::string &name,
     };
 
     m_pass->AddReadWrite(resource);
+    m_lastInInputs = true;
+    m_lastInOutputs = true;
     return *this;
 }
 
-RenderPassBuilder &RenderPassBuilder::ReadBuffer(const std::string &name, BufferUsage state,
+RenderPassBuilder &RenderPassBuilder::ReadWriteTexture(std::string_view name, uint32_t width, uint32_t height,
+                                                       RenderPassResource::Format format, TextureUsage state,
+                                                       PipelineStage stage,
+                                                       RenderGraphTextureHandle *outHandle) {
+    RenderGraphTextureHandle handle = m_graph.DeclareTexture(name);
+    if (outHandle) {
+        *outHandle = handle;
+    }
+    return ReadWriteTexture(handle, width, height, format, state, stage);
+}
+
+RenderPassBuilder &RenderPassBuilder::ReadBuffer(RenderGraphBufferHandle handle, BufferUsage state,
                                                  PipelineStage stage) {
     RenderPassResource resource{
-        .name = name,
+        .resource = handle.index,
         .type = RenderPassResource::Type::Buffer,
         .access = RenderPassResource::Access::Read,
         .stateFlag = static_cast<uint32_t>(state),
@@ -137,13 +188,24 @@ RenderPassBuilder &RenderPassBuilder::ReadBuffer(const std::string &name, Buffer
     };
 
     m_pass->AddInput(resource);
+    m_lastInInputs = true;
+    m_lastInOutputs = false;
     return *this;
 }
 
-RenderPassBuilder &RenderPassBuilder::WriteBuffer(const std::string &name, uint64_t size, BufferUsage state,
+RenderPassBuilder &RenderPassBuilder::ReadBuffer(std::string_view name, BufferUsage state,
+                                                 PipelineStage stage, RenderGraphBufferHandle *outHandle) {
+    RenderGraphBufferHandle handle = m_graph.DeclareBuffer(name);
+    if (outHandle) {
+        *outHandle = handle;
+    }
+    return ReadBuffer(handle, state, stage);
+}
+
+RenderPassBuilder &RenderPassBuilder::WriteBuffer(RenderGraphBufferHandle handle, uint64_t size, BufferUsage state,
                                                   PipelineStage stage) {
     RenderPassResource resource{
-        .name = name,
+        .resource = handle.index,
         .type = RenderPassResource::Type::Buffer,
         .access = RenderPassResource::Access::Write,
         .stateFlag = static_cast<uint32_t>(state),
@@ -152,11 +214,146 @@ RenderPassBuilder &RenderPassBuilder::WriteBuffer(const std::string &name, uint6
     };
 
     m_pass->AddOutput(resource);
+    m_lastInInputs = false;
+    m_lastInOutputs = true;
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::WriteBuffer(std::string_view name, uint64_t size, BufferUsage state,
+                                                  PipelineStage stage, RenderGraphBufferHandle *outHandle) {
+    RenderGraphBufferHandle handle = m_graph.DeclareBuffer(name);
+    if (outHandle) {
+        *outHandle = handle;
+    }
+    return WriteBuffer(handle, size, state, stage);
+}
+
+RenderPassBuilder &RenderPassBuilder::ReadWriteBuffer(RenderGraphBufferHandle handle, uint64_t size,
+                                                      BufferUsage state, PipelineStage stage) {
+    RenderPassResource resource{
+        .resource = handle.index,
+        .type = RenderPassResource::Type::Buffer,
+        .access = RenderPassResource::Access::ReadWrite,
+        .stateFlag = static_cast<uint32_t>(state),
+        .stage = stage,
+        .size = size,
+    };
+
+    m_pass->AddReadWrite(resource);
+    m_lastInInputs = true;
+    m_lastInOutputs = true;
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::ReadWriteBuffer(std::string_view name, uint64_t size, BufferUsage state,
+                                                      PipelineStage stage, RenderGraphBufferHandle *outHandle) {
+    RenderGraphBufferHandle handle = m_graph.DeclareBuffer(name);
+    if (outHandle) {
+        *outHandle = handle;
+    }
+    return ReadWriteBuffer(handle, size, state, stage);
+}
+
+template<typename Func>
+void RenderPassBuilder::ModifyLastDeclaration(Func func) {
+    if (!m_lastInInputs && !m_lastInOutputs) {
+        throw std::runtime_error("RenderPass '" + std::string(m_pass->GetName()) + "' has no resource declared yet");
+    }
+
+    if (m_lastInInputs) {
+        func(m_pass->m_inputs.back());
+    }
+    if (m_lastInOutputs) {
+        func(m_pass->m_outputs.back());
+    }
+}
+
+RenderPassBuilder &RenderPassBuilder::Subresources(uint32_t baseMip, uint32_t mipCount,
+                                                   uint32_t baseSlice, uint32_t sliceCount) {
+    ModifyLastDeclaration([&](RenderPassResource &resource) {
+        if (resource.type != RenderPassResource::Type::Texture) {
+            throw std::runtime_error("Subresource ranges only apply to textures");
+        }
+        resource.range = {baseMip, mipCount, baseSlice, sliceCount};
+    });
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::MipLevels(uint32_t mipLevels) {
+    ModifyLastDeclaration([&](RenderPassResource &resource) {
+        // The writer creates the texture, a read could not change its mip count
+        if (resource.type != RenderPassResource::Type::Texture || resource.access == RenderPassResource::Access::Read) {
+            throw std::runtime_error("Only written textures can have mip levels");
+        }
+        resource.mipLevels = std::max(mipLevels, 1u);
+    });
+    return *this;
+}
+
+namespace {
+    void ValidateAttachment(const RenderPassResource &resource) {
+        TextureUsage state = (TextureUsage) resource.stateFlag;
+        if (resource.type != RenderPassResource::Type::Texture || resource.access == RenderPassResource::Access::Read ||
+            (state != TextureUsage::RenderTarget && state != TextureUsage::DepthStencil)) {
+            throw std::runtime_error("Load and store ops only apply to written render target and depth textures");
+        }
+    }
+}
+
+RenderPassBuilder &RenderPassBuilder::Load(AttachmentLoadOp loadOp, const ClearValue &clearValue) {
+    ModifyLastDeclaration([&](RenderPassResource &resource) {
+        ValidateAttachment(resource);
+
+        // The pass reads what it writes (e.g. blending), so the contents have to be loaded
+        if (resource.access == RenderPassResource::Access::ReadWrite && loadOp != AttachmentLoadOp::Load) {
+            throw std::runtime_error("Read-write attachments must be loaded");
+        }
+        resource.loadOp = loadOp;
+        resource.clearValue = clearValue;
+    });
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::Store(AttachmentStoreOp storeOp) {
+    ModifyLastDeclaration([&](RenderPassResource &resource) {
+        ValidateAttachment(resource);
+        resource.storeOp = storeOp;
+    });
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::Downscalable() {
+    ModifyLastDeclaration([&](RenderPassResource &resource) {
+        if (resource.type != RenderPassResource::Type::Texture || resource.access == RenderPassResource::Access::Read) {
+            throw std::runtime_error("Only written textures can be downscaled");
+        }
+        resource.downscalable = true;
+    });
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::Scaled() {
+    ModifyLastDeclaration([&](RenderPassResource &resource) {
+        if (resource.type != RenderPassResource::Type::Texture || resource.access == RenderPassResource::Access::Read) {
+            throw std::runtime_error("Only written textures can be scaled");
+        }
+        resource.scaled = true;
+    });
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::NonOverlapping() {
+    ModifyLastDeclaration([&](RenderPassResource &resource) {
+        if (!resource.IsUnorderedAccess()) {
+            throw std::runtime_error("Only unordered access can be declared non-overlapping");
+        }
+        resource.nonOverlapping = true;
+    });
     return *this;
 }
 
 RenderPassBuilder &RenderPassBuilder::Execute(RenderPassExecuteFunc func) {
-    m_pass->SetExecuteFunc(func);
+    m_pass->SetExecuteFunc(std::move(func));
     return *this;
 }
 
@@ -165,7 +362,27 @@ RenderPassBuilder &RenderPassBuilder::Enable(bool enabled) {
     return *this;
 }
 
-std::unique_ptr<RenderPass> RenderPassBuilder::Build() {
+RenderPassBuilder &RenderPassBuilder::Queue(QueueType queue) {
+    m_pass->SetQueue(queue);
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::SideEffect() {
+    m_pass->SetHasSideEffects(true);
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::Optional() {
+    m_pass->SetOptional(true);
+    return *this;
+}
+
+RenderPassBuilder &RenderPassBuilder::ManualAttachments() {
+    m_pass->SetManualAttachments(true);
+    return *this;
+}
+
+RenderPassPtr RenderPassBuilder::Build() {
     if (!m_pass->IsValid()) {
         throw std::runtime_error("RenderPass must have an execute function");
     }
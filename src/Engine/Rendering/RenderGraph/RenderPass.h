@@ -6,18 +6,41 @@
 #define GPU_PARTICLE_SIM_RENDERPASS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <functional>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
 #include <cstdint>
+#include <cstddef>
 
 #include "Rendering/RHI/CommandList.h"
+#include "Rendering/RHI/CommandQueue.h"
+#include "RenderGraphHandle.h"
+
+class RenderGraph;
+
+/// <summary>
+/// Mip levels and array slices of a texture a pass uses. The default covers the whole texture.
+/// </summary>
+struct SubresourceRange {
+    static constexpr uint32_t All = UINT32_MAX;
+
+    uint32_t baseMip = 0;
+    uint32_t mipCount = All;
+    uint32_t baseSlice = 0;
+    uint32_t sliceCount = All;
+
+    bool IsWhole() const { return baseMip == 0 && mipCount == All && baseSlice == 0 && sliceCount == All; }
+};
 
 /// <summary>
 /// Resource description for render pass inputs/outputs
 /// </summary>
 struct RenderPassResource {
-    std::string name;
+    // Index into the RenderGraph's resource arrays (see RenderGraphHandle)
+    uint32_t resource = RenderGraphTextureHandle::InvalidIndex;
 
     enum class Type {
         Texture,
@@ -33,11 +56,19 @@ struct RenderPassResource {
     // Can be cast to either Texture or Buffer State flags
     uint32_t stateFlag = 0;
 
+    // Unordered access that touches different elements than neighbouring non-overlapping uses,
+    // see RenderPassBuilder::NonOverlapping
+    bool nonOverlapping = false;
+
     PipelineStage stage = PipelineStage::PixelShader;
 
     // For textures
     uint32_t width = 0;
     uint32_t height = 0;
+    uint32_t mipLevels = 1; // Mip count of a transient, set by the declaring write
+    bool downscalable = false; // The declaring write allows a smaller transient, see RenderPassBuilder::Downscalable
+    bool scaled = false; // Width and height are at render scale 1, see RenderPassBuilder::Scaled
+    SubresourceRange range; // Subresources the barriers of this use target
 
     enum class Format {
         RGBA8,
@@ -49,6 +80,17 @@ struct RenderPassResource {
 
     // For buffers
     uint64_t size = 0;
+
+    // For render target and depth writes, see RenderPassBuilder::Load/Store
+    AttachmentLoadOp loadOp = AttachmentLoadOp::Load;
+    AttachmentStoreOp storeOp = AttachmentStoreOp::Store;
+    ClearValue clearValue;
+
+    bool IsUnorderedAccess() const {
+        return type == Type::Texture
+                   ? (TextureUsage) stateFlag == TextureUsage::UnorderedAccess
+                   : (BufferUsage) stateFlag == BufferUsage::UnorderedAccess;
+    }
 };
 
 /// <summary>
@@ -58,35 +100,125 @@ struct RenderPassResource {
 struct RenderPassContext {
     CommandList *commandList = nullptr;
 
-    // Resources for this pass
-    std::vector<Texture *> inputTextures;
-    std::vector<Texture *> outputTextures;
-    std::vector<Buffer *> inputBuffers;
-    std::vector<Buffer *> outputBuffers;
+    // Resolved resources for the current frame, indexed by handle. Owned by the RenderGraph.
+    Texture *const *textures = nullptr;
+    Buffer *const *buffers = nullptr;
+    uint32_t resourceCount = 0;
 
     // Frame info
     uint32_t frameIndex = 0;
     float deltaTime = 0.0f;
 
-    // Helper to get resource by name
-    Texture *GetTexture(const std::string &name) const;
+    // Share of a scaled texture's allocated size rendered this frame: the render scale over the maximum
+    float renderScale = 1.0f;
+
+    // O(1) lookup of a resource declared by the pass
+    Texture *GetTexture(RenderGraphTextureHandle handle) const;
+
+    Buffer *GetBuffer(RenderGraphBufferHandle handle) const;
+
+    /// <summary>
+    /// Part of a scaled texture rendered this frame, from its top left corner. Scaled attachments bound
+    /// by the graph already get it as viewport and scissor; samplers reading a scaled texture multiply
+    /// their coordinates by renderScale.
+    /// </summary>
+    Rect GetRenderArea(RenderGraphTextureHandle handle) const;
 
-    Buffer *GetBuffer(const std::string &name) const;
+    Viewport GetRenderViewport(RenderGraphTextureHandle handle) const;
 };
 
-using RenderPassExecuteFunc = std::function<void(RenderPassContext &)>;
+/// <summary>
+/// Move-only callable for pass execution, stored inline so setting one never allocates.
+/// Lambdas capturing more than InlineSize bytes are rejected at compile time; capture a pointer
+/// to the data instead (per-pass data can live in RenderGraph::GetFrameArena()).
+/// </summary>
+class RenderPassExecuteFunc {
+public:
+    static constexpr size_t InlineSize = 64;
+
+    RenderPassExecuteFunc() = default;
+
+    RenderPassExecuteFunc(std::nullptr_t) {
+    }
+
+    template<typename Func> requires (!std::is_same_v<std::decay_t<Func>, RenderPassExecuteFunc> &&
+                                      std::is_invocable_v<std::decay_t<Func> &, RenderPassContext &>)
+    RenderPassExecuteFunc(Func &&func) {
+        using Callable = std::decay_t<Func>;
+        static_assert(sizeof(Callable) <= InlineSize, "Execute callback captures too much, capture a pointer instead");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "Execute callback is over-aligned");
+        static_assert(std::is_nothrow_move_constructible_v<Callable>, "Execute callback must be nothrow movable");
+
+        new(m_storage) Callable(std::forward<Func>(func));
+        m_invoke = [](void *storage, RenderPassContext &context) {
+            (*static_cast<Callable *>(storage))(context);
+        };
+        m_relocate = [](void *destination, void *source) {
+            Callable *callable = static_cast<Callable *>(source);
+            if (destination) {
+                new(destination) Callable(std::move(*callable));
+            }
+            callable->~Callable();
+        };
+    }
+
+    RenderPassExecuteFunc(RenderPassExecuteFunc &&other) noexcept { MoveFrom(other); }
+
+    RenderPassExecuteFunc &operator=(RenderPassExecuteFunc &&other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    RenderPassExecuteFunc(const RenderPassExecuteFunc &) = delete;
+
+    RenderPassExecuteFunc &operator=(const RenderPassExecuteFunc &) = delete;
+
+    ~RenderPassExecuteFunc() { Reset(); }
+
+    explicit operator bool() const { return m_invoke != nullptr; }
+
+    void operator()(RenderPassContext &context) { m_invoke(m_storage, context); }
+
+private:
+    alignas(std::max_align_t) std::byte m_storage[InlineSize];
+    void (*m_invoke)(void *, RenderPassContext &) = nullptr;
+    void (*m_relocate)(void *, void *) = nullptr; // Move into the first storage and destroy the second
+
+    void MoveFrom(RenderPassExecuteFunc &other) {
+        if (other.m_invoke) {
+            other.m_relocate(m_storage, other.m_storage);
+            m_invoke = other.m_invoke;
+            m_relocate = other.m_relocate;
+            other.m_invoke = nullptr;
+            other.m_relocate = nullptr;
+        }
+    }
+
+    void Reset() {
+        if (m_invoke) {
+            m_relocate(nullptr, m_storage);
+            m_invoke = nullptr;
+            m_relocate = nullptr;
+        }
+    }
+};
 
 /// <summary>
 /// Represents a single rendering pass in the render graph.
 /// A pass declares its resource dependencies and execution function.
+/// Name and declarations are allocated from the given memory resource, the graph's frame arena
+/// when the pass comes from a RenderPassBuilder.
 /// </summary>
 class RenderPass {
 public:
-    RenderPass(const std::string &name);
+    RenderPass(std::string_view name, std::pmr::memory_resource *memory = std::pmr::get_default_resource());
 
     ~RenderPass();
 
-    void SetExecuteFunc(RenderPassExecuteFunc func) { m_executeFunc = func; }
+    void SetExecuteFunc(RenderPassExecuteFunc func) { m_executeFunc = std::move(func); }
 
     void AddInput(const RenderPassResource &desc);
 
@@ -96,59 +228,195 @@ public:
 
     void SetEnabled(bool enabled) { m_enabled = enabled; }
 
-    const std::string &GetName() const { return m_name; }
+    /// <summary>
+    /// Queue the pass is recorded on. Falls back to graphics when the graph has no queue of that type.
+    /// </summary>
+    void SetQueue(QueueType queue) { m_queue = queue; }
+
+    /// <summary>
+    /// Keep the pass even when no other pass reads its outputs (e.g. readback, debug capture)
+    /// </summary>
+    void SetHasSideEffects(bool hasSideEffects) { m_hasSideEffects = hasSideEffects; }
+
+    /// <summary>
+    /// The graph may drop the pass to fit its memory budget. Passes reading its outputs then get
+    /// null resources from RenderPassContext and must skip that work.
+    /// </summary>
+    void SetOptional(bool optional) { m_optional = optional; }
+
+    /// <summary>
+    /// The pass binds, clears and discards its render targets itself. The graph then leaves its
+    /// attachments alone, load and store ops may not be set on its writes.
+    /// </summary>
+    void SetManualAttachments(bool manualAttachments) { m_manualAttachments = manualAttachments; }
+
+    std::string_view GetName() const { return m_name; }
     bool IsEnabled() const { return m_enabled; }
+    QueueType GetQueue() const { return m_queue; }
+    bool HasSideEffects() const { return m_hasSideEffects; }
+    bool IsOptional() const { return m_optional; }
+    bool HasManualAttachments() const { return m_manualAttachments; }
 
-    const bool IsValid() const { return m_executeFunc != nullptr; }
+    const bool IsValid() const { return static_cast<bool>(m_executeFunc); }
 
-    const std::vector<RenderPassResource> &GetInputs() const { return m_inputs; }
-    const std::vector<RenderPassResource> &GetOutputs() const { return m_outputs; }
+    const std::pmr::vector<RenderPassResource> &GetInputs() const { return m_inputs; }
+    const std::pmr::vector<RenderPassResource> &GetOutputs() const { return m_outputs; }
 
     void Execute(RenderPassContext &context);
 
 private:
     friend class RenderGraph;
+    friend class RenderPassBuilder;
 
-    std::string m_name;
+    std::pmr::string m_name;
     bool m_enabled = true;
+    QueueType m_queue = QueueType::Graphics;
+    bool m_hasSideEffects = false;
+    bool m_optional = false;
+    bool m_manualAttachments = false;
 
-    std::vector<RenderPassResource> m_inputs;
-    std::vector<RenderPassResource> m_outputs;
+    std::pmr::vector<RenderPassResource> m_inputs;
+    std::pmr::vector<RenderPassResource> m_outputs;
 
     RenderPassExecuteFunc m_executeFunc;
 };
 
+/// <summary>
+/// Passes live in the graph's frame arena, so deleting one only runs its destructor
+/// </summary>
+struct RenderPassDeleter {
+    void operator()(RenderPass *pass) const { pass->~RenderPass(); }
+};
+
+using RenderPassPtr = std::unique_ptr<RenderPass, RenderPassDeleter>;
+
 /// <summary>
 /// Builder for constructing render passes.
 /// Provides a "fluent" API for configuring passes.
+///
+/// Resources are referenced by handle. The name overloads declare the name on the graph
+/// (one lookup at setup time) and optionally return the handle through the last parameter.
 /// </summary>
 class RenderPassBuilder {
 public:
-    RenderPassBuilder(const std::string &name);
+    RenderPassBuilder(RenderGraph &graph, std::string_view name);
+
+    RenderPassBuilder &ReadTexture(RenderGraphTextureHandle handle, TextureUsage state, PipelineStage stage);
 
-    RenderPassBuilder &ReadTexture(const std::string &name, TextureUsage state, PipelineStage stage);
+    RenderPassBuilder &ReadTexture(std::string_view name, TextureUsage state, PipelineStage stage,
+                                   RenderGraphTextureHandle *outHandle = nullptr);
 
-    RenderPassBuilder &WriteTexture(const std::string &name,
+    RenderPassBuilder &WriteTexture(RenderGraphTextureHandle handle,
                                     uint32_t width, uint32_t height,
                                     RenderPassResource::Format format,
                                     TextureUsage state, PipelineStage stage);
 
-    RenderPassBuilder &ReadWriteTexture(const std::string &name, uint32_t width, uint32_t height,
+    RenderPassBuilder &WriteTexture(std::string_view name,
+                                    uint32_t width, uint32_t height,
+                                    RenderPassResource::Format format,
+                                    TextureUsage state, PipelineStage stage,
+                                    RenderGraphTextureHandle *outHandle = nullptr);
+
+    RenderPassBuilder &ReadWriteTexture(RenderGraphTextureHandle handle, uint32_t width, uint32_t height,
                                         RenderPassResource::Format format,
                                         TextureUsage state, PipelineStage stage);
 
-    RenderPassBuilder &ReadBuffer(const std::string &name, BufferUsage state, PipelineStage stage);
+    RenderPassBuilder &ReadWriteTexture(std::string_view name, uint32_t width, uint32_t height,
+                                        RenderPassResource::Format format,
+                                        TextureUsage state, PipelineStage stage,
+                                        RenderGraphTextureHandle *outHandle = nullptr);
+
+    RenderPassBuilder &ReadBuffer(RenderGraphBufferHandle handle, BufferUsage state, PipelineStage stage);
+
+    RenderPassBuilder &ReadBuffer(std::string_view name, BufferUsage state, PipelineStage stage,
+                                  RenderGraphBufferHandle *outHandle = nullptr);
 
-    RenderPassBuilder &WriteBuffer(const std::string &name, uint64_t size,
+    RenderPassBuilder &WriteBuffer(RenderGraphBufferHandle handle, uint64_t size,
                                    BufferUsage state, PipelineStage stage);
 
+    RenderPassBuilder &WriteBuffer(std::string_view name, uint64_t size,
+                                   BufferUsage state, PipelineStage stage,
+                                   RenderGraphBufferHandle *outHandle = nullptr);
+
+    RenderPassBuilder &ReadWriteBuffer(RenderGraphBufferHandle handle, uint64_t size,
+                                       BufferUsage state, PipelineStage stage);
+
+    RenderPassBuilder &ReadWriteBuffer(std::string_view name, uint64_t size,
+                                       BufferUsage state, PipelineStage stage,
+                                       RenderGraphBufferHandle *outHandle = nullptr);
+
+    /// <summary>
+    /// Restrict the texture declared last to a mip/slice range, e.g. read mip N and write mip N + 1
+    /// of the same texture. Only those subresources are transitioned for this pass.
+    /// </summary>
+    RenderPassBuilder &Subresources(uint32_t baseMip, uint32_t mipCount,
+                                    uint32_t baseSlice = 0, uint32_t sliceCount = SubresourceRange::All);
+
+    /// <summary>
+    /// Mip count of the transient texture written last. Throws if the last declaration is a read.
+    /// </summary>
+    RenderPassBuilder &MipLevels(uint32_t mipLevels);
+
+    /// <summary>
+    /// Load op of the render target or depth texture written last. Clear fills it with clearValue,
+    /// DontCare promises the pass writes every pixel it later reads. Defaults to Load; the graph
+    /// turns Load into DontCare on a transient's first use since there is nothing to load.
+    /// </summary>
+    RenderPassBuilder &Load(AttachmentLoadOp loadOp, const ClearValue &clearValue = {});
+
+    /// <summary>
+    /// Store op of the render target or depth texture written last. Discard when nothing reads the
+    /// result again; the graph already discards transients after their last use.
+    /// </summary>
+    RenderPassBuilder &Store(AttachmentStoreOp storeOp);
+
+    /// <summary>
+    /// Let the graph allocate the transient texture declared last (by its first write) at a reduced
+    /// resolution when over the memory budget. Read the size from the resolved texture when recording,
+    /// and mark every attachment bound together with it.
+    /// </summary>
+    RenderPassBuilder &Downscalable();
+
+    /// <summary>
+    /// Declare the transient texture written last at render scale 1. The graph allocates it once at
+    /// the maximum render scale and renders into a sub-rectangle at the current scale, so changing the
+    /// scale neither recompiles nor reallocates. See RenderGraph::SetRenderScale.
+    /// </summary>
+    RenderPassBuilder &Scaled();
+
+    /// <summary>
+    /// Promise that the unordered access declared last touches different elements than the adjacent
+    /// uses of the resource that are also marked, so back-to-back dispatches need no UAV barrier between them
+    /// </summary>
+    RenderPassBuilder &NonOverlapping();
+
     RenderPassBuilder &Execute(RenderPassExecuteFunc func);
 
     RenderPassBuilder &Enable(bool enabled);
 
-    std::unique_ptr<RenderPass> Build();
+    RenderPassBuilder &Queue(QueueType queue);
+
+    RenderPassBuilder &SideEffect();
+
+    RenderPassBuilder &Optional();
+
+    /// <summary>
+    /// Keep the graph from binding the pass' render targets, for callbacks that bind and clear their own.
+    /// See RenderPass::SetManualAttachments.
+    /// </summary>
+    RenderPassBuilder &ManualAttachments();
+
+    RenderPassPtr Build();
 
 private:
-    std::unique_ptr<RenderPass> m_pass;
+    RenderGraph &m_graph;
+    RenderPassPtr m_pass;
+
+    // Where the last declaration went, ReadWrite declarations go to both lists
+    bool m_lastInInputs = false;
+    bool m_lastInOutputs = false;
+
+    template<typename Func>
+    void ModifyLastDeclaration(Func func);
 };
 #endif //GPU_PARTICLE_SIM_RENDERPASS_H
@@ -0,0 +1,32 @@
+//
+// Created by 2401Lucas on 2025-12-09.
+//
+
+#include "RenderScaleController.h"
+#include <algorithm>
+#include <cmath>
+
+RenderScaleController::RenderScaleController(const RenderScaleSettings &settings)
+    : m_settings(settings), m_scale(settings.maxScale) {
+}
+
+float RenderScaleController::Update(float gpuTime) {
+    if (gpuTime <= 0.0f || m_settings.targetGpuTime <= 0.0f) {
+        return m_scale;
+    }
+
+    float error = gpuTime / m_settings.targetGpuTime;
+    if (std::abs(error - 1.0f) <= m_settings.tolerance) {
+        return m_scale;
+    }
+
+    // Pixel count goes with the square of the scale
+    float target = m_scale / std::sqrt(error);
+    target = std::clamp(target, m_scale - m_settings.maxStep, m_scale + m_settings.maxStep);
+    m_scale = std::clamp(target, m_settings.minScale, m_settings.maxScale);
+    return m_scale;
+}
+
+void RenderScaleController::Reset(float scale) {
+    m_scale = std::clamp(scale, m_settings.minScale, m_settings.maxScale);
+}
@@ -0,0 +1,44 @@
+//
+// Created by 2401Lucas on 2025-12-09.
+//
+
+#ifndef GPU_PARTICLE_SIM_RENDERSCALECONTROLLER_H
+#define GPU_PARTICLE_SIM_RENDERSCALECONTROLLER_H
+
+/// <summary>
+/// Target GPU time and scale limits of a RenderScaleController
+/// </summary>
+struct RenderScaleSettings {
+    float targetGpuTime = 16.0f; // ms
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    float tolerance = 0.05f; // Share of the target
+    float maxStep = 0.05f;
+};
+
+/// <summary>
+/// Picks the render scale of the next frame from the measured GPU time. GPU time is assumed to follow
+/// the rendered pixel count, so the scale moves by the square root of target / measured time, at most
+/// maxStep per update. Measurements within the tolerance of the target leave the scale alone, so
+/// noise does not make the resolution wobble.
+/// </summary>
+class RenderScaleController {
+public:
+    explicit RenderScaleController(const RenderScaleSettings &settings = {});
+
+    /// <summary>
+    /// Feed the GPU time of a finished frame and get the scale to render the next one at
+    /// </summary>
+    float Update(float gpuTime);
+
+    void Reset(float scale);
+
+    float GetScale() const { return m_scale; }
+    const RenderScaleSettings &GetSettings() const { return m_settings; }
+
+private:
+    RenderScaleSettings m_settings;
+    float m_scale;
+};
+
+#endif //GPU_PARTICLE_SIM_RENDERSCALECONTROLLER_H
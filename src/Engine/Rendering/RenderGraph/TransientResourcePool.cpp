@@ -0,0 +1,212 @@
+//
+// Created by 2401Lucas on 2025-11-22.
+//
+
+#include "TransientResourcePool.h"
+
+#include <functional>
+#include <iterator>
+
+namespace {
+    void HashCombine(size_t &seed, uint64_t value) {
+        seed ^= std::hash<uint64_t>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+}
+
+bool TransientResourcePool::Key::operator==(const Key &other) const {
+    return isTexture == other.isTexture &&
+           width == other.width &&
+           height == other.height &&
+           depth == other.depth &&
+           mipLevels == other.mipLevels &&
+           arraySize == other.arraySize &&
+           format == other.format &&
+           size == other.size &&
+           stride == other.stride &&
+           memoryType == other.memoryType &&
+           usage == other.usage;
+}
+
+size_t TransientResourcePool::KeyHash::operator()(const Key &key) const {
+    size_t seed = 0;
+    HashCombine(seed, key.isTexture);
+    HashCombine(seed, key.width);
+    HashCombine(seed, key.height);
+    HashCombine(seed, key.depth);
+    HashCombine(seed, key.mipLevels);
+    HashCombine(seed, key.arraySize);
+    HashCombine(seed, static_cast<uint64_t>(key.format));
+    HashCombine(seed, key.size);
+    HashCombine(seed, key.stride);
+    HashCombine(seed, static_cast<uint64_t>(key.memoryType));
+    HashCombine(seed, key.usage);
+    return seed;
+}
+
+TransientResourcePool::TransientResourcePool(Device *device)
+    : m_device(device) {
+}
+
+TransientResourcePool::~TransientResourcePool() {
+    Clear();
+}
+
+uint32_t TransientResourcePool::AcquireTexture(const TextureCreateInfo &desc, uint64_t completedFenceValue,
+                                               uint32_t stateFlag) {
+    Key key;
+    key.isTexture = true;
+    key.width = desc.width;
+    key.height = desc.height;
+    key.depth = desc.depth;
+    key.mipLevels = desc.mipLevels;
+    key.arraySize = desc.arraySize;
+    key.format = desc.format;
+    key.usage = static_cast<uint32_t>(desc.usage);
+
+    uint32_t entry = FindAvailable(key, completedFenceValue, stateFlag);
+    if (entry != InvalidEntry) {
+        return entry;
+    }
+
+    Entry created;
+    created.key = key;
+    created.texture = m_device->CreateTexture(desc);
+    created.allocationSize = m_device->GetTextureAllocationInfo(desc).size;
+    created.stateFlag = static_cast<uint32_t>(desc.usage);
+
+    return AddEntry(created);
+}
+
+uint32_t TransientResourcePool::AcquireBuffer(const BufferCreateInfo &desc, uint64_t completedFenceValue,
+                                              uint32_t stateFlag) {
+    Key key;
+    key.isTexture = false;
+    key.size = desc.size;
+    key.stride = desc.stride;
+    key.memoryType = desc.memoryType;
+    key.usage = static_cast<uint32_t>(desc.usage);
+
+    uint32_t entry = FindAvailable(key, completedFenceValue, stateFlag);
+    if (entry != InvalidEntry) {
+        return entry;
+    }
+
+    Entry created;
+    created.key = key;
+    created.buffer = m_device->CreateBuffer(desc);
+    created.allocationSize = m_device->GetBufferAllocationInfo(desc).size;
+    created.stateFlag = static_cast<uint32_t>(desc.usage);
+
+    return AddEntry(created);
+}
+
+void TransientResourcePool::Release(uint32_t entry, uint32_t stateFlag, uint64_t fenceValue) {
+    Entry &released = m_entries[entry];
+    if (!released.inUse) {
+        return;
+    }
+
+    released.inUse = false;
+    released.stateFlag = stateFlag;
+    released.fenceValue = fenceValue;
+    released.lastUsedFrame = m_frame;
+
+    m_available[released.key].push_back(entry);
+}
+
+void TransientResourcePool::NextFrame(uint64_t completedFenceValue) {
+    m_frame++;
+
+    for (auto it = m_available.begin(); it != m_available.end();) {
+        auto &entries = it->second;
+
+        for (size_t i = 0; i < entries.size();) {
+            const Entry &entry = m_entries[entries[i]];
+            bool idle = m_frame - entry.lastUsedFrame > m_maxIdleFrames;
+            if (idle && entry.fenceValue <= completedFenceValue) {
+                DestroyEntry(entries[i]);
+                entries[i] = entries.back();
+                entries.pop_back();
+                m_statistics.evictions++;
+            } else {
+                ++i;
+            }
+        }
+
+        it = entries.empty() ? m_available.erase(it) : std::next(it);
+    }
+}
+
+void TransientResourcePool::Clear() {
+    for (uint32_t i = 0; i < m_entries.size(); ++i) {
+        DestroyEntry(i);
+    }
+
+    m_entries.clear();
+    m_freeEntries.clear();
+    m_available.clear();
+}
+
+uint32_t TransientResourcePool::FindAvailable(const Key &key, uint64_t completedFenceValue, uint32_t stateFlag) {
+    auto it = m_available.find(key);
+    if (it != m_available.end()) {
+        auto &entries = it->second;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            uint32_t entry = entries[i];
+            if (m_entries[entry].fenceValue <= completedFenceValue &&
+                (stateFlag == AnyState || m_entries[entry].stateFlag == stateFlag)) {
+                entries[i] = entries.back();
+                entries.pop_back();
+
+                m_entries[entry].inUse = true;
+                m_entries[entry].lastUsedFrame = m_frame;
+                m_statistics.hits++;
+                return entry;
+            }
+        }
+    }
+
+    m_statistics.misses++;
+    return InvalidEntry;
+}
+
+uint32_t TransientResourcePool::AddEntry(const Entry &entry) {
+    uint32_t index;
+    if (!m_freeEntries.empty()) {
+        index = m_freeEntries.back();
+        m_freeEntries.pop_back();
+        m_entries[index] = entry;
+    } else {
+        index = static_cast<uint32_t>(m_entries.size());
+        m_entries.push_back(entry);
+    }
+
+    Entry &added = m_entries[index];
+    added.inUse = true;
+    added.lastUsedFrame = m_frame;
+
+    m_statistics.residentBytes += added.allocationSize;
+    m_statistics.resourceCount++;
+
+    return index;
+}
+
+void TransientResourcePool::DestroyEntry(uint32_t entry) {
+    Entry &destroyed = m_entries[entry];
+    if (!destroyed.texture && !destroyed.buffer) {
+        return;
+    }
+
+    if (destroyed.texture) {
+        m_device->DestroyTexture(destroyed.texture);
+    }
+    if (destroyed.buffer) {
+        m_device->DestroyBuffer(destroyed.buffer);
+    }
+
+    m_statistics.residentBytes -= destroyed.allocationSize;
+    m_statistics.resourceCount--;
+
+    destroyed = Entry{};
+    m_freeEntries.push_back(entry);
+}
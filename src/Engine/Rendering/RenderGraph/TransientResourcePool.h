@@ -0,0 +1,133 @@
+//
+// Created by 2401Lucas on 2025-11-22.
+//
+
+#ifndef GPU_PARTICLE_SIM_TRANSIENTRESOURCEPOOL_H
+#define GPU_PARTICLE_SIM_TRANSIENTRESOURCEPOOL_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Rendering/RHI/Device.h"
+
+/// <summary>
+/// Pool of committed transient resources keyed by their descriptor.
+///
+/// Any request with an identical descriptor reuses a pooled resource once the GPU has passed the
+/// fence value it was released with, regardless of the name it was declared under or the frame
+/// slot it was last used in. Resources that stay idle for too long are evicted.
+/// </summary>
+class TransientResourcePool {
+public:
+    static constexpr uint32_t InvalidEntry = UINT32_MAX;
+    static constexpr uint32_t AnyState = UINT32_MAX;
+
+    explicit TransientResourcePool(Device *device);
+
+    ~TransientResourcePool();
+
+    TransientResourcePool(const TransientResourcePool &) = delete;
+
+    TransientResourcePool &operator=(const TransientResourcePool &) = delete;
+
+    /// <summary>
+    /// Get a texture matching the descriptor whose last use is complete, creating one on a miss.
+    /// Returns the pool entry, which stays owned by the caller until Release. Unless stateFlag is
+    /// AnyState only entries released in that state are reused.
+    /// </summary>
+    uint32_t AcquireTexture(const TextureCreateInfo &desc, uint64_t completedFenceValue,
+                            uint32_t stateFlag = AnyState);
+
+    uint32_t AcquireBuffer(const BufferCreateInfo &desc, uint64_t completedFenceValue, uint32_t stateFlag = AnyState);
+
+    /// <summary>
+    /// Return an entry to the pool. It becomes reusable once the queue reaches fenceValue.
+    /// stateFlag is the state the resource was left in, handed to the next user.
+    /// </summary>
+    void Release(uint32_t entry, uint32_t stateFlag, uint64_t fenceValue);
+
+    Texture *GetTexture(uint32_t entry) const { return m_entries[entry].texture; }
+    Buffer *GetBuffer(uint32_t entry) const { return m_entries[entry].buffer; }
+    uint32_t GetStateFlag(uint32_t entry) const { return m_entries[entry].stateFlag; }
+    uint64_t GetAllocationSize(uint32_t entry) const { return m_entries[entry].allocationSize; }
+
+    /// <summary>
+    /// Advance the pool's frame counter and evict resources idle for longer than the limit
+    /// </summary>
+    void NextFrame(uint64_t completedFenceValue);
+
+    /// <summary>
+    /// Destroy every pooled resource. The GPU must be idle.
+    /// </summary>
+    void Clear();
+
+    void SetMaxIdleFrames(uint32_t frames) { m_maxIdleFrames = frames; }
+
+    struct Statistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t residentBytes = 0;
+        uint32_t resourceCount = 0;
+    };
+
+    const Statistics &GetStatistics() const { return m_statistics; }
+
+private:
+    struct Key {
+        bool isTexture = false;
+
+        // Textures
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        uint32_t mipLevels = 0;
+        uint32_t arraySize = 0;
+        TextureFormat format = TextureFormat::Undefined;
+
+        // Buffers
+        uint64_t size = 0;
+        uint32_t stride = 0;
+        MemoryType memoryType = MemoryType::GPU;
+
+        uint32_t usage = 0;
+
+        bool operator==(const Key &other) const;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &key) const;
+    };
+
+    struct Entry {
+        Key key;
+        Texture *texture = nullptr;
+        Buffer *buffer = nullptr;
+        uint64_t allocationSize = 0;
+        uint32_t stateFlag = 0;
+
+        uint64_t fenceValue = 0; // GPU work using the entry is done once the queue reaches this
+        uint64_t lastUsedFrame = 0;
+        bool inUse = false;
+    };
+
+    Device *m_device;
+
+    std::vector<Entry> m_entries;
+    std::vector<uint32_t> m_freeEntries; // Destroyed entries whose slot can be reused
+    std::unordered_map<Key, std::vector<uint32_t>, KeyHash> m_available;
+
+    uint64_t m_frame = 0;
+    uint32_t m_maxIdleFrames = 120;
+
+    Statistics m_statistics;
+
+    uint32_t FindAvailable(const Key &key, uint64_t completedFenceValue, uint32_t stateFlag);
+
+    uint32_t AddEntry(const Entry &entry);
+
+    void DestroyEntry(uint32_t entry);
+};
+
+#endif //GPU_PARTICLE_SIM_TRANSIENTRESOURCEPOOL_H
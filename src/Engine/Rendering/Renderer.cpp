@@ -25,11 +25,30 @@ Renderer::Renderer(Window *window, Device *device, ResourceManager *resourceMana
     };
     m_graphicsQueue = std::unique_ptr<CommandQueue>(m_device->CreateCommandQueue(graphicsQueueCI));
 
+    CommandQueueCreateInfo computeQueueCI = {
+        .type = QueueType::Compute,
+        .debugName = "Async Compute Queue"
+    };
+    m_computeQueue = std::unique_ptr<CommandQueue>(m_device->CreateCommandQueue(computeQueueCI));
+
     m_swapchain = std::unique_ptr<Swapchain>(
         m_device->CreateSwapchain(window->getHwnd(), m_graphicsQueue.get(),
                                   window->getWidth(), window->getHeight()));
 
     m_renderGraph = std::make_unique<RenderGraph>(m_device, m_graphicsQueue.get(), FrameCount);
+    m_renderGraph->SetQueue(QueueType::Compute, m_computeQueue.get());
+
+    m_recordingThreads = std::make_unique<ThreadPool>();
+    m_renderGraph->SetThreadPool(m_recordingThreads.get());
+    m_renderGraph->SetPassTimings(true);
+
+    // Transients get most of the budget, the rest is meshes, textures and the swapchain
+    m_renderGraph->SetMemoryBudget(0.75f);
+    m_renderGraph->SetDegradationPolicies({
+        RenderGraph::DegradationPolicy::Reschedule,
+        RenderGraph::DegradationPolicy::ReduceResolution,
+        RenderGraph::DegradationPolicy::DropOptionalPasses,
+    });
 
     CreateFrameResources();
 
@@ -134,6 +153,10 @@ void Renderer::BeginFrame() {
     m_renderGraph->NextFrame();
     m_frameIndex = nextFrameIndex;
 
+    // Declared from last frame's batches and compiled on a worker while the application submits
+    BuildRenderGraph();
+    m_renderGraph->CompileAsync();
+
     m_isFrameStarted = true;
     m_submissions.clear();
     m_batches.clear();
@@ -149,12 +172,16 @@ void Renderer::EndFrame() {
     // Update per-frame data before building render graph
     UpdatePerFrameData();
     ProcessSubmissions();
-    BuildRenderGraph();
-    CommandList *commandList = m_renderGraph->Execute();
 
-    // Submit to queue with fence
+    // A late change (e.g. the first frame with shadow casters) is compiled synchronously by Execute
+    if (GetRenderGraphInputs() != m_renderGraphInputs) {
+        BuildRenderGraph();
+    }
+
+    // The graph submits its own command lists; its last submission is on the graphics queue
+    // and waits for the compute queue, so the frame fence covers both
     m_currentFenceValue++;
-    m_graphicsQueue->Execute(commandList);
+    m_renderGraph->Execute(m_currentFenceValue);
     m_graphicsQueue->Signal(m_currentFenceValue);
 
     // Track fence value for this frame
@@ -184,12 +211,15 @@ void Renderer::SetDirectionalLight(const glm::vec3 &direction, const glm::vec3 &
 }
 
 void Renderer::Resize() {
+    // Transients are pooled by descriptor, old sizes are evicted once idle
     WaitForGPU();
-    m_renderGraph->Flush();
     m_width = m_window->getWidth();
     m_height = m_window->getHeight();
     m_camera->SetAspectRatio(m_window->getAspectRatio());
     m_swapchain->Resize(m_width, m_height);
+
+    // The backbuffers were recreated, a graph declared this frame must register them again
+    m_renderGraphInputs = {};
 }
 
 void Renderer::UpdatePerFrameData() {
@@ -337,17 +367,27 @@ void Renderer::BatchSubmissions() {
     m_statistics.instanceCount = totalInstances;
 }
 
+Renderer::RenderGraphInputs Renderer::GetRenderGraphInputs() const {
+    return {
+        .width = m_width,
+        .height = m_height,
+        .shadowPass = m_shadowsEnabled && !m_batches.empty(),
+        .postProcessing = m_postProcessingEnabled,
+    };
+}
+
 void Renderer::BuildRenderGraph() {
+    m_renderGraphInputs = GetRenderGraphInputs();
     m_renderGraph->Clear();
 
     // Register backbuffer as external resource
     Texture *backbuffer = m_swapchain->GetSwapchainBuffer(m_frameIndex);
-    m_renderGraph->RegisterExternalTexture("Backbuffer", backbuffer, TextureUsage::Present);
-    m_renderGraph->SetPresentTarget("Backbuffer");
+    m_backbufferHandle = m_renderGraph->RegisterExternalTexture("Backbuffer", backbuffer, TextureUsage::Present);
+    m_renderGraph->SetPresentTarget(m_backbufferHandle);
 
     // Shadow pass (if enabled)
-    if (m_shadowsEnabled && !m_batches.empty()) {
-        // auto shadowPass = RenderPassBuilder("Shadow")
+    if (m_renderGraphInputs.shadowPass) {
+        // auto shadowPass = RenderPassBuilder(*m_renderGraph, "Shadow")
         //         .WriteTexture("ShadowMap", m_shadowMapSize, m_shadowMapSize,
         //                       RenderPassResource::Format::Depth32,
         //                       TextureUsage::DepthStencil)
@@ -360,14 +400,16 @@ void Renderer::BuildRenderGraph() {
     }
 
     // Main geometry pass
-    auto mainPass = RenderPassBuilder("Main")
+    auto mainPass = RenderPassBuilder(*m_renderGraph, "Main")
             // .ReadTexture("ShadowMap", TextureUsage::ShaderResource, PipelineStage::PixelShader)
-            .WriteTexture("Backbuffer", m_width, m_height,
+            .WriteTexture(m_backbufferHandle, m_width, m_height,
                           RenderPassResource::Format::RGBA16F,
                           TextureUsage::RenderTarget, PipelineStage::RenderTarget)
+            .Load(AttachmentLoadOp::Clear, {.color = {0.1f, 0.1f, 0.15f, 1.0f}})
             .WriteTexture("SceneDepth", m_width, m_height,
                           RenderPassResource::Format::Depth32,
-                          TextureUsage::DepthStencil, PipelineStage::DepthStencil)
+                          TextureUsage::DepthStencil, PipelineStage::DepthStencil, &m_sceneDepthHandle)
+            .Load(AttachmentLoadOp::Clear, {.depth = 1.0f})
             .Execute([this](RenderPassContext &ctx) {
                 RenderMain(ctx);
             })
@@ -376,8 +418,8 @@ void Renderer::BuildRenderGraph() {
     m_renderGraph->AddPass(std::move(mainPass));
 
     // Post-process (if enabled)
-    if (m_postProcessingEnabled) {
-        // auto postPass = RenderPassBuilder("PostProcess")
+    if (m_renderGraphInputs.postProcessing) {
+        // auto postPass = RenderPassBuilder(*m_renderGraph, "PostProcess")
         //         .ReadTexture("SceneColor", TextureUsage::ShaderResource)
         //         .WriteTexture("FinalColor", width, height,
         //                       RenderPassResource::Format::RGBA8,
@@ -405,17 +447,7 @@ void Renderer::RenderShadows(RenderPassContext &ctx) {
 }
 
 void Renderer::RenderMain(RenderPassContext &ctx) {
-    // Clear
-    const float clearColor[4] = {0.1f, 0.1f, 0.15f, 1.0f};
-    // auto renderTarget = ctx.GetTexture("Backbuffer");
-    // auto depthTarget = ctx.GetTexture("SceneDepth");
-    // Todo: Implement GetTexture in RenderPassContext
-    auto renderTarget = ctx.outputTextures[0];
-    auto depthTarget = ctx.outputTextures[1];
-
-    ctx.commandList->ClearRenderTarget(renderTarget, clearColor);
-    ctx.commandList->ClearDepthStencil(depthTarget, 1.0f, 0);
-    ctx.commandList->SetRenderTarget(renderTarget, depthTarget);
+    // Targets are cleared and bound by the graph from the pass' load ops
 
     // Set viewport and scissor
     Viewport vp = {
@@ -481,7 +513,10 @@ void Renderer::RenderUI(RenderPassContext &ctx) {
 
 void Renderer::WaitForGPU() {
     if (m_graphicsQueue) {
-        m_graphicsQueue->WaitIdle();
+        // Signal through the frame counter so fence values stay unique for the render graph's pool
+        m_currentFenceValue++;
+        m_graphicsQueue->Signal(m_currentFenceValue);
+        m_graphicsQueue->WaitForFence(m_currentFenceValue);
     }
 }
 
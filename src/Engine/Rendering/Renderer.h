@@ -15,6 +15,7 @@
 
 #include "Core/Transform.h"
 #include "Core/Camera.h"
+#include "Core/ThreadPool.h"
 #include "RenderGraph/RenderGraph.h"
 #include "OS/Window/Window.h"
 #include "RHI/Device.h"
@@ -151,6 +152,8 @@ private:
     ResourceManager *m_resourceManager;
     Device *m_device;
     std::unique_ptr<RenderGraph> m_renderGraph;
+    RenderGraphTextureHandle m_backbufferHandle;
+    RenderGraphTextureHandle m_sceneDepthHandle;
     std::unique_ptr<Swapchain> m_swapchain;
 
     TextureHandle m_defaultTexture;
@@ -161,6 +164,7 @@ private:
     std::unique_ptr<CommandQueue> m_graphicsQueue = nullptr;
     std::unique_ptr<CommandQueue> m_computeQueue = nullptr;
     std::unique_ptr<CommandQueue> m_transferQueue = nullptr;
+    std::unique_ptr<ThreadPool> m_recordingThreads; // Render graph pass groups are recorded on these
 
     // Pipelines
     std::unique_ptr<Pipeline> m_mainPipeline;
@@ -207,6 +211,19 @@ private:
     // RenderGraph setup
     void BuildRenderGraph();
 
+    // What the graph's structure depends on. The graph is declared in BeginFrame so it compiles
+    // while the application submits, and declared again in EndFrame if these changed since.
+    struct RenderGraphInputs {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool shadowPass = false;
+        bool postProcessing = false;
+
+        bool operator==(const RenderGraphInputs &) const = default;
+    } m_renderGraphInputs;
+
+    RenderGraphInputs GetRenderGraphInputs() const;
+
     // TODO: Move
     // Rendering functions (passed to RenderGraph)
     void RenderShadows(RenderPassContext &ctx);